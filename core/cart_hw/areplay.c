@@ -41,7 +41,7 @@
 #define TYPE_PRO1 0x12
 #define TYPE_PRO2 0x22
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 enabled;
   uint8 status;
@@ -62,6 +62,7 @@ void areplay_init(void)
   int size;
   
   memset(&action_replay,0,sizeof(action_replay));
+  snapshot_var(action_replay);
 
   /* store Action replay ROM (max. 128k) & RAM (64k) above cartridge ROM + SRAM area */
   if (cart.romsize > 0x810000) return;
@@ -255,6 +256,9 @@ void areplay_set_status(int status)
 
     /* update status */
     action_replay.status = status;
+
+    /* discard 68k instructions cached from patched ROM */
+    m68k_block_flush();
   }
 }
 
@@ -284,6 +288,7 @@ static void ar_write_regs(uint32 address, uint32 data)
 
     /* enable Cartridge ROM */
     m68k.memory_map[0].base = cart.rom;
+    m68k_block_flush();
   }
 }
 
@@ -293,6 +298,7 @@ static void ar_write_regs_2(uint32 address, uint32 data)
   if (((address & 0xff) == 0x78) && (data == 0xffff))
   {
     m68k.memory_map[0].base = cart.rom;
+    m68k_block_flush();
   }
 }
 
@@ -45,12 +45,13 @@
 #define BIT_CS   (2)
 
 
-T_EEPROM_93C eeprom_93c;
+THREAD_LOCAL T_EEPROM_93C eeprom_93c;
 
 void eeprom_93c_init()
 {
   /* default eeprom state */
   memset(&eeprom_93c, 0, sizeof(T_EEPROM_93C));
+  snapshot_var(eeprom_93c);
   eeprom_93c.data = 1;
   eeprom_93c.state = WAIT_START;
   sram.custom = 3;
@@ -156,7 +156,7 @@ static const T_I2C_GAME i2c_database[] =
   {"XXXXXXXX" , 0          , 0xDF39 , mapper_i2c_jcart_init       , NO_EEPROM     }, /* Pete Sampras Tennis 96 (Prototype ?) */
 };
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 sda;              /* current SDA line state */
   uint8 scl;              /* current SCL line state */
@@ -186,6 +186,9 @@ void eeprom_i2c_init()
   /* no serial EEPROM found by default */
   sram.custom = 0;
 
+  /* snapshot areas */
+  snapshot_var(eeprom_i2c);
+
   /* initialize I2C EEPROM state */
   memset(&eeprom_i2c, 0, sizeof(eeprom_i2c));
   eeprom_i2c.sda = eeprom_i2c.old_sda = 1;
@@ -70,12 +70,13 @@ typedef struct
   T_STATE_SPI state;  /* current operation state */
 } T_EEPROM_SPI;
 
-static T_EEPROM_SPI spi_eeprom;
+static THREAD_LOCAL T_EEPROM_SPI spi_eeprom;
 
 void eeprom_spi_init()
 {
   /* reset eeprom state */
   memset(&spi_eeprom, 0, sizeof(T_EEPROM_SPI));
+  snapshot_var(spi_eeprom);
   spi_eeprom.out = 1;
   spi_eeprom.state = GET_OPCODE;
 
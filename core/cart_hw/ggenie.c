@@ -41,7 +41,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 enabled;
   uint8 *rom;
@@ -60,6 +60,7 @@ static void ggenie_write_regs(unsigned int offset, unsigned int data);
 void ggenie_init(void)
 {  
   memset(&ggenie,0,sizeof(ggenie));
+  snapshot_var(ggenie);
 
   /* Store Game Genie ROM (32k) above cartridge ROM + SRAM area */
   if (cart.romsize > 0x810000) return;
@@ -154,6 +155,9 @@ void ggenie_switch(int enable)
       }
     }
   }
+
+  /* discard 68k instructions cached from patched ROM */
+  m68k_block_flush();
 }
 
 static unsigned int ggenie_read_byte(unsigned int address)
@@ -228,6 +232,9 @@ static void ggenie_write_regs(unsigned int offset, unsigned int data)
       }
     }
 
+    /* discard cached 68k instructions */
+    m68k_block_flush();
+
     /* LOCK bit */
     if (data & 0x100)
     {
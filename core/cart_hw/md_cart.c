@@ -686,6 +686,9 @@ void md_cart_init(void)
   {
     cart.hw.time_w = default_time_w;
   }
+
+  /* cartridge ROM is write-protected, its 68k instructions can be cached */
+  m68k_set_rom_area(cart.rom, cart.romsize);
 }
 
 /* hardware that need to be reseted on power on */
@@ -832,6 +835,7 @@ int md_cart_context_load(uint8 *state)
     load_param(svp->iram_rom, 0x800);
     load_param(svp->dram,sizeof(svp->dram));
     load_param(&svp->ssp1601,sizeof(ssp1601_t));
+    ssp1601_block_flush();
   }
 
   return bufferptr;
@@ -897,6 +901,9 @@ static void mapper_sega_w(uint32 data)
       zbank_memory_map[i].write   = zbank_unused_w;
     }
   }
+
+  /* discard cached 68k instructions */
+  m68k_block_flush();
 }
 
 /*
@@ -918,6 +925,9 @@ static void mapper_512k_w(uint32 address, uint32 data)
   {
     m68k.memory_map[address++].base = src + (i<<16);
   }
+
+  /* discard cached 68k instructions */
+  m68k_block_flush();
 }
 
 /*
@@ -1018,6 +1028,8 @@ static void mapper_sf001_w(uint32 address, uint32 data)
         zbank_memory_map[0x00].write  = m68k_unused_8_w;
       }
 
+      /* discard cached 68k instructions */
+      m68k_block_flush();
       return;
     }
 
@@ -1051,6 +1063,9 @@ static void mapper_sf002_w(uint32 address, uint32 data)
       m68k.memory_map[i].base = cart.rom + (i << 16);
     }
   }
+
+  /* discard cached 68k instructions */
+  m68k_block_flush();
 }
 
 /* 
@@ -1152,6 +1167,8 @@ static void mapper_sf004_w(uint32 address, uint32 data)
         zbank_memory_map[0x00].write = m68k_unused_8_w;
       }
 
+      /* discard cached 68k instructions */
+      m68k_block_flush();
       return;
     }
 
@@ -1177,6 +1194,8 @@ static void mapper_sf004_w(uint32 address, uint32 data)
         }
       }
 
+      /* discard cached 68k instructions */
+      m68k_block_flush();
       return;
     }
 
@@ -1222,6 +1241,7 @@ static void mapper_t5740_w(uint32 address, uint32 data)
       {
         m68k.memory_map[i].base = base + ((i & 0x07) << 16);
       }
+      m68k_block_flush();
       return;
     }
 
@@ -1233,6 +1253,7 @@ static void mapper_t5740_w(uint32 address, uint32 data)
       {
         m68k.memory_map[i].base = base + ((i & 0x07) << 16);
       }
+      m68k_block_flush();
       return;
     }
 
@@ -1244,6 +1265,7 @@ static void mapper_t5740_w(uint32 address, uint32 data)
       {
         m68k.memory_map[i].base = base + ((i & 0x07) << 16);
       }
+      m68k_block_flush();
       return;
     }
 
@@ -1347,6 +1369,7 @@ static void mapper_smw_64_w(uint32 address, uint32 data)
           {
             /* update selected ROM bank (upper 512K) mapped at $610000-$61ffff */
             m68k.memory_map[0x61].base = m68k.memory_map[0x69].base = cart.rom + 0x080000 + ((data & 0x1c) << 14);
+            m68k_block_flush();
             break;
           }
 
@@ -1520,6 +1543,9 @@ static void mapper_realtec_w(uint32 address, uint32 data)
         {
           m68k.memory_map[i].base = &cart.rom[(base + (i % cart.hw.regs[2])) << 16];
         }
+
+        /* discard cached 68k instructions */
+        m68k_block_flush();
       }
       return;
     }
@@ -1552,6 +1578,9 @@ static void mapper_seganet_w(uint32 address, uint32 data)
         zbank_memory_map[i].write   = NULL;
       }
     }
+
+    /* discard cached 68k instructions */
+    m68k_block_flush();
   }
 }
 
@@ -1583,6 +1612,9 @@ static void mapper_32k_w(uint32 data)
       m68k.memory_map[i].base = &cart.rom[i << 16];
     }
   }
+
+  /* discard cached 68k instructions */
+  m68k_block_flush();
 }
 
 /* 
@@ -1609,6 +1641,9 @@ static void mapper_64k_w(uint32 data)
       m68k.memory_map[i].base = &cart.rom[(i & 0xf) << 16];
     }
   }
+
+  /* discard cached 68k instructions */
+  m68k_block_flush();
 }
 
 /* 
@@ -1623,6 +1658,9 @@ static void mapper_64k_multi_w(uint32 address)
   {
     m68k.memory_map[i].base = &cart.rom[((address++) & 0x3f) << 16];
   }
+
+  /* discard cached 68k instructions */
+  m68k_block_flush();
 }
 
 /*
@@ -1639,6 +1677,9 @@ static uint32 mapper_radica_r(uint32 address)
     m68k.memory_map[i].base = &cart.rom[((address++)& 0x3f)<< 16];
   }
 
+  /* discard cached 68k instructions */
+  m68k_block_flush();
+
   return 0xffff;
 }
 
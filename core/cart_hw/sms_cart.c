@@ -356,11 +356,11 @@ static const rominfo_t game_list[] =
 };
 
 /* Cartridge & BIOS ROM hardware */
-static romhw_t cart_rom;
-static romhw_t bios_rom;
+static THREAD_LOCAL romhw_t cart_rom;
+static THREAD_LOCAL romhw_t bios_rom;
 
 /* Current slot */
-static struct
+static THREAD_LOCAL struct
 {
   uint8 *rom;
   uint8 *fcr;
@@ -373,6 +373,7 @@ static void mapper_reset(void);
 static void mapper_8k_w(int offset, unsigned char data);
 static void mapper_16k_w(int offset, unsigned char data);
 static void mapper_32k_w(unsigned char data);
+static void mapper_direct_reset(int mapper);
 static void write_mapper_none(unsigned int address, unsigned char data);
 static void write_mapper_sega(unsigned int address, unsigned char data);
 static void write_mapper_codies(unsigned int address, unsigned char data);
@@ -399,6 +400,11 @@ void sms_cart_init(void)
   /* unmapped memory return $FF on read (mapped to unused cartridge areas $510000-$5103FF & $510400-$5107FF) */
   memset(cart.rom + 0x510000, 0xFF, 0x800);
 
+  /* snapshot areas */
+  snapshot_var(slot);
+  snapshot_var(cart_rom);
+  snapshot_var(bios_rom);
+
   /* default cartridge ROM mapper */
   cart_rom.mapper = (cart.romsize > 0xC000) ? MAPPER_SEGA : MAPPER_NONE;
 
@@ -794,6 +800,7 @@ static void mapper_reset(void)
     /* set default Z80 memory handlers */
     z80_readmem = read_mapper_default;
     z80_writemem = write_mapper_none;
+    mapper_direct_reset(MAPPER_NONE);
     return;
   }
 
@@ -922,6 +929,87 @@ static void mapper_reset(void)
       z80_writemem = write_mapper_sega;
       break;
   }
+
+  mapper_direct_reset(slot.mapper);
+}
+
+static void mapper_direct_reset(int mapper)
+{
+  int i;
+
+  /* by default, all pages are accessed directly by Z80 (see read_mapper_default & write_mapper_none) */
+  memset(z80_readmap_direct, 1, sizeof(z80_readmap_direct));
+  memset(z80_writemap_direct, 1, sizeof(z80_writemap_direct));
+
+  /* pages including mapper registers or hardware are accessed through memory handlers */
+  switch (mapper)
+  {
+    case MAPPER_NONE:
+    case MAPPER_RAM_2K:
+    case MAPPER_RAM_8K_EXT1:
+    case MAPPER_RAM_8K_EXT2:
+      break;
+
+    case MAPPER_CODIES:
+      z80_writemap_direct[0x0000 >> 10] = 0;
+      z80_writemap_direct[0x4000 >> 10] = 0;
+      z80_writemap_direct[0x8000 >> 10] = 0;
+      break;
+
+    case MAPPER_KOREA:
+      z80_writemap_direct[0xA000 >> 10] = 0;
+      break;
+
+    case MAPPER_KOREA_8K:
+      /* $4000-$BFFF area can be protected */
+      for (i = (0x4000 >> 10); i < (0xC000 >> 10); i++)
+      {
+        z80_readmap_direct[i] = 0;
+      }
+      z80_writemap_direct[0x4000 >> 10] = 0;
+      z80_writemap_direct[0x6000 >> 10] = 0;
+      z80_writemap_direct[0x8000 >> 10] = 0;
+      z80_writemap_direct[0xA000 >> 10] = 0;
+      z80_writemap_direct[0xFFFE >> 10] = 0;
+      break;
+
+    case MAPPER_KOREA_16K:
+      z80_writemap_direct[0x4000 >> 10] = 0;
+      z80_writemap_direct[0x8000 >> 10] = 0;
+      z80_writemap_direct[0xFFFC >> 10] = 0;
+      break;
+
+    case MAPPER_MSX:
+    case MAPPER_MSX_NEMESIS:
+      z80_writemap_direct[0x0000 >> 10] = 0;
+      break;
+
+    case MAPPER_MULTI_16K:
+      z80_writemap_direct[0x3FFE >> 10] = 0;
+      z80_writemap_direct[0x7FFF >> 10] = 0;
+      z80_writemap_direct[0xBFFF >> 10] = 0;
+      break;
+
+    case MAPPER_MULTI_32K:
+      z80_writemap_direct[0xFFFF >> 10] = 0;
+      break;
+
+    case MAPPER_93C46:
+      z80_readmap_direct[0x8000 >> 10] = 0;
+      z80_writemap_direct[0x8000 >> 10] = 0;
+      z80_writemap_direct[0xFFFC >> 10] = 0;
+      break;
+
+    case MAPPER_TEREBI:
+      z80_readmap_direct[0x8000 >> 10] = 0;
+      z80_readmap_direct[0xA000 >> 10] = 0;
+      z80_writemap_direct[0x6000 >> 10] = 0;
+      break;
+
+    default:
+      z80_writemap_direct[0xFFFC >> 10] = 0;
+      break;
+  }
 }
 
 static void mapper_8k_w(int offset, unsigned char data)
@@ -1155,6 +1243,7 @@ static void mapper_32k_w(unsigned char data)
 static void write_mapper_none(unsigned int address, unsigned char data)
 {
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_sega(unsigned int address, unsigned char data)
@@ -1165,6 +1254,7 @@ static void write_mapper_sega(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_codies(unsigned int address, unsigned char data)
@@ -1188,6 +1278,7 @@ static void write_mapper_codies(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_multi_16k(unsigned int address, unsigned char data)
@@ -1211,6 +1302,7 @@ static void write_mapper_multi_16k(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_multi_32k(unsigned int address, unsigned char data)
@@ -1221,6 +1313,7 @@ static void write_mapper_multi_32k(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_korea(unsigned int address, unsigned char data)
@@ -1232,6 +1325,7 @@ static void write_mapper_korea(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_msx(unsigned int address, unsigned char data)
@@ -1243,6 +1337,7 @@ static void write_mapper_msx(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_korea_8k(unsigned int address, unsigned char data)
@@ -1283,6 +1378,7 @@ static void write_mapper_korea_8k(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_korea_16k(unsigned int address, unsigned char data)
@@ -1306,6 +1402,7 @@ static void write_mapper_korea_16k(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_93c46(unsigned int address, unsigned char data)
@@ -1337,6 +1434,7 @@ static void write_mapper_93c46(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static void write_mapper_terebi(unsigned int address, unsigned char data)
@@ -1348,6 +1446,7 @@ static void write_mapper_terebi(unsigned int address, unsigned char data)
   }
 
   z80_writemap[address >> 10][address & 0x03FF] = data;
+  MARK_STATE_DIRTY(&z80_writemap[address >> 10][address & 0x03FF]);
 }
 
 static unsigned char read_mapper_93c46(unsigned int address)
@@ -1397,5 +1496,8 @@ static unsigned char read_mapper_korea_8k(unsigned int address)
 
 static unsigned char read_mapper_default(unsigned int address)
 {
+#ifdef USE_IDLE_SKIP
+  z80_read_horizon = 0xFFFFFFFF;
+#endif
   return z80_readmap[address >> 10][address & 0x03FF];
 }
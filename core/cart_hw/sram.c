@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-T_SRAM sram;
+THREAD_LOCAL T_SRAM sram;
 
 /****************************************************************************
  * A quick guide to external RAM on the Genesis
@@ -63,6 +63,9 @@ void sram_init()
 {
   memset(&sram, 0, sizeof (T_SRAM));
 
+  /* snapshot areas (backup RAM data is not included) */
+  snapshot_var(sram);
+
   /* backup RAM data is stored above cartridge ROM area, at $800000-$80FFFF (max. 64K) */
   if (cart.romsize > 0x800000) return;
   sram.sram = cart.rom + 0x800000;
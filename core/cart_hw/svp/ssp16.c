@@ -250,11 +250,12 @@
 
 /* standard cond processing. */
 /* again, only Z and N is checked, as SVP doesn't seem to use any other conds. */
-#define COND_CHECK \
-  switch (op&0xf0) { \
+#define COND_CHECK COND_CHECK_OP(op)
+#define COND_CHECK_OP(op) \
+  switch ((op)&0xf0) { \
     case 0x00: cond = 1; break; /* always true */ \
-    case 0x50: cond = !((rST ^ (op<<5)) & SSP_FLAG_Z); break; /* Z matches f(?) bit */ \
-    case 0x70: cond = !((rST ^ (op<<7)) & SSP_FLAG_N); break; /* N matches f(?) bit */ \
+    case 0x50: cond = !((rST ^ ((op)<<5)) & SSP_FLAG_Z); break; /* Z matches f(?) bit */ \
+    case 0x70: cond = !((rST ^ ((op)<<7)) & SSP_FLAG_N); break; /* N matches f(?) bit */ \
     default: break;  \
   }
 
@@ -339,9 +340,14 @@
 }
 
 
-static ssp1601_t *ssp = NULL;
-static unsigned short *PC;
-static int g_cycles;
+static THREAD_LOCAL ssp1601_t *ssp = NULL;
+static THREAD_LOCAL unsigned short *PC;
+static THREAD_LOCAL int g_cycles;
+
+#ifdef USE_SVP_BLOCK_CACHE
+/* incremented on each IRAM write, older IRAM blocks are ignored */
+static THREAD_LOCAL unsigned int ssp_block_iram_gen;
+#endif
 
 #ifdef USE_DEBUGGER
 static int running = 0;
@@ -533,6 +539,9 @@ static u32 pm_io(int reg, int write, u32 d)
 #endif
         ((unsigned short *)svp->iram_rom)[addr&0x3ff] = d;
         ssp->pmac[1][reg] += inc;
+#ifdef USE_SVP_BLOCK_CACHE
+        ssp_block_iram_gen++;
+#endif
       }
 #ifdef LOG_SVP
       else
@@ -976,12 +985,22 @@ static u32 ptr2_read(int op)
 
 void ssp1601_reset(ssp1601_t *l_ssp)
 {
+  /* snapshot areas */
+  snapshot_var(ssp);
+  snapshot_var(PC);
+  snapshot_var(g_cycles);
+
   ssp = l_ssp;
   ssp->emu_status = 0;
   ssp->gr[SSP_GR0].v = 0xffff0000;
   rPC = 0x400;
   rSTACK = 0; /* ? using ascending stack */
   rST = 0;
+
+#ifdef USE_SVP_BLOCK_CACHE
+  /* program ROM has been reloaded */
+  ssp1601_set_block_cache(1);
+#endif
 }
 
 
@@ -1086,241 +1105,816 @@ static void debug(unsigned int pc, unsigned int op)
 #endif /* USE_DEBUGGER */
 
 
-void ssp1601_run(int cycles)
+/* execute one instruction (PC points after opcode) */
+INLINE void ssp1601_exec(int op)
 {
-  SET_PC(rPC);
-  g_cycles = cycles;
+  u32 tmpv;
 
-  do
+  switch (op >> 9)
   {
-    int op;
-    u32 tmpv;
+    /* ld d, s */
+    case 0x00:
+      if (op == 0) break; /* nop */
+      if (op == ((SSP_A<<4)|SSP_P)) { /* A <- P */
+        /* not sure. MAME claims that only hi word is transfered. */
+        read_P(); /* update P */
+        rA32 = rP.v;
+      }
+      else
+      {
+        tmpv = REG_READ(op & 0x0f);
+        REG_WRITE((op & 0xf0) >> 4, tmpv);
+      }
+      break;
 
-    op = *PC++;
-#ifdef USE_DEBUGGER
-    debug(GET_PC()-1, op);
+    /* ld d, (ri) */
+    case 0x01: tmpv = ptr1_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+
+    /* ld (ri), s */
+    case 0x02: tmpv = REG_READ((op & 0xf0) >> 4); ptr1_write(op, tmpv); break;
+
+    /* ldi d, imm */
+    case 0x04: tmpv = *PC++; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+
+    /* ld d, ((ri)) */
+    case 0x05: tmpv = ptr2_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+
+    /* ldi (ri), imm */
+    case 0x06: tmpv = *PC++; ptr1_write(op, tmpv); break;
+
+    /* ld adr, a */
+    case 0x07: ssp->mem.RAM[op & 0x1ff] = rA; break;
+
+    /* ld d, ri */
+    case 0x09: tmpv = rIJ[(op&3)|((op>>6)&4)]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+
+    /* ld ri, s */
+    case 0x0a: rIJ[(op&3)|((op>>6)&4)] = REG_READ((op & 0xf0) >> 4); break;
+
+    /* ldi ri, simm */
+    case 0x0c:
+    case 0x0d:
+    case 0x0e:
+    case 0x0f: rIJ[(op>>8)&7] = op; break;
+
+    /* call cond, addr */
+    case 0x24: {
+      int cond = 0;
+      COND_CHECK
+      if (cond) { int new_PC = *PC++; write_STACK(GET_PC()); write_PC(new_PC); }
+      else PC++;
+      break;
+    }
+
+    /* ld d, (a) */
+    case 0x25: tmpv = ((unsigned short *)svp->iram_rom)[rA]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+
+    /* bra cond, addr */
+    case 0x26: {
+      int cond = 0;
+      COND_CHECK
+      if (cond) { int new_PC = *PC++; write_PC(new_PC); }
+      else PC++;
+      break;
+    }
+
+    /* mod cond, op */
+    case 0x48: {
+      int cond = 0;
+      COND_CHECK
+      if (cond) {
+        switch (op & 7) {
+          case 2: rA32 = (signed int)rA32 >> 1; break; /* shr (arithmetic) */
+          case 3: rA32 <<= 1; break; /* shl */
+          case 6: rA32 = -(signed int)rA32; break; /* neg */
+          case 7: if ((int)rA32 < 0) rA32 = -(signed int)rA32; break; /* abs */
+          default:
+#ifdef LOG_SVP
+            elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: unhandled mod %i @ %04x",
+              op&7, GET_PPC_OFFS());
+#endif
+            break;
+        }
+        UPD_ACC_ZN /* ? */
+      }
+      break;
+    }
+
+    /* mpys? */
+    case 0x1b:
+#ifdef LOG_SVP
+      if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
+#endif
+      read_P(); /* update P */
+      rA32 -= rP.v;  /* maybe only upper word? */
+      UPD_ACC_ZN      /* there checking flags after this */
+      rX = ptr1_read_(op&3, 0, (op<<1)&0x18); /* ri (maybe rj?) */
+      rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); /* rj */
+      break;
+
+    /* mpya (rj), (ri), b */
+    case 0x4b:
+#ifdef LOG_SVP
+      if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
+#endif
+      read_P(); /* update P */
+      rA32 += rP.v; /* confirmed to be 32bit */
+      UPD_ACC_ZN /* ? */
+      rX = ptr1_read_(op&3, 0, (op<<1)&0x18); /* ri (maybe rj?) */
+      rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); /* rj */
+      break;
+
+    /* mld (rj), (ri), b */
+    case 0x5b:
+#ifdef LOG_SVP
+      if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
+#endif
+      rA32 = 0;
+      rST &= 0x0fff; /* ? */
+      rX = ptr1_read_(op&3, 0, (op<<1)&0x18); /* ri (maybe rj?) */
+      rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); /* rj */
+      break;
+
+    /* OP a, s */
+    case 0x10: OP_CHECK32(OP_SUBA32); tmpv = REG_READ(op & 0x0f); OP_SUBA(tmpv); break;
+    case 0x30: OP_CHECK32(OP_CMPA32); tmpv = REG_READ(op & 0x0f); OP_CMPA(tmpv); break;
+    case 0x40: OP_CHECK32(OP_ADDA32); tmpv = REG_READ(op & 0x0f); OP_ADDA(tmpv); break;
+    case 0x50: OP_CHECK32(OP_ANDA32); tmpv = REG_READ(op & 0x0f); OP_ANDA(tmpv); break;
+    case 0x60: OP_CHECK32(OP_ORA32 ); tmpv = REG_READ(op & 0x0f); OP_ORA (tmpv); break;
+    case 0x70: OP_CHECK32(OP_EORA32); tmpv = REG_READ(op & 0x0f); OP_EORA(tmpv); break;
+
+    /* OP a, (ri) */
+    case 0x11: tmpv = ptr1_read(op); OP_SUBA(tmpv); break;
+    case 0x31: tmpv = ptr1_read(op); OP_CMPA(tmpv); break;
+    case 0x41: tmpv = ptr1_read(op); OP_ADDA(tmpv); break;
+    case 0x51: tmpv = ptr1_read(op); OP_ANDA(tmpv); break;
+    case 0x61: tmpv = ptr1_read(op); OP_ORA (tmpv); break;
+    case 0x71: tmpv = ptr1_read(op); OP_EORA(tmpv); break;
+
+    /* OP a, adr */
+    case 0x03: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_LDA (tmpv); break;
+    case 0x13: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_SUBA(tmpv); break;
+    case 0x33: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_CMPA(tmpv); break;
+    case 0x43: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_ADDA(tmpv); break;
+    case 0x53: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_ANDA(tmpv); break;
+    case 0x63: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_ORA (tmpv); break;
+    case 0x73: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_EORA(tmpv); break;
+
+    /* OP a, imm */
+    case 0x14: tmpv = *PC++; OP_SUBA(tmpv); break;
+    case 0x34: tmpv = *PC++; OP_CMPA(tmpv); break;
+    case 0x44: tmpv = *PC++; OP_ADDA(tmpv); break;
+    case 0x54: tmpv = *PC++; OP_ANDA(tmpv); break;
+    case 0x64: tmpv = *PC++; OP_ORA (tmpv); break;
+    case 0x74: tmpv = *PC++; OP_EORA(tmpv); break;
+
+    /* OP a, ((ri)) */
+    case 0x15: tmpv = ptr2_read(op); OP_SUBA(tmpv); break;
+    case 0x35: tmpv = ptr2_read(op); OP_CMPA(tmpv); break;
+    case 0x45: tmpv = ptr2_read(op); OP_ADDA(tmpv); break;
+    case 0x55: tmpv = ptr2_read(op); OP_ANDA(tmpv); break;
+    case 0x65: tmpv = ptr2_read(op); OP_ORA (tmpv); break;
+    case 0x75: tmpv = ptr2_read(op); OP_EORA(tmpv); break;
+
+    /* OP a, ri */
+    case 0x19: tmpv = rIJ[IJind]; OP_SUBA(tmpv); break;
+    case 0x39: tmpv = rIJ[IJind]; OP_CMPA(tmpv); break;
+    case 0x49: tmpv = rIJ[IJind]; OP_ADDA(tmpv); break;
+    case 0x59: tmpv = rIJ[IJind]; OP_ANDA(tmpv); break;
+    case 0x69: tmpv = rIJ[IJind]; OP_ORA (tmpv); break;
+    case 0x79: tmpv = rIJ[IJind]; OP_EORA(tmpv); break;
+
+    /* OP simm */
+    case 0x1c:
+      OP_SUBA(op & 0xff);
+#ifdef LOG_SVP
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+#endif
+      break;
+    case 0x3c:
+      OP_CMPA(op & 0xff); 
+#ifdef LOG_SVP
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+#endif
+      break;
+    case 0x4c:
+      OP_ADDA(op & 0xff);
+#ifdef LOG_SVP
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+#endif
+      break;
+    /* MAME code only does LSB of top word, but this looks wrong to me. */
+    case 0x5c:
+      OP_ANDA(op & 0xff);
+#ifdef LOG_SVP
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+#endif
+      break;
+    case 0x6c:
+      OP_ORA (op & 0xff);
+#ifdef LOG_SVP
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+#endif
+      break;
+    case 0x7c:
+      OP_EORA(op & 0xff); 
+#ifdef LOG_SVP
+      if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
+#endif
+      break;
+
+    default:
+#ifdef LOG_SVP
+      elprintf(EL_ANOMALY|EL_SVP, "ssp FIXME unhandled op %04x @ %04x", op, GET_PPC_OFFS());
+#endif
+      break;
+  }
+}
+
+#ifdef USE_SVP_BLOCK_CACHE
+/* ----------------------------------------------------- */
+/* block translator */
+
+/*
+ * Instruction sequences are translated into blocks of predecoded entries,
+ * indexed by the program address of their first instruction. Each entry holds
+ * a handler specialized for its instruction class and the accessors of its
+ * register or pointer operands, so that instructions are not decoded again on
+ * next executions. Less frequent instructions are still executed by the
+ * interpreter.
+ *
+ * Blocks end after instructions that can modify PC or program memory (writes
+ * to PC or PMx registers, calls and branches). Blocks translated from IRAM are
+ * discarded once IRAM is written through PMx registers, blocks translated
+ * from program ROM are only discarded on reset.
+ */
+
+#ifndef SSP_BLOCK_BITS
+#define SSP_BLOCK_BITS (11)
 #endif
+
+#define SSP_BLOCK_COUNT  (1 << SSP_BLOCK_BITS)
+#define SSP_BLOCK_LENGTH (16)
+
+typedef struct ssp_block_op
+{
+  void (*handler)(const struct ssp_block_op *op);
+  read_func_t read;         /* source operand */
+  read_func_t read2;        /* second source operand (rj pointer) */
+  write_func_t write;       /* destination operand */
+  unsigned short *next;     /* program memory following opcode */
+  unsigned short op;        /* opcode */
+  unsigned short imm;       /* immediate value or RAM address */
+} ssp_block_op_t;
+
+typedef struct
+{
+  unsigned int pc;          /* program address of first instruction */
+  unsigned int gen;         /* cache generation when translated */
+  unsigned int length;      /* number of translated instructions */
+  ssp_block_op_t op[SSP_BLOCK_LENGTH];
+} ssp_block_t;
+
+static THREAD_LOCAL ssp_block_t *ssp_block_cache;
+
+/* incremented on each flush, older blocks are ignored */
+static THREAD_LOCAL unsigned int ssp_block_gen;
+
+/* register accessors (see REG_READ & REG_WRITE) */
+static u32 read_GR0(void) { return ssp->gr[SSP_GR0].byte.h; }
+static u32 read_X(void)   { return rX; }
+static u32 read_Y(void)   { return rY; }
+static u32 read_A(void)   { return rA; }
+static u32 read_ST(void)  { return rST; }
+
+static void write_GR0(u32 d) { }
+static void write_X(u32 d)   { rX = d; }
+static void write_Y(u32 d)   { rY = d; }
+static void write_A(u32 d)   { rA = d; }
+
+static const read_func_t block_read_handlers[16] =
+{
+  read_GR0, read_X, read_Y, read_A,
+  read_ST,
+  read_STACK,
+  read_PC,
+  read_P,
+  read_PM0,
+  read_PM1,
+  read_PM2,
+  read_XST,
+  read_PM4,
+  read_unknown,
+  read_PMC,
+  read_AL
+};
+
+static const write_func_t block_write_handlers[16] =
+{
+  write_GR0, write_X, write_Y, write_A,
+  write_ST,
+  write_STACK,
+  write_PC,
+  write_unknown,
+  write_PM0,
+  write_PM1,
+  write_PM2,
+  write_XST,
+  write_PM4,
+  write_unknown,
+  write_PMC,
+  write_AL
+};
+
+/* pointer accessors (same as ptr1_read_ & ptr1_write), specialized for
+   t = (op&3) | ((op>>6)&4) | ((op<<1)&0x18) */
+INLINE u32 blk_ptr1_read(int t)
+{
+  unsigned short *ram = (t & 4) ? ssp->mem.bank.RAM1 : ssp->mem.bank.RAM0;
+  unsigned char *rp = &rIJ[t & 7];
+  u32 d, mask;
+
+  /* r3 & r7: RAMx[0-3] */
+  if ((t & 3) == 3) return ram[(t >> 3) & 3];
+
+  d = ram[*rp];
+  switch (t & 0x18)
+  {
+    case 0x08: /* "+!" */
+      (*rp)++;
+      break;
+    case 0x10: /* "-" */
+      if (!(rST&7)) { (*rp)--; break; }
+      mask = (1 << (rST&7)) - 1;
+      *rp = (*rp & ~mask) | ((*rp - 1) & mask);
+      break;
+    case 0x18: /* "+" */
+      if (!(rST&7)) { (*rp)++; break; }
+      mask = (1 << (rST&7)) - 1;
+      *rp = (*rp & ~mask) | ((*rp + 1) & mask);
+      break;
+  }
+
+  return d;
+}
+
+INLINE void blk_ptr1_write(int t, u32 d)
+{
+  unsigned short *ram = (t & 4) ? ssp->mem.bank.RAM1 : ssp->mem.bank.RAM0;
+  unsigned char *rp = &rIJ[t & 7];
+
+  /* r3 & r7: RAMx[0-3] */
+  if ((t & 3) == 3) { ram[(t >> 3) & 3] = d; return; }
+
+  switch (t & 0x18)
+  {
+    case 0x00: ram[*rp] = d; break;
+    case 0x10: ram[(*rp)--] = d; break; /* "-" */
+    default:   ram[(*rp)++] = d; break; /* "+!" & "+" */
+  }
+}
+
+#define PTR1_HANDLERS(t) \
+static u32 ptr1_read_##t(void) { return blk_ptr1_read(t); } \
+static void ptr1_write_##t(u32 d) { blk_ptr1_write(t, d); }
+
+PTR1_HANDLERS(0)  PTR1_HANDLERS(1)  PTR1_HANDLERS(2)  PTR1_HANDLERS(3)
+PTR1_HANDLERS(4)  PTR1_HANDLERS(5)  PTR1_HANDLERS(6)  PTR1_HANDLERS(7)
+PTR1_HANDLERS(8)  PTR1_HANDLERS(9)  PTR1_HANDLERS(10) PTR1_HANDLERS(11)
+PTR1_HANDLERS(12) PTR1_HANDLERS(13) PTR1_HANDLERS(14) PTR1_HANDLERS(15)
+PTR1_HANDLERS(16) PTR1_HANDLERS(17) PTR1_HANDLERS(18) PTR1_HANDLERS(19)
+PTR1_HANDLERS(20) PTR1_HANDLERS(21) PTR1_HANDLERS(22) PTR1_HANDLERS(23)
+PTR1_HANDLERS(24) PTR1_HANDLERS(25) PTR1_HANDLERS(26) PTR1_HANDLERS(27)
+PTR1_HANDLERS(28) PTR1_HANDLERS(29) PTR1_HANDLERS(30) PTR1_HANDLERS(31)
+
+static const read_func_t ptr1_read_handlers[32] =
+{
+  ptr1_read_0,  ptr1_read_1,  ptr1_read_2,  ptr1_read_3,  ptr1_read_4,  ptr1_read_5,  ptr1_read_6,  ptr1_read_7,
+  ptr1_read_8,  ptr1_read_9,  ptr1_read_10, ptr1_read_11, ptr1_read_12, ptr1_read_13, ptr1_read_14, ptr1_read_15,
+  ptr1_read_16, ptr1_read_17, ptr1_read_18, ptr1_read_19, ptr1_read_20, ptr1_read_21, ptr1_read_22, ptr1_read_23,
+  ptr1_read_24, ptr1_read_25, ptr1_read_26, ptr1_read_27, ptr1_read_28, ptr1_read_29, ptr1_read_30, ptr1_read_31
+};
+
+static const write_func_t ptr1_write_handlers[32] =
+{
+  ptr1_write_0,  ptr1_write_1,  ptr1_write_2,  ptr1_write_3,  ptr1_write_4,  ptr1_write_5,  ptr1_write_6,  ptr1_write_7,
+  ptr1_write_8,  ptr1_write_9,  ptr1_write_10, ptr1_write_11, ptr1_write_12, ptr1_write_13, ptr1_write_14, ptr1_write_15,
+  ptr1_write_16, ptr1_write_17, ptr1_write_18, ptr1_write_19, ptr1_write_20, ptr1_write_21, ptr1_write_22, ptr1_write_23,
+  ptr1_write_24, ptr1_write_25, ptr1_write_26, ptr1_write_27, ptr1_write_28, ptr1_write_29, ptr1_write_30, ptr1_write_31
+};
+
+#define PTR1_INDEX(op) (((op)&3) | (((op)>>6)&4) | (((op)<<1)&0x18))
+
+/* instruction handlers (PC points after opcode) */
+static void blk_exec(const ssp_block_op_t *op) { ssp1601_exec(op->op); }
+static void blk_nop(const ssp_block_op_t *op) { }
+static void blk_ld(const ssp_block_op_t *op) { op->write(op->read()); }
+static void blk_ldi(const ssp_block_op_t *op) { PC++; op->write(op->imm); }
+static void blk_ld_adr(const ssp_block_op_t *op) { ssp->mem.RAM[op->imm] = rA; }
+static void blk_lda_adr(const ssp_block_op_t *op) { OP_LDA(ssp->mem.RAM[op->imm]); }
+static void blk_ld_ri(const ssp_block_op_t *op) { op->write(rIJ[op->imm]); }
+static void blk_st_ri(const ssp_block_op_t *op) { rIJ[op->imm] = op->read(); }
+static void blk_ldi_ri(const ssp_block_op_t *op) { rIJ[op->imm] = op->op; }
+static void blk_ld_pp(const ssp_block_op_t *op) { op->write(ptr2_read(op->op)); }
+
+static void blk_ld_ap(const ssp_block_op_t *op)
+{
+  read_P(); /* update P */
+  rA32 = rP.v;
+}
+
+static void blk_bra(const ssp_block_op_t *op)
+{
+  int cond = 0;
+  COND_CHECK_OP(op->op)
+  PC++;
+  if (cond) write_PC(op->imm);
+}
+
+static void blk_call(const ssp_block_op_t *op)
+{
+  int cond = 0;
+  COND_CHECK_OP(op->op)
+  PC++;
+  if (cond) { write_STACK(GET_PC()); write_PC(op->imm); }
+}
+
+static void blk_mpys(const ssp_block_op_t *op)
+{
+  read_P(); /* update P */
+  rA32 -= rP.v;
+  UPD_ACC_ZN
+  rX = op->read();
+  rY = op->read2();
+}
+
+static void blk_mpya(const ssp_block_op_t *op)
+{
+  read_P(); /* update P */
+  rA32 += rP.v;
+  UPD_ACC_ZN
+  rX = op->read();
+  rY = op->read2();
+}
+
+static void blk_mld(const ssp_block_op_t *op)
+{
+  rA32 = 0;
+  rST &= 0x0fff;
+  rX = op->read();
+  rY = op->read2();
+}
+
+#define BLK_ALU_HANDLERS(name, OP, OP32) \
+static void blk_##name(const ssp_block_op_t *op) { u32 tmpv = op->read(); OP(tmpv); } \
+static void blk_##name##_adr(const ssp_block_op_t *op) { u32 tmpv = ssp->mem.RAM[op->imm]; OP(tmpv); } \
+static void blk_##name##_imm(const ssp_block_op_t *op) { PC++; OP((u32)op->imm); } \
+static void blk_##name##_simm(const ssp_block_op_t *op) { OP((u32)op->imm); } \
+static void blk_##name##_pp(const ssp_block_op_t *op) { u32 tmpv = ptr2_read(op->op); OP(tmpv); } \
+static void blk_##name##_ri(const ssp_block_op_t *op) { u32 tmpv = rIJ[op->imm]; OP(tmpv); } \
+static void blk_##name##_p(const ssp_block_op_t *op) { read_P(); OP32(rP.v); } \
+static void blk_##name##_a(const ssp_block_op_t *op) { OP32(rA32); }
+
+BLK_ALU_HANDLERS(sub, OP_SUBA, OP_SUBA32)
+BLK_ALU_HANDLERS(cmp, OP_CMPA, OP_CMPA32)
+BLK_ALU_HANDLERS(add, OP_ADDA, OP_ADDA32)
+BLK_ALU_HANDLERS(and, OP_ANDA, OP_ANDA32)
+BLK_ALU_HANDLERS(or,  OP_ORA,  OP_ORA32)
+BLK_ALU_HANDLERS(eor, OP_EORA, OP_EORA32)
+
+typedef void (*block_func_t)(const ssp_block_op_t *op);
+
+/* indexed by (op >> 13) - 1: sub, ?, cmp, add, and, or, eor */
+static const block_func_t blk_alu[7][8] =
+{
+  { blk_sub, blk_sub_adr, blk_sub_imm, blk_sub_simm, blk_sub_pp, blk_sub_ri, blk_sub_p, blk_sub_a },
+  { NULL,    NULL,        NULL,        NULL,         NULL,       NULL,       NULL,      NULL      },
+  { blk_cmp, blk_cmp_adr, blk_cmp_imm, blk_cmp_simm, blk_cmp_pp, blk_cmp_ri, blk_cmp_p, blk_cmp_a },
+  { blk_add, blk_add_adr, blk_add_imm, blk_add_simm, blk_add_pp, blk_add_ri, blk_add_p, blk_add_a },
+  { blk_and, blk_and_adr, blk_and_imm, blk_and_simm, blk_and_pp, blk_and_ri, blk_and_p, blk_and_a },
+  { blk_or,  blk_or_adr,  blk_or_imm,  blk_or_simm,  blk_or_pp,  blk_or_ri,  blk_or_p,  blk_or_a  },
+  { blk_eor, blk_eor_adr, blk_eor_imm, blk_eor_simm, blk_eor_pp, blk_eor_ri, blk_eor_p, blk_eor_a }
+};
+
+#define BLK_ALU(op) blk_alu[((op) >> 13) - 1]
+
+/* blocks end after writes to PC or PMx registers (PC or program memory can be modified) */
+#define BLK_WRITE_LAST(r) (((r) == SSP_PC) || (((r) >= SSP_PM0) && ((r) <= SSP_PM4)))
+
+/* blocks end after reads from PM0 or PM4 registers (SSP can start waiting for 68k) */
+#define BLK_READ_LAST(r) (((r) == SSP_PM0) || ((r) == SSP_PM4))
+
+static void ssp1601_block_translate(ssp_block_t *block, unsigned int pc)
+{
+  unsigned short *code = (unsigned short *)svp->iram_rom + pc;
+  ssp_block_op_t *entry = block->op;
+  int last = 0;
+
+  block->pc = pc;
+  block->gen = (pc < 0x400) ? ssp_block_iram_gen : ssp_block_gen;
+  block->length = 0;
+
+  do
+  {
+    int op = *code++;
+    int d = (op >> 4) & 0x0f;
+    int s = op & 0x0f;
+
+    entry->handler = blk_exec;
+    entry->read = NULL;
+    entry->read2 = NULL;
+    entry->write = block_write_handlers[d];
+    entry->op = op;
+    entry->imm = 0;
+
     switch (op >> 9)
     {
       /* ld d, s */
       case 0x00:
-        if (op == 0) break; /* nop */
-        if (op == ((SSP_A<<4)|SSP_P)) { /* A <- P */
-          /* not sure. MAME claims that only hi word is transfered. */
-          read_P(); /* update P */
-          rA32 = rP.v;
-        }
+        if (op == 0) entry->handler = blk_nop;
+        else if (op == ((SSP_A<<4)|SSP_P)) entry->handler = blk_ld_ap;
         else
         {
-          tmpv = REG_READ(op & 0x0f);
-          REG_WRITE((op & 0xf0) >> 4, tmpv);
+          entry->handler = blk_ld;
+          entry->read = block_read_handlers[s];
         }
+        last = BLK_WRITE_LAST(d) || BLK_READ_LAST(s);
         break;
 
       /* ld d, (ri) */
-      case 0x01: tmpv = ptr1_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+      case 0x01:
+        entry->handler = blk_ld;
+        entry->read = ptr1_read_handlers[PTR1_INDEX(op)];
+        last = BLK_WRITE_LAST(d);
+        break;
 
       /* ld (ri), s */
-      case 0x02: tmpv = REG_READ((op & 0xf0) >> 4); ptr1_write(op, tmpv); break;
+      case 0x02:
+        entry->handler = blk_ld;
+        entry->read = block_read_handlers[d];
+        entry->write = ptr1_write_handlers[PTR1_INDEX(op)];
+        last = BLK_READ_LAST(d);
+        break;
 
       /* ldi d, imm */
-      case 0x04: tmpv = *PC++; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
-
-      /* ld d, ((ri)) */
-      case 0x05: tmpv = ptr2_read(op); REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+      case 0x04:
+        entry->handler = blk_ldi;
+        entry->imm = *code++;
+        last = BLK_WRITE_LAST(d);
+        break;
 
       /* ldi (ri), imm */
-      case 0x06: tmpv = *PC++; ptr1_write(op, tmpv); break;
+      case 0x06:
+        entry->handler = blk_ldi;
+        entry->imm = *code++;
+        entry->write = ptr1_write_handlers[PTR1_INDEX(op)];
+        break;
 
       /* ld adr, a */
-      case 0x07: ssp->mem.RAM[op & 0x1ff] = rA; break;
+      case 0x07:
+        entry->handler = blk_ld_adr;
+        entry->imm = op & 0x1ff;
+        break;
 
       /* ld d, ri */
-      case 0x09: tmpv = rIJ[(op&3)|((op>>6)&4)]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
+      case 0x09:
+        entry->handler = blk_ld_ri;
+        entry->imm = IJind;
+        last = BLK_WRITE_LAST(d);
+        break;
 
       /* ld ri, s */
-      case 0x0a: rIJ[(op&3)|((op>>6)&4)] = REG_READ((op & 0xf0) >> 4); break;
+      case 0x0a:
+        entry->handler = blk_st_ri;
+        entry->imm = IJind;
+        entry->read = block_read_handlers[d];
+        last = BLK_READ_LAST(d);
+        break;
 
       /* ldi ri, simm */
       case 0x0c:
       case 0x0d:
       case 0x0e:
-      case 0x0f: rIJ[(op>>8)&7] = op; break;
+      case 0x0f:
+        entry->handler = blk_ldi_ri;
+        entry->imm = (op >> 8) & 7;
+        break;
 
-      /* call cond, addr */
-      case 0x24: {
-        int cond = 0;
-        COND_CHECK
-        if (cond) { int new_PC = *PC++; write_STACK(GET_PC()); write_PC(new_PC); }
-        else PC++;
+      /* ld d, ((ri)) */
+      case 0x05:
+        entry->handler = blk_ld_pp;
+        last = BLK_WRITE_LAST(d);
         break;
-      }
 
       /* ld d, (a) */
-      case 0x25: tmpv = ((unsigned short *)svp->iram_rom)[rA]; REG_WRITE((op & 0xf0) >> 4, tmpv); break;
-
-      /* bra cond, addr */
-      case 0x26: {
-        int cond = 0;
-        COND_CHECK
-        if (cond) { int new_PC = *PC++; write_PC(new_PC); }
-        else PC++;
+      case 0x25:
+        last = BLK_WRITE_LAST(d);
         break;
-      }
 
-      /* mod cond, op */
-      case 0x48: {
-        int cond = 0;
-        COND_CHECK
-        if (cond) {
-          switch (op & 7) {
-            case 2: rA32 = (signed int)rA32 >> 1; break; /* shr (arithmetic) */
-            case 3: rA32 <<= 1; break; /* shl */
-            case 6: rA32 = -(signed int)rA32; break; /* neg */
-            case 7: if ((int)rA32 < 0) rA32 = -(signed int)rA32; break; /* abs */
-            default:
-#ifdef LOG_SVP
-              elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: unhandled mod %i @ %04x",
-                op&7, GET_PPC_OFFS());
-#endif
-              break;
-          }
-          UPD_ACC_ZN /* ? */
-        }
+      /* call cond, addr */
+      case 0x24:
+        entry->handler = blk_call;
+        entry->imm = *code++;
+        last = 1;
         break;
-      }
 
-      /* mpys? */
-      case 0x1b:
-#ifdef LOG_SVP
-        if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
-#endif
-        read_P(); /* update P */
-        rA32 -= rP.v;  /* maybe only upper word? */
-        UPD_ACC_ZN      /* there checking flags after this */
-        rX = ptr1_read_(op&3, 0, (op<<1)&0x18); /* ri (maybe rj?) */
-        rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); /* rj */
+      /* bra cond, addr */
+      case 0x26:
+        entry->handler = blk_bra;
+        entry->imm = *code++;
+        last = 1;
         break;
 
-      /* mpya (rj), (ri), b */
+      /* mpys, mpya & mld (rj), (ri), b */
+      case 0x1b:
       case 0x4b:
-#ifdef LOG_SVP
-        if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
-#endif
-        read_P(); /* update P */
-        rA32 += rP.v; /* confirmed to be 32bit */
-        UPD_ACC_ZN /* ? */
-        rX = ptr1_read_(op&3, 0, (op<<1)&0x18); /* ri (maybe rj?) */
-        rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); /* rj */
-        break;
-
-      /* mld (rj), (ri), b */
       case 0x5b:
-#ifdef LOG_SVP
-        if (!(op&0x100)) elprintf(EL_SVP|EL_ANOMALY, "ssp FIXME: no b bit @ %04x", GET_PPC_OFFS());
-#endif
-        rA32 = 0;
-        rST &= 0x0fff; /* ? */
-        rX = ptr1_read_(op&3, 0, (op<<1)&0x18); /* ri (maybe rj?) */
-        rY = ptr1_read_((op>>4)&3, 4, (op>>3)&0x18); /* rj */
+        entry->handler = (op >> 9 == 0x1b) ? blk_mpys : ((op >> 9 == 0x4b) ? blk_mpya : blk_mld);
+        entry->read = ptr1_read_handlers[(op & 3) | ((op << 1) & 0x18)];
+        entry->read2 = ptr1_read_handlers[((op >> 4) & 3) | 4 | ((op >> 3) & 0x18)];
         break;
 
       /* OP a, s */
-      case 0x10: OP_CHECK32(OP_SUBA32); tmpv = REG_READ(op & 0x0f); OP_SUBA(tmpv); break;
-      case 0x30: OP_CHECK32(OP_CMPA32); tmpv = REG_READ(op & 0x0f); OP_CMPA(tmpv); break;
-      case 0x40: OP_CHECK32(OP_ADDA32); tmpv = REG_READ(op & 0x0f); OP_ADDA(tmpv); break;
-      case 0x50: OP_CHECK32(OP_ANDA32); tmpv = REG_READ(op & 0x0f); OP_ANDA(tmpv); break;
-      case 0x60: OP_CHECK32(OP_ORA32 ); tmpv = REG_READ(op & 0x0f); OP_ORA (tmpv); break;
-      case 0x70: OP_CHECK32(OP_EORA32); tmpv = REG_READ(op & 0x0f); OP_EORA(tmpv); break;
+      case 0x10: case 0x30: case 0x40: case 0x50: case 0x60: case 0x70:
+        if (s == SSP_P) entry->handler = BLK_ALU(op)[6];
+        else if (s == SSP_A) entry->handler = BLK_ALU(op)[7];
+        else
+        {
+          entry->handler = BLK_ALU(op)[0];
+          entry->read = block_read_handlers[s];
+          last = BLK_READ_LAST(s);
+        }
+        break;
 
       /* OP a, (ri) */
-      case 0x11: tmpv = ptr1_read(op); OP_SUBA(tmpv); break;
-      case 0x31: tmpv = ptr1_read(op); OP_CMPA(tmpv); break;
-      case 0x41: tmpv = ptr1_read(op); OP_ADDA(tmpv); break;
-      case 0x51: tmpv = ptr1_read(op); OP_ANDA(tmpv); break;
-      case 0x61: tmpv = ptr1_read(op); OP_ORA (tmpv); break;
-      case 0x71: tmpv = ptr1_read(op); OP_EORA(tmpv); break;
+      case 0x11: case 0x31: case 0x41: case 0x51: case 0x61: case 0x71:
+        entry->handler = BLK_ALU(op)[0];
+        entry->read = ptr1_read_handlers[PTR1_INDEX(op)];
+        break;
 
       /* OP a, adr */
-      case 0x03: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_LDA (tmpv); break;
-      case 0x13: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_SUBA(tmpv); break;
-      case 0x33: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_CMPA(tmpv); break;
-      case 0x43: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_ADDA(tmpv); break;
-      case 0x53: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_ANDA(tmpv); break;
-      case 0x63: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_ORA (tmpv); break;
-      case 0x73: tmpv = ssp->mem.RAM[op & 0x1ff]; OP_EORA(tmpv); break;
+      case 0x03:
+        entry->handler = blk_lda_adr;
+        entry->imm = op & 0x1ff;
+        break;
+      case 0x13: case 0x33: case 0x43: case 0x53: case 0x63: case 0x73:
+        entry->handler = BLK_ALU(op)[1];
+        entry->imm = op & 0x1ff;
+        break;
 
       /* OP a, imm */
-      case 0x14: tmpv = *PC++; OP_SUBA(tmpv); break;
-      case 0x34: tmpv = *PC++; OP_CMPA(tmpv); break;
-      case 0x44: tmpv = *PC++; OP_ADDA(tmpv); break;
-      case 0x54: tmpv = *PC++; OP_ANDA(tmpv); break;
-      case 0x64: tmpv = *PC++; OP_ORA (tmpv); break;
-      case 0x74: tmpv = *PC++; OP_EORA(tmpv); break;
+      case 0x14: case 0x34: case 0x44: case 0x54: case 0x64: case 0x74:
+        entry->handler = BLK_ALU(op)[2];
+        entry->imm = *code++;
+        break;
 
       /* OP a, ((ri)) */
-      case 0x15: tmpv = ptr2_read(op); OP_SUBA(tmpv); break;
-      case 0x35: tmpv = ptr2_read(op); OP_CMPA(tmpv); break;
-      case 0x45: tmpv = ptr2_read(op); OP_ADDA(tmpv); break;
-      case 0x55: tmpv = ptr2_read(op); OP_ANDA(tmpv); break;
-      case 0x65: tmpv = ptr2_read(op); OP_ORA (tmpv); break;
-      case 0x75: tmpv = ptr2_read(op); OP_EORA(tmpv); break;
+      case 0x15: case 0x35: case 0x45: case 0x55: case 0x65: case 0x75:
+        entry->handler = BLK_ALU(op)[4];
+        break;
 
       /* OP a, ri */
-      case 0x19: tmpv = rIJ[IJind]; OP_SUBA(tmpv); break;
-      case 0x39: tmpv = rIJ[IJind]; OP_CMPA(tmpv); break;
-      case 0x49: tmpv = rIJ[IJind]; OP_ADDA(tmpv); break;
-      case 0x59: tmpv = rIJ[IJind]; OP_ANDA(tmpv); break;
-      case 0x69: tmpv = rIJ[IJind]; OP_ORA (tmpv); break;
-      case 0x79: tmpv = rIJ[IJind]; OP_EORA(tmpv); break;
+      case 0x19: case 0x39: case 0x49: case 0x59: case 0x69: case 0x79:
+        entry->handler = BLK_ALU(op)[5];
+        entry->imm = IJind;
+        break;
 
       /* OP simm */
-      case 0x1c:
-        OP_SUBA(op & 0xff);
-#ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
-#endif
-        break;
-      case 0x3c:
-        OP_CMPA(op & 0xff); 
-#ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
-#endif
-        break;
-      case 0x4c:
-        OP_ADDA(op & 0xff);
-#ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
-#endif
-        break;
-      /* MAME code only does LSB of top word, but this looks wrong to me. */
-      case 0x5c:
-        OP_ANDA(op & 0xff);
-#ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
-#endif
-        break;
-      case 0x6c:
-        OP_ORA (op & 0xff);
-#ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
-#endif
-        break;
-      case 0x7c:
-        OP_EORA(op & 0xff); 
-#ifdef LOG_SVP
-        if (op&0x100) elprintf(EL_SVP|EL_ANOMALY, "FIXME: simm with upper bit set");
-#endif
+      case 0x1c: case 0x3c: case 0x4c: case 0x5c: case 0x6c: case 0x7c:
+        entry->handler = BLK_ALU(op)[3];
+        entry->imm = op & 0xff;
         break;
 
+      /* other instructions are executed by the interpreter */
       default:
-#ifdef LOG_SVP
-        elprintf(EL_ANOMALY|EL_SVP, "ssp FIXME unhandled op %04x @ %04x", op, GET_PPC_OFFS());
-#endif
         break;
     }
+
+    /* handlers are called with PC pointing after opcode */
+    entry->next = (unsigned short *)svp->iram_rom + pc + 1;
+    pc = code - (unsigned short *)svp->iram_rom;
+    entry++;
+  }
+  while ((++block->length < SSP_BLOCK_LENGTH) && !last);
+}
+
+/* Execute translated blocks until cycles are consumed or SSP waits for 68k */
+static void ssp1601_block_run(void)
+{
+  int cycles = g_cycles;
+
+  while (1)
+  {
+    unsigned int pc = GET_PC();
+    ssp_block_t *block = &ssp_block_cache[pc & (SSP_BLOCK_COUNT - 1)];
+    const ssp_block_op_t *op, *last;
+
+    if ((block->pc != pc) || (block->gen != ((pc < 0x400) ? ssp_block_iram_gen : ssp_block_gen)))
+    {
+      ssp1601_block_translate(block, pc);
+    }
+
+    op = block->op;
+    last = op + block->length - 1;
+
+    if (cycles > (int)block->length)
+    {
+      /* remaining cycles do not need to be checked before last instruction */
+      cycles -= block->length - 1;
+      while (op < last)
+      {
+        PC = op->next;
+        op->handler(op);
+        op++;
+      }
+    }
+    else
+    {
+      while (op < last)
+      {
+        PC = op->next;
+        op->handler(op);
+        if (--cycles <= 0)
+        {
+          g_cycles = cycles;
+          return;
+        }
+        op++;
+      }
+    }
+
+    /* last instruction can modify PC and cycle count (see write_PC) or make SSP wait for 68k */
+    g_cycles = cycles;
+    PC = op->next;
+    op->handler(op);
+    if ((--g_cycles <= 0) || (ssp->emu_status & SSP_WAIT_MASK))
+    {
+      return;
+    }
+    cycles = g_cycles;
+  }
+}
+
+static void ssp1601_block_cache_init(void)
+{
+  if (!ssp_block_cache)
+  {
+    ssp_block_cache = (ssp_block_t *)calloc(SSP_BLOCK_COUNT, sizeof(ssp_block_t));
+  }
+
+  ssp1601_block_flush();
+}
+
+void ssp1601_shutdown(void)
+{
+  /* Release block cache */
+  free(ssp_block_cache);
+  ssp_block_cache = NULL;
+}
+
+void ssp1601_set_block_cache(int enable)
+{
+  if (enable)
+  {
+    ssp1601_block_cache_init();
+  }
+  else
+  {
+    ssp1601_shutdown();
+  }
+}
+
+void ssp1601_block_flush(void)
+{
+  ssp_block_gen++;
+  ssp_block_iram_gen++;
+}
+#endif /* USE_SVP_BLOCK_CACHE */
+
+
+void ssp1601_run(int cycles)
+{
+  SET_PC(rPC);
+  g_cycles = cycles;
+
+#ifdef USE_SVP_BLOCK_CACHE
+  if (ssp_block_cache && !(ssp->emu_status & SSP_WAIT_MASK))
+  {
+    ssp1601_block_run();
+  }
+  else
+#endif
+  {
+    do
+    {
+      int op = *PC++;
+#ifdef USE_DEBUGGER
+      debug(GET_PC()-1, op);
+#endif
+      ssp1601_exec(op);
+    }
+    while (--g_cycles > 0 && !(ssp->emu_status & SSP_WAIT_MASK));
   }
-  while (--g_cycles > 0 && !(ssp->emu_status & SSP_WAIT_MASK));
 
   read_P(); /* update P */
   rPC = GET_PC();
@@ -76,4 +76,17 @@ typedef struct
 void ssp1601_reset(ssp1601_t *ssp);
 void ssp1601_run(int cycles);
 
+#ifdef USE_SVP_BLOCK_CACHE
+/* Release memory allocated by the block translator */
+void ssp1601_shutdown(void);
+
+/* Enable or disable block translator at runtime (for benchmarking) */
+void ssp1601_set_block_cache(int enable);
+
+/* Discard translated blocks (must be called when IRAM is modified externally) */
+void ssp1601_block_flush(void);
+#else
+#define ssp1601_block_flush()
+#endif
+
 #endif
@@ -12,7 +12,7 @@
 
 #include "shared.h"
 
-svp_t *svp;
+THREAD_LOCAL svp_t *svp;
 
 static void svp_write_dram(uint32 address, uint32 data)
 {
@@ -194,6 +194,21 @@ void cdd_init(int samplerate)
   /* CD-DA is running by default at 44100 Hz */
   /* Audio stream is resampled to desired rate using Blip Buffer */
   blip_set_rates(snd.blips[2], 44100, samplerate);
+
+  /* native-rate output stream uses the same timebase */
+  audio_stream_set_clock(AUDIO_STREAM_CDDA, 44100);
+  audio_stream_set_ratio(AUDIO_STREAM_CDDA, 1);
+}
+
+/* Add CD-DA output variation */
+INLINE void cdd_add_delta(unsigned int time, int delta_l, int delta_r)
+{
+  audio_stream_add_delta(AUDIO_STREAM_CDDA, time, delta_l, delta_r);
+
+  if (!audio_stream_only)
+  {
+    blip_add_delta_fast(snd.blips[2], time, delta_l, delta_r);
+  }
 }
 
 void cdd_reset(void)
@@ -1325,7 +1340,7 @@ void cdd_read_audio(unsigned int samples)
         r = (((int16)((ptr[3] + ptr[2]*256)) * mul) / 1024);
         ptr+=4;
 #endif
-        blip_add_delta_fast(snd.blips[2], i, l-prev_l, r-prev_r);
+        cdd_add_delta(i, l-prev_l, r-prev_r);
         prev_l = l;
         prev_r = r;
 
@@ -1398,7 +1413,7 @@ void cdd_read_audio(unsigned int samples)
         /* left & right channels */
         l = ((ptr[0] * mul) / 1024);
         r = ((ptr[1] * mul) / 1024);
-        blip_add_delta_fast(snd.blips[2], i, l-prev_l, r-prev_r);
+        cdd_add_delta(i, l-prev_l, r-prev_r);
         prev_l = l;
         prev_r = r;
         ptr+=2;
@@ -1448,7 +1463,7 @@ void cdd_read_audio(unsigned int samples)
         r = (((int16)((ptr[2] + ptr[3]*256)) * mul) / 1024);
         ptr+=4;
 #endif
-        blip_add_delta_fast(snd.blips[2], i, l-prev_l, r-prev_r);
+        cdd_add_delta(i, l-prev_l, r-prev_r);
         prev_l = l;
         prev_r = r;
 
@@ -1483,7 +1498,7 @@ void cdd_read_audio(unsigned int samples)
     /* no audio output */
     if (prev_l | prev_r)
     {
-      blip_add_delta_fast(snd.blips[2], 0, -prev_l, -prev_r);
+      cdd_add_delta(0, -prev_l, -prev_r);
 
       /* save audio output for next frame */
       cdd.audio[0] = 0;
@@ -1493,6 +1508,7 @@ void cdd_read_audio(unsigned int samples)
 
   /* end of Blip Buffer timeframe */
   blip_end_frame(snd.blips[2], samples);
+  audio_stream_end_frame(AUDIO_STREAM_CDDA, samples);
 }
 
 static void cdd_read_subcode(void)
@@ -70,6 +70,7 @@ void word_ram_0_dma_w(unsigned int words)
 
     /* write 16-bit word to WORD-RAM */
     *(uint16 *)(scd.word_ram[0] + dst_index) = data ;
+    MARK_STATE_DIRTY(scd.word_ram[0] + dst_index);
 
     /* increment CDC buffer source address */
     src_index = (src_index + 2) & 0x3ffe;
@@ -108,6 +109,7 @@ void word_ram_1_dma_w(unsigned int words)
 
     /* write 16-bit word to WORD-RAM */
     *(uint16 *)(scd.word_ram[1] + dst_index) = data ;
+    MARK_STATE_DIRTY(scd.word_ram[1] + dst_index);
 
     /* increment CDC buffer source address */
     src_index = (src_index + 2) & 0x3ffe;
@@ -146,6 +148,7 @@ void word_ram_2M_dma_w(unsigned int words)
 
     /* write 16-bit word to WORD-RAM */
     *(uint16 *)(scd.word_ram_2M + dst_index) = data ;
+    MARK_STATE_DIRTY(scd.word_ram_2M + dst_index);
 
     /* increment CDC buffer source address */
     src_index = (src_index + 2) & 0x3ffe;
@@ -180,6 +183,7 @@ void dot_ram_0_write16(unsigned int address, unsigned int data)
   data = (data & 0x0f) | ((data >> 4) & 0xf0);
   data = gfx.lut_prio[(scd.regs[0x02>>1].w >> 3) & 0x03][prev][data];
   WRITE_BYTE(scd.word_ram[0], address, data);
+  MARK_STATE_DIRTY(scd.word_ram[0] + address);
 }
 
 void dot_ram_1_write16(unsigned int address, unsigned int data)
@@ -190,6 +194,7 @@ void dot_ram_1_write16(unsigned int address, unsigned int data)
   data = (data & 0x0f) | ((data >> 4) & 0xf0);
   data = gfx.lut_prio[(scd.regs[0x02>>1].w >> 3) & 0x03][prev][data];
   WRITE_BYTE(scd.word_ram[1], address, data);
+  MARK_STATE_DIRTY(scd.word_ram[1] + address);
 }
 
 unsigned int dot_ram_0_read8(unsigned int address)
@@ -231,6 +236,7 @@ void dot_ram_0_write8(unsigned int address, unsigned int data)
 
   data = gfx.lut_prio[(scd.regs[0x02>>1].w >> 3) & 0x03][prev][data];
   WRITE_BYTE(scd.word_ram[0], (address >> 1) & 0x1ffff, data);
+  MARK_STATE_DIRTY(scd.word_ram[0] + ((address >> 1) & 0x1ffff));
 }
 
 void dot_ram_1_write8(unsigned int address, unsigned int data)
@@ -248,6 +254,7 @@ void dot_ram_1_write8(unsigned int address, unsigned int data)
 
   data = gfx.lut_prio[(scd.regs[0x02>>1].w >> 3) & 0x03][prev][data];
   WRITE_BYTE(scd.word_ram[1], (address >> 1) & 0x1ffff, data);
+  MARK_STATE_DIRTY(scd.word_ram[1] + ((address >> 1) & 0x1ffff));
 }
 
 
@@ -271,12 +278,14 @@ void cell_ram_0_write16(unsigned int address, unsigned int data)
 {
   address = gfx.lut_offset[(address >> 2) & 0x7fff] | (address & 0x10002);
   *(uint16 *)(scd.word_ram[0] + address) = data;
+  MARK_STATE_DIRTY(scd.word_ram[0] + address);
 }
 
 void cell_ram_1_write16(unsigned int address, unsigned int data)
 {
   address = gfx.lut_offset[(address >> 2) & 0x7fff] | (address & 0x10002);
   *(uint16 *)(scd.word_ram[1] + address) = data;
+  MARK_STATE_DIRTY(scd.word_ram[1] + address);
 }
 
 unsigned int cell_ram_0_read8(unsigned int address)
@@ -295,12 +304,14 @@ void cell_ram_0_write8(unsigned int address, unsigned int data)
 {
   address = gfx.lut_offset[(address >> 2) & 0x7fff] | (address & 0x10003);
   WRITE_BYTE(scd.word_ram[0], address, data);
+  MARK_STATE_DIRTY(scd.word_ram[0] + address);
 }
 
 void cell_ram_1_write8(unsigned int address, unsigned int data)
 {
   address = gfx.lut_offset[(address >> 2) & 0x7fff] | (address & 0x10003);
   WRITE_BYTE(scd.word_ram[1], address, data);
+  MARK_STATE_DIRTY(scd.word_ram[1] + address);
 }
 
 
@@ -577,6 +588,7 @@ INLINE void gfx_render(uint32 bufferIndex, uint32 width)
 
     /* write data to image buffer */
     WRITE_BYTE(scd.word_ram_2M, bufferIndex >> 1, pixel_out);
+    MARK_STATE_DIRTY(scd.word_ram_2M + (bufferIndex >> 1));
 
     /* check current pixel position  */
     if ((bufferIndex & 7) != 7)
@@ -46,6 +46,21 @@ void pcm_init(double clock, int samplerate)
   /* PCM chip is running at original rate and is synchronized with SUB-CPU  */
   /* Chip output is resampled to desired rate using Blip Buffer. */
   blip_set_rates(snd.blips[1], clock / PCM_SCYCLES_RATIO, samplerate);
+
+  /* native-rate output stream uses the same timebase */
+  audio_stream_set_clock(AUDIO_STREAM_PCM, clock / PCM_SCYCLES_RATIO);
+  audio_stream_set_ratio(AUDIO_STREAM_PCM, 1);
+}
+
+/* Add PCM output variation */
+INLINE void pcm_add_delta(unsigned int time, int delta_l, int delta_r)
+{
+  audio_stream_add_delta(AUDIO_STREAM_PCM, time, delta_l, delta_r);
+
+  if (!audio_stream_only)
+  {
+    blip_add_delta_fast(snd.blips[1], time, delta_l, delta_r);
+  }
 }
 
 void pcm_reset(void)
@@ -86,7 +101,7 @@ int pcm_context_save(uint8 *state)
   save_param(&pcm.enabled, sizeof(pcm.enabled));
   save_param(&pcm.status, sizeof(pcm.status));
   save_param(&pcm.index, sizeof(pcm.index));
-  save_param(pcm.ram, sizeof(pcm.ram));
+  save_ram(pcm.ram, sizeof(pcm.ram));
 
   return bufferptr;
 }
@@ -184,7 +199,7 @@ void pcm_run(unsigned int length)
       else if (r > 32767) r = 32767;
 
       /* update Blip Buffer */
-      blip_add_delta_fast(snd.blips[1], i, l-prev_l, r-prev_r);
+      pcm_add_delta(i, l-prev_l, r-prev_r);
       prev_l = l;
       prev_r = r;
     }
@@ -198,7 +213,7 @@ void pcm_run(unsigned int length)
     /* check if PCM output was not muted */
     if (prev_l | prev_r)
     {
-      blip_add_delta_fast(snd.blips[1], 0, -prev_l, -prev_r);
+      pcm_add_delta(0, -prev_l, -prev_r);
       pcm.out[0] = 0;
       pcm.out[1] = 0;
     }
@@ -206,6 +221,7 @@ void pcm_run(unsigned int length)
 
   /* end of blip buffer frame */
   blip_end_frame(snd.blips[1], length);
+  audio_stream_end_frame(AUDIO_STREAM_PCM, length);
 
   /* update PCM master clock counter */
   pcm.cycles += length * PCM_SCYCLES_RATIO;
@@ -246,6 +262,7 @@ void pcm_write(unsigned int address, unsigned char data)
   {
     /* 4K bank access */
     pcm.bank[address & 0xfff] = data;
+    MARK_STATE_DIRTY(&pcm.bank[address & 0xfff]);
     return;
   }
 
@@ -415,6 +432,7 @@ void pcm_ram_dma_w(unsigned int words)
 
     /* write 16-bit word to PCM RAM (endianness does not matter since PCM RAM is always accessed as byte)*/
     *(uint16 *)(pcm.bank + dst_index) = data ;
+    MARK_STATE_DIRTY(pcm.bank + dst_index);
 
     /* increment CDC buffer source address */
     src_index = (src_index + 2) & 0x3ffe;
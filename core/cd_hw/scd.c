@@ -38,6 +38,216 @@
 
 #include "shared.h"
 
+#ifdef USE_SCD_THREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* Relaxed CPU synchronization (see scd_set_sync_lines)
+ *
+ * Lines executed by MAIN-CPU are first pending. Once enough lines are pending, they are
+ * handed to SUB-CPU as a batch, which is executed while MAIN-CPU runs next lines (on the
+ * SUB-CPU thread) or on next synchronization point, at the latest. A batch is always
+ * completed before any other SUB-CPU line is executed, so results are the same whether
+ * a SUB-CPU thread is used or not.
+ */
+static THREAD_LOCAL struct
+{
+  int lines;            /* maximal number of lines executed by MAIN-CPU ahead of SUB-CPU */
+  int pending;          /* number of lines not yet handed to SUB-CPU */
+  unsigned int cycles;  /* MAIN-CPU cycle counter at the end of first pending line */
+  int batch;            /* number of lines handed to SUB-CPU but not yet executed */
+  unsigned int batch_cycles; /* MAIN-CPU cycle counter at the end of first batch line */
+  int ahead;            /* set while SUB-CPU executes lines already executed by MAIN-CPU */
+  int async;            /* set while batch is executed by SUB-CPU thread */
+  int request;          /* set when SUB-CPU accessed shared registers */
+  int lockstep;         /* set when next lines are executed in sync */
+  unsigned int saved;   /* number of deferred synchronizations in current frame */
+  unsigned int last;    /* number of deferred synchronizations in last frame */
+} scd_relax;
+
+#ifdef USE_SCD_THREAD
+/* Polling iterations before a waiting thread goes to sleep (multi-core CPU only) */
+#define SCD_THREAD_SPIN 4000
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t work;    /* signaled when a batch is handed to SUB-CPU thread or emulation thread waits for it */
+  pthread_cond_t done;    /* signaled when a batch is completed */
+  int busy;               /* batch being executed by SUB-CPU thread */
+  int joining;            /* emulation thread waiting for batch completion */
+  int quit;
+  int spin;               /* polling iterations before sleeping */
+} t_scd_thread;
+
+static t_scd_thread *scd_thread;
+
+int scd_thread_active;
+
+static void scd_run_batch(void);
+
+static void *scd_thread_main(void *arg)
+{
+  t_scd_thread *st = (t_scd_thread *)arg;
+  int i;
+
+  while (1)
+  {
+    /* wait for next batch */
+    for (i = 0; (i < st->spin) && !__atomic_load_n(&st->busy, __ATOMIC_SEQ_CST); i++);
+    if (!__atomic_load_n(&st->busy, __ATOMIC_SEQ_CST))
+    {
+      pthread_mutex_lock(&st->lock);
+      while (!__atomic_load_n(&st->busy, __ATOMIC_SEQ_CST) && !st->quit)
+      {
+        pthread_cond_wait(&st->work, &st->lock);
+      }
+      pthread_mutex_unlock(&st->lock);
+
+      if (!__atomic_load_n(&st->busy, __ATOMIC_SEQ_CST))
+      {
+        return NULL;
+      }
+    }
+
+    scd_run_batch();
+
+    /* batch completed */
+    pthread_mutex_lock(&st->lock);
+    __atomic_store_n(&st->busy, 0, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&st->done);
+    pthread_mutex_unlock(&st->lock);
+  }
+}
+
+/* Called by SUB-CPU before MAIN-CPU state is accessed: when running on SUB-CPU thread, */
+/* wait until emulation thread reached next synchronization point and waits for batch  */
+/* completion, as it would have executed the batch itself without a SUB-CPU thread    */
+static void scd_thread_wait(void)
+{
+  t_scd_thread *st = scd_thread;
+
+  if (!scd_relax.async || __atomic_load_n(&st->joining, __ATOMIC_SEQ_CST))
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&st->lock);
+  while (!__atomic_load_n(&st->joining, __ATOMIC_SEQ_CST))
+  {
+    pthread_cond_wait(&st->work, &st->lock);
+  }
+  pthread_mutex_unlock(&st->lock);
+}
+
+static void scd_thread_start(void)
+{
+  t_scd_thread *st = scd_thread;
+
+  scd_relax.async = 1;
+
+  pthread_mutex_lock(&st->lock);
+  __atomic_store_n(&st->busy, 1, __ATOMIC_SEQ_CST);
+  pthread_cond_signal(&st->work);
+  pthread_mutex_unlock(&st->lock);
+}
+
+static void scd_thread_join(void)
+{
+  t_scd_thread *st = scd_thread;
+  int i;
+
+  for (i = 0; (i < st->spin) && __atomic_load_n(&st->busy, __ATOMIC_SEQ_CST); i++);
+  if (__atomic_load_n(&st->busy, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock(&st->lock);
+    __atomic_store_n(&st->joining, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&st->work);
+    while (__atomic_load_n(&st->busy, __ATOMIC_SEQ_CST))
+    {
+      pthread_cond_wait(&st->done, &st->lock);
+    }
+    __atomic_store_n(&st->joining, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&st->lock);
+  }
+
+  scd_relax.async = 0;
+}
+
+int scd_thread_init(void)
+{
+  t_scd_thread *st;
+
+  if (scd_thread)
+  {
+    return 0;
+  }
+
+  st = (t_scd_thread *)calloc(1, sizeof(t_scd_thread));
+  if (!st)
+  {
+    return 0;
+  }
+
+  /* polling is only useful if both threads can run concurrently */
+#ifdef _SC_NPROCESSORS_ONLN
+  if (sysconf(_SC_NPROCESSORS_ONLN) > 1)
+  {
+    st->spin = SCD_THREAD_SPIN;
+  }
+#endif
+
+  pthread_mutex_init(&st->lock, NULL);
+  pthread_cond_init(&st->work, NULL);
+  pthread_cond_init(&st->done, NULL);
+
+  if (pthread_create(&st->thread, NULL, scd_thread_main, st))
+  {
+    pthread_cond_destroy(&st->done);
+    pthread_cond_destroy(&st->work);
+    pthread_mutex_destroy(&st->lock);
+    free(st);
+    return 0;
+  }
+
+  scd_thread = st;
+  scd_thread_active = 1;
+  return 1;
+}
+
+void scd_thread_shutdown(void)
+{
+  t_scd_thread *st = scd_thread;
+
+  if (!st)
+  {
+    return;
+  }
+
+  /* complete pending batch */
+  if (scd_relax.async)
+  {
+    scd_thread_join();
+  }
+
+  pthread_mutex_lock(&st->lock);
+  st->quit = 1;
+  pthread_cond_signal(&st->work);
+  pthread_mutex_unlock(&st->lock);
+
+  pthread_join(st->thread, NULL);
+  pthread_cond_destroy(&st->done);
+  pthread_cond_destroy(&st->work);
+  pthread_mutex_destroy(&st->lock);
+  free(st);
+
+  scd_thread = NULL;
+  scd_thread_active = 0;
+}
+#endif
+
 /*--------------------------------------------------------------------------*/
 /* Unused area (return open bus data, i.e prefetched instruction word)      */
 /*--------------------------------------------------------------------------*/
@@ -111,6 +321,7 @@ void prg_ram_dma_w(unsigned int words)
 
     /* write 16-bit word to PRG-RAM */
     *(uint16 *)(scd.prg_ram + dst_index) = data ;
+    MARK_STATE_DIRTY(scd.prg_ram + dst_index);
 
     /* increment CDC buffer source address */
     src_index = (src_index + 2) & 0x3ffe;
@@ -129,6 +340,7 @@ static void prg_ram_write_byte(unsigned int address, unsigned int data)
   if (address >= (scd.regs[0x02>>1].byte.h << 9))
   {
     WRITE_BYTE(scd.prg_ram, address, data);
+    MARK_STATE_DIRTY(scd.prg_ram + address);
     return;
   }
 #ifdef LOGERROR
@@ -142,6 +354,7 @@ static void prg_ram_write_word(unsigned int address, unsigned int data)
   if (address >= (scd.regs[0x02>>1].byte.h << 9))
   {
     *(uint16 *)(scd.prg_ram + address) = data;
+    MARK_STATE_DIRTY(scd.prg_ram + address);
     return;
   }
 #ifdef LOGERROR
@@ -175,6 +388,7 @@ static void prg_ram_z80_write_byte(unsigned int address, unsigned int data)
   else
   {
     WRITE_BYTE(m68k.memory_map[offset].base, address & 0xffff, data);
+    MARK_STATE_DIRTY(m68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -213,6 +427,7 @@ static void prg_ram_m68k_write_byte(unsigned int address, unsigned int data)
   else
   {
     WRITE_BYTE(m68k.memory_map[offset].base, address & 0xffff, data);
+    MARK_STATE_DIRTY(m68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -227,6 +442,7 @@ static void prg_ram_m68k_write_word(unsigned int address, unsigned int data)
   else
   {
     *(uint16 *)(m68k.memory_map[offset].base + (address & 0xffff)) = data;
+    MARK_STATE_DIRTY(m68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -256,6 +472,7 @@ static void word_ram_z80_write_byte(unsigned int address, unsigned int data)
   else
   {
     WRITE_BYTE(m68k.memory_map[offset].base, address & 0xffff, data);
+    MARK_STATE_DIRTY(m68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -294,6 +511,7 @@ static void word_ram_m68k_write_byte(unsigned int address, unsigned int data)
   else
   {
     WRITE_BYTE(m68k.memory_map[offset].base, address & 0xffff, data);
+    MARK_STATE_DIRTY(m68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -308,6 +526,7 @@ static void word_ram_m68k_write_word(unsigned int address, unsigned int data)
   else
   {
     *(uint16 *)(m68k.memory_map[offset].base + (address & 0xffff)) = data;
+    MARK_STATE_DIRTY(m68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -346,6 +565,7 @@ static void word_ram_s68k_write_byte(unsigned int address, unsigned int data)
   else
   {
     WRITE_BYTE(s68k.memory_map[offset].base, address & 0xffff, data);
+    MARK_STATE_DIRTY(s68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -360,6 +580,7 @@ static void word_ram_s68k_write_word(unsigned int address, unsigned int data)
   else
   {
     *(uint16 *)(s68k.memory_map[offset].base + (address & 0xffff)) = data;
+    MARK_STATE_DIRTY(s68k.memory_map[offset].base + (address & 0xffff));
   }
 }
 
@@ -445,8 +666,13 @@ static void s68k_poll_sync(unsigned int reg_mask)
   /* relative MAIN-CPU cycle counter */
   unsigned int cycles = (s68k.cycles * MCYCLES_PER_LINE) / SCYCLES_PER_LINE;
 
-  /* sync MAIN-CPU with SUB-CPU */
-  if (!m68k.stopped)
+#ifdef USE_SCD_THREAD
+  /* MAIN-CPU state is accessed below */
+  scd_thread_wait();
+#endif
+
+  /* sync MAIN-CPU with SUB-CPU (unless it is already ahead) */
+  if (!scd_relax.ahead && !m68k.stopped)
   {
     m68k_run(cycles);
   }
@@ -454,6 +680,12 @@ static void s68k_poll_sync(unsigned int reg_mask)
   /* MAIN-CPU idle on register polling ? */
   if (m68k.stopped & reg_mask)
   {
+    /* MAIN-CPU already executed previous lines if SUB-CPU is catching up (relaxed synchronization) */
+    if (cycles < mcycles_vdp)
+    {
+      cycles = mcycles_vdp;
+    }
+
     /* sync MAIN-CPU with SUB-CPU */
     m68k.cycles = cycles;
 
@@ -467,6 +699,9 @@ static void s68k_poll_sync(unsigned int reg_mask)
   /* clear CPU register access flags */
   s68k.poll.detected &= ~reg_mask;
   m68k.poll.detected &= ~reg_mask;
+
+  /* CPUs are communicating, next lines are executed in sync */
+  scd_relax.request = 1;
 }
 
 /*--------------------------------------------------------------------------*/
@@ -664,7 +899,7 @@ static unsigned int scd_read_word(unsigned int address)
   /* MAIN-CPU communication words */
   if ((address & 0x1f0) == 0x10)
   {
-    if (!m68k.stopped)
+    if (!scd_relax.ahead && !m68k.stopped)
     {
       /* relative MAIN-CPU cycle counter */
       unsigned int cycles = (s68k.cycles * MCYCLES_PER_LINE) / SCYCLES_PER_LINE;
@@ -694,6 +929,10 @@ INLINE void word_ram_switch(uint8 mode)
   uint16 *ptr2 = (uint16 *)(scd.word_ram[0]);
   uint16 *ptr3 = (uint16 *)(scd.word_ram[1]);
 
+  /* whole Word-RAM is modified */
+  state_mark_dirty(scd.word_ram_2M, sizeof(scd.word_ram_2M));
+  state_mark_dirty((uint8 *)scd.word_ram, sizeof(scd.word_ram));
+
   if (mode & 0x04)
   {
     /* 2M -> 1M mode */
@@ -1532,6 +1771,11 @@ void scd_init(void)
 
 void scd_reset(int hard)
 {
+#ifdef USE_SCD_THREAD
+  /* MAIN-CPU state is accessed below */
+  scd_thread_wait();
+#endif
+
   /* TODO: figure what exactly is resetted when RESET bit is cleared by SUB-CPU */
   if (hard)
   {
@@ -1541,6 +1785,12 @@ void scd_reset(int hard)
     /* Clear pending DMNA write status */
     scd.dmna = 0;
 
+    /* Both CPU are in sync */
+    scd_relax.pending = 0;
+    scd_relax.batch = 0;
+    scd_relax.request = 0;
+    scd_relax.lockstep = 0;
+
     /* H-INT default vector */
     *(uint16 *)(m68k.memory_map[scd.cartridge.boot].base + 0x70) = 0x00FF;
     *(uint16 *)(m68k.memory_map[scd.cartridge.boot].base + 0x72) = 0xFFFF;
@@ -1616,7 +1866,7 @@ void scd_reset(int hard)
   pcm_reset();
 }
 
-void scd_update(unsigned int cycles)
+static void scd_run_line(unsigned int cycles)
 {
   /* update CDC DMA transfer */
   if (cdc.dma_w)
@@ -1624,13 +1874,21 @@ void scd_update(unsigned int cycles)
     cdc_dma_update();
   }
 
-  /* run both CPU in sync until end of line */
-  do
+  if (scd_relax.ahead)
   {
-    m68k_run(cycles);
+    /* MAIN-CPU already executed this line */
     s68k_run(scd.cycles + SCYCLES_PER_LINE);
   }
-  while ((m68k.cycles < cycles) || (s68k.cycles < (scd.cycles + SCYCLES_PER_LINE)));
+  else
+  {
+    /* run both CPU in sync until end of line */
+    do
+    {
+      m68k_run(cycles);
+      s68k_run(scd.cycles + SCYCLES_PER_LINE);
+    }
+    while ((m68k.cycles < cycles) || (s68k.cycles < (scd.cycles + SCYCLES_PER_LINE)));
+  }
 
   /* increment CD hardware cycle counter */
   scd.cycles += SCYCLES_PER_LINE;
@@ -1693,6 +1951,126 @@ void scd_update(unsigned int cycles)
   }
 }
 
+static void scd_run_batch(void)
+{
+  unsigned int cycles = scd_relax.batch_cycles;
+  int lines = scd_relax.batch;
+
+  /* run SUB-CPU until the end of batch lines */
+  scd_relax.ahead = 1;
+  while (lines--)
+  {
+    scd_run_line(cycles);
+    cycles += MCYCLES_PER_LINE;
+  }
+  scd_relax.ahead = 0;
+  scd_relax.batch = 0;
+}
+
+static void scd_join(void)
+{
+#ifdef USE_SCD_THREAD
+  if (scd_relax.async)
+  {
+    /* wait for batch executed by SUB-CPU thread */
+    scd_thread_join();
+  }
+#endif
+
+  /* execute remaining batch */
+  if (scd_relax.batch)
+  {
+    scd_run_batch();
+  }
+
+  /* SUB-CPU accessed shared registers ? */
+  scd_relax.lockstep = scd_relax.request;
+  scd_relax.request = 0;
+}
+
+void scd_update(unsigned int cycles)
+{
+  if (scd_relax.lines > 1)
+  {
+    /* MAIN-CPU runs ahead of SUB-CPU */
+    m68k_run(cycles);
+
+    if (!scd_relax.pending++)
+    {
+      scd_relax.cycles = cycles;
+    }
+
+    /* SUB-CPU catches up when MAIN-CPU is idle on SUB-CPU register polling (bits 0-1 are */
+    /* used by STOP & HALT) or at the end of the frame */
+    if ((m68k.stopped & ~3) || (cycles >= (lines_per_frame * MCYCLES_PER_LINE)))
+    {
+      scd_sync();
+      return;
+    }
+
+    /* pending lines are handed to SUB-CPU once enough lines are pending or after it accessed shared registers */
+    if ((scd_relax.pending < scd_relax.lines) && !scd_relax.lockstep)
+    {
+      scd_relax.saved++;
+      return;
+    }
+
+    scd_join();
+
+    scd_relax.batch = scd_relax.pending;
+    scd_relax.batch_cycles = scd_relax.cycles;
+    scd_relax.pending = 0;
+
+#ifdef USE_SCD_THREAD
+    /* PRG-RAM can be accessed by MAIN-CPU while it is being written by CDC DMA */
+    if (scd_thread && (cdc.dma_w != prg_ram_dma_w)
+#ifdef USE_PROFILER
+        && !profiler_active
+#endif
+       )
+    {
+      /* batch is executed while MAIN-CPU runs next lines */
+      scd_thread_start();
+    }
+#endif
+    return;
+  }
+
+  /* run both CPU in sync */
+  scd_run_line(cycles);
+}
+
+void scd_sync(void)
+{
+  int lines = scd_relax.pending;
+  unsigned int cycles = scd_relax.cycles;
+
+  /* previous batch is completed first */
+  scd_join();
+
+  /* lines are cleared first as SUB-CPU execution can trigger MAIN-CPU shared register accesses */
+  scd_relax.pending = 0;
+
+  /* run both CPU in sync until the end of pending lines */
+  while (lines--)
+  {
+    scd_run_line(cycles);
+    cycles += MCYCLES_PER_LINE;
+  }
+}
+
+void scd_set_sync_lines(int lines)
+{
+  /* pending lines are executed by SUB-CPU before synchronization interval is modified */
+  scd_sync();
+  scd_relax.lines = lines;
+}
+
+unsigned int scd_sync_saved(void)
+{
+  return scd_relax.last;
+}
+
 void scd_end_frame(unsigned int cycles)
 {
   /* run Stopwatch until end of frame */
@@ -1709,6 +2087,10 @@ void scd_end_frame(unsigned int cycles)
   /* reset CPU registers polling */
   m68k.poll.cycle = 0;
   s68k.poll.cycle = 0;
+
+  /* count deferred CPU synchronizations */
+  scd_relax.last = scd_relax.saved;
+  scd_relax.saved = 0;
 }
 
 int scd_context_save(uint8 *state)
@@ -1738,18 +2120,18 @@ int scd_context_save(uint8 *state)
   bufferptr += pcm_context_save(&state[bufferptr]);
 
   /* PRG-RAM */
-  save_param(scd.prg_ram, sizeof(scd.prg_ram));
+  save_ram(scd.prg_ram, sizeof(scd.prg_ram));
 
   /* Word-RAM */
   if (scd.regs[0x03>>1].byte.l & 0x04)
   {
     /* 1M mode */
-    save_param(scd.word_ram, sizeof(scd.word_ram));
+    save_ram((uint8 *)scd.word_ram, sizeof(scd.word_ram));
   }
   else
   {
     /* 2M mode */
-    save_param(scd.word_ram_2M, sizeof(scd.word_ram_2M));
+    save_ram(scd.word_ram_2M, sizeof(scd.word_ram_2M));
   }
 
   /* MAIN-CPU & SUB-CPU polling */
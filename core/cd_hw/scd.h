@@ -44,6 +44,12 @@
 #include "pcm.h"
 #include "cd_cart.h"
 
+#ifdef USE_SCD_THREAD
+#ifdef USE_MULTI_INSTANCE
+#error "USE_SCD_THREAD can not be used with USE_MULTI_INSTANCE (SUB-CPU thread shares emulation thread state)"
+#endif
+#endif
+
 #ifdef USE_DYNAMIC_ALLOC
 #define scd ext->cd_hw
 #else
@@ -87,6 +93,14 @@ extern void scd_init(void);
 extern void scd_reset(int hard);
 extern void scd_update(unsigned int cycles);
 extern void scd_end_frame(unsigned int cycles);
+extern void scd_sync(void);
+extern void scd_set_sync_lines(int lines);
+extern unsigned int scd_sync_saved(void);
+#ifdef USE_SCD_THREAD
+extern int scd_thread_active;
+extern int scd_thread_init(void);
+extern void scd_thread_shutdown(void);
+#endif
 extern int scd_context_load(uint8 *state);
 extern int scd_context_save(uint8 *state);
 extern int scd_68k_irq_ack(int level);
@@ -0,0 +1,192 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Emulator instance context
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+struct gpgx_context
+{
+  unsigned int frame_count;   /* number of emulated frames since context creation */
+};
+
+/* context bound to current thread (process-wide without USE_MULTI_INSTANCE) */
+static THREAD_LOCAL gpgx_context_t *current;
+
+/* set once current thread has hosted an instance (emulated state is not reinitialized on deletion) */
+static THREAD_LOCAL int hosted;
+
+gpgx_context_t *gpgx_context_new(void)
+{
+  gpgx_context_t *ctx;
+
+  /* only one instance can ever be hosted by a single thread */
+  if (hosted)
+  {
+    return NULL;
+  }
+
+  ctx = (gpgx_context_t *)calloc(1, sizeof(gpgx_context_t));
+  if (!ctx)
+  {
+    return NULL;
+  }
+
+  current = ctx;
+  hosted = 1;
+  return ctx;
+}
+
+void gpgx_context_delete(gpgx_context_t *ctx)
+{
+  if (!ctx || (ctx != current))
+  {
+    return;
+  }
+
+  /* release CD image files */
+#ifdef USE_DYNAMIC_ALLOC
+  if (ext && (system_hw == SYSTEM_MCD))
+#else
+  if (system_hw == SYSTEM_MCD)
+#endif
+  {
+    cdd_unload();
+  }
+
+#ifdef USE_RENDER_THREAD
+  /* stop render thread */
+  render_thread_shutdown();
+#endif
+
+#ifdef USE_YM3438_THREAD
+  /* stop YM3438 thread */
+  ym3438_thread_shutdown();
+#endif
+
+#ifdef USE_SCD_THREAD
+  /* stop SUB-CPU thread */
+  scd_thread_shutdown();
+#endif
+
+#ifdef USE_M68K_BLOCK_CACHE
+  /* release 68k block caches */
+  m68k_shutdown();
+  s68k_shutdown();
+#endif
+
+#ifdef USE_SVP_BLOCK_CACHE
+  /* release SVP block translator */
+  ssp1601_shutdown();
+#endif
+
+#ifdef USE_PROFILER
+  /* release hotspot profiler */
+  profiler_shutdown();
+#endif
+
+  /* release audio resampling buffers & native-rate output streams */
+  audio_shutdown();
+  audio_stream_shutdown();
+
+  /* release rewind buffer & delta savestate image */
+  rewind_shutdown();
+  state_delta_shutdown();
+
+#ifdef USE_DYNAMIC_ALLOC
+  /* release Cartridge / CD hardware memory, pattern cache & FM output buffer */
+  free(ext);
+  ext = NULL;
+  render_free();
+  sound_free();
+#endif
+
+  current = NULL;
+  free(ctx);
+}
+
+gpgx_context_t *gpgx_context_current(void)
+{
+  return current;
+}
+
+void gpgx_context_frame(gpgx_context_t *ctx, int do_skip)
+{
+  if (ctx != current)
+  {
+    return;
+  }
+
+  if (system_hw == SYSTEM_MCD)
+  {
+    system_frame_scd(do_skip);
+  }
+  else if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  {
+    system_frame_gen(do_skip);
+  }
+  else
+  {
+    system_frame_sms(do_skip);
+  }
+
+  ctx->frame_count++;
+}
+
+int gpgx_context_state_save(gpgx_context_t *ctx, unsigned char *state)
+{
+  if (ctx != current)
+  {
+    return 0;
+  }
+
+  return state_save(state);
+}
+
+int gpgx_context_state_load(gpgx_context_t *ctx, unsigned char *state)
+{
+  if (ctx != current)
+  {
+    return 0;
+  }
+
+  return state_load(state);
+}
+
+unsigned int gpgx_context_frame_count(gpgx_context_t *ctx)
+{
+  return ctx ? ctx->frame_count : 0;
+}
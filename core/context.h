@@ -0,0 +1,77 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Emulator instance context
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+/* Handle on the emulator instance hosted by current thread (opaque) */
+typedef struct gpgx_context gpgx_context_t;
+
+/* One instance per host thread.                                                         */
+/*                                                                                       */
+/* Emulated hardware state is not owned by the context: it is declared with THREAD_LOCAL */
+/* storage class (see macros.h), as is the frontend configuration (config). When         */
+/* compiled with USE_MULTI_INSTANCE, each host thread holds its own copy of that state,  */
+/* so a process can run as many independent instances as it has threads. With            */
+/* USE_DYNAMIC_ALLOC, the largest buffers (cartridge & CD hardware, pattern cache, FM    */
+/* output buffer) are allocated on the heap when a game is loaded, so that threads which */
+/* do not host an instance (render or YM3438 threads) only get a small copy of           */
+/* thread-local storage.                                                                 */
+/*                                                                                       */
+/* A context is bound to the thread that created it and can not be moved to another      */
+/* thread: that thread must be used for configuration, ROM loading, frame emulation and  */
+/* savestates until the context is deleted. Context functions do nothing when called     */
+/* from another thread.                                                                  */
+/*                                                                                       */
+/* Deleting a context releases its buffers but does not reinitialize emulated state, so  */
+/* a thread can only host one instance during its lifetime: gpgx_context_new() returns   */
+/* NULL on a thread which already hosted one, and a new thread must be used for the next */
+/* instance.                                                                             */
+/*                                                                                       */
+/* Without USE_MULTI_INSTANCE, only one context can be created per process.              */
+
+/* Function prototypes */
+extern gpgx_context_t *gpgx_context_new(void);
+extern void gpgx_context_delete(gpgx_context_t *ctx);
+extern gpgx_context_t *gpgx_context_current(void);
+extern void gpgx_context_frame(gpgx_context_t *ctx, int do_skip);
+extern int gpgx_context_state_save(gpgx_context_t *ctx, unsigned char *state);
+extern int gpgx_context_state_load(gpgx_context_t *ctx, unsigned char *state);
+extern unsigned int gpgx_context_frame_count(gpgx_context_t *ctx);
+
+#endif /* _CONTEXT_H_ */
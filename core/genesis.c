@@ -42,18 +42,18 @@
 #include "shared.h"
 
 #ifdef USE_DYNAMIC_ALLOC
-external_t *ext;
+THREAD_LOCAL external_t *ext;
 #else                     /* External Hardware (Cartridge, CD unit, ...) */
-external_t ext;
+THREAD_LOCAL external_t ext;
 #endif
-uint8 boot_rom[0x800];    /* Genesis BOOT ROM   */
-uint8 work_ram[0x10000];  /* 68K RAM  */
-uint8 zram[0x2000];       /* Z80 RAM  */
-uint32 zbank;             /* Z80 bank window address */
-uint8 zstate;             /* Z80 bus state (d0 = BUSACK, d1 = /RESET) */
-uint8 pico_current;       /* PICO current page */
+THREAD_LOCAL uint8 boot_rom[0x800];    /* Genesis BOOT ROM   */
+THREAD_LOCAL uint8 work_ram[0x10000];  /* 68K RAM  */
+THREAD_LOCAL uint8 zram[0x2000];       /* Z80 RAM  */
+THREAD_LOCAL uint32 zbank;             /* Z80 bank window address */
+THREAD_LOCAL uint8 zstate;             /* Z80 bus state (d0 = BUSACK, d1 = /RESET) */
+THREAD_LOCAL uint8 pico_current;       /* PICO current page */
 
-static uint8 tmss[4];     /* TMSS security register */
+static THREAD_LOCAL uint8 tmss[4];     /* TMSS security register */
 
 /*--------------------------------------------------------------------------*/
 /* Init, reset, shutdown functions                                          */
@@ -66,6 +66,15 @@ void gen_init(void)
   /* initialize Z80 */
   z80_init(0,z80_irq_callback);
 
+  /* snapshot areas */
+  snapshot_var(work_ram);
+  snapshot_var(zram);
+  snapshot_var(zbank);
+  snapshot_var(zstate);
+  snapshot_var(pico_current);
+  snapshot_var(tmss);
+  snapshot_var(zbank_memory_map);
+
   /* 8-bit / 16-bit modes */
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
@@ -147,6 +156,13 @@ void gen_init(void)
         z80_readmap[i] = &zram[(i & 7) << 10];
       }
 
+      /* $0000-$3FFF is read & written directly */
+      for (i=0; i<16; i++)
+      {
+        z80_writemap[i] = z80_readmap[i];
+        z80_readmap_direct[i] = z80_writemap_direct[i] = 1;
+      }
+
       /* initialize Z80 memory handlers */
       z80_writemem  = z80_memory_w;
       z80_readmem   = z80_memory_r;
@@ -430,6 +446,9 @@ void gen_bankswitch_w(unsigned int data)
       /* enable internal BOOT ROM */
       m68k.memory_map[0].base = boot_rom;
     }
+
+    /* discard cached 68k instructions */
+    m68k_block_flush();
   }
 }
 
@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -46,6 +46,8 @@ static struct
 
 void activator_reset(int index)
 {
+  /* snapshot areas */
+  snapshot_var(activator);
 
   activator[index].State = 0x40;
   activator[index].Counter = 0;
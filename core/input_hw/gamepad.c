@@ -40,7 +40,7 @@
 #include "shared.h"
 #include "gamepad.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -48,17 +48,22 @@ static struct
   uint32 Latency;
 } gamepad[MAX_DEVICES];
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 Latch;
   uint8 Counter;
 } flipflop[2];
 
-static uint8 latch;
+static THREAD_LOCAL uint8 latch;
 
 
 void gamepad_reset(int port)
 {
+  /* snapshot areas */
+  snapshot_var(gamepad);
+  snapshot_var(flipflop);
+  snapshot_var(latch);
+
   /* default state (Gouketsuji Ichizoku / Power Instinct, Samurai Spirits / Samurai Shodown) */
   gamepad[port].State = 0x40;
   gamepad[port].Counter = 0;
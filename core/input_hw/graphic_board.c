@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -47,6 +47,9 @@ static struct
 
 void graphic_board_reset(int port)
 {
+  /* snapshot areas */
+  snapshot_var(board);
+
   input.analog[0][0] = 128;
   input.analog[0][1] = 128;
   board.State = 0x7f;
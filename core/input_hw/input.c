@@ -49,8 +49,8 @@
 #include "terebi_oekaki.h"
 #include "graphic_board.h"
 
-t_input input;
-int old_system[2] = {-1,-1};
+THREAD_LOCAL t_input input;
+THREAD_LOCAL int old_system[2] = {-1,-1};
 
 
 void input_init(void)
@@ -58,6 +58,9 @@ void input_init(void)
   int i, padtype;
   int player = 0;
 
+  /* snapshot areas */
+  snapshot_var(input);
+
   for (i=0; i<MAX_DEVICES; i++)
   {
     input.dev[i] = NO_DEVICE;
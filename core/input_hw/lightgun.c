@@ -83,7 +83,7 @@ static const uint8 hc_320[210] =
   0xFE, 0xFF
 };
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Port;
@@ -92,6 +92,9 @@ static struct
 
 void lightgun_reset(int port)
 {
+  /* snapshot areas */
+  snapshot_var(lightgun);
+
   input.analog[port][0] = bitmap.viewport.w / 2;
   input.analog[port][1] = bitmap.viewport.h / 2;
   lightgun.State = 0x40;
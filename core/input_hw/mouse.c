@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -48,6 +48,9 @@ static struct
 
 void mouse_reset(int port)
 {
+  /* snapshot areas */
+  snapshot_var(mouse);
+
   input.analog[port][0] = 0;
   input.analog[port][1] = 0;
   mouse.State = 0x60;
@@ -38,13 +38,16 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
 } paddle[2];
 
 void paddle_reset(int index)
 {
+  /* snapshot areas */
+  snapshot_var(paddle);
+
   input.analog[index][0] = 128;
   paddle[index>>2].State = 0x40;
 }
@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -46,6 +46,9 @@ static struct
 
 void sportspad_reset(int index)
 {
+  /* snapshot areas */
+  snapshot_var(sportspad);
+
   input.analog[index][0] = 128;
   input.analog[index][1] = 128;
   sportspad[index>>2].State = 0x40;
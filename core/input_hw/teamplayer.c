@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -76,6 +76,9 @@ void teamplayer_init(int port)
 
 void teamplayer_reset(int port)
 {
+  /* snapshot areas */
+  snapshot_var(teamplayer);
+
   teamplayer[port].State = 0x60; /* TH = 1, TR = 1 */
   teamplayer[port].Counter = 0;
 }
@@ -38,7 +38,7 @@
 
 #include "shared.h"
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 axis;
   uint8 busy;
@@ -46,6 +46,9 @@ static struct
 
 void terebi_oekaki_reset(void)
 {
+  /* snapshot areas */
+  snapshot_var(tablet);
+
   input.analog[0][0] = 128;
   input.analog[0][1] = 128;
   tablet.axis = 1;
@@ -40,7 +40,7 @@
 
 #define XE_1AP_LATENCY 3
 
-static struct
+static THREAD_LOCAL struct
 {
   uint8 State;
   uint8 Counter;
@@ -49,6 +49,9 @@ static struct
 
 void xe_1ap_reset(int index)
 {
+  /* snapshot areas */
+  snapshot_var(xe_1ap);
+
   input.analog[index][0] = 128;
   input.analog[index][1] = 128;
   input.analog[index+1][0] = 128;
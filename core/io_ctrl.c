@@ -50,11 +50,11 @@
 #include "sportspad.h"
 #include "graphic_board.h"
 
-uint8 io_reg[0x10];
+THREAD_LOCAL uint8 io_reg[0x10];
 
-uint8 region_code = REGION_USA;
+THREAD_LOCAL uint8 region_code = REGION_USA;
 
-static struct port_t
+static THREAD_LOCAL struct port_t
 {
   void (*data_w)(unsigned char data, unsigned char mask);
   unsigned char (*data_r)(void);
@@ -78,6 +78,10 @@ void io_init(void)
   /* Initialize connected peripherals */
   input_init();
 
+  /* snapshot areas */
+  snapshot_var(io_reg);
+  snapshot_var(port);
+
   /* Initialize IO Ports handlers & connected peripherals */
   switch (input.system[0])
   {
@@ -89,10 +89,10 @@ typedef struct
 } PERIPHERALINFO;
 
 
-ROMINFO rominfo;
-uint8 romtype;
+THREAD_LOCAL ROMINFO rominfo;
+THREAD_LOCAL uint8 romtype;
 
-static uint8 rom_region;
+static THREAD_LOCAL uint8 rom_region;
 
 /***************************************************************************
  * Genesis ROM Manufacturers
@@ -538,6 +538,9 @@ int load_rom(char *filename)
     ext = (external_t *)calloc(1, sizeof(external_t));
     if (!ext) return (0);
   }
+
+  /* allocate pattern cache & FM output buffer if required */
+  if (!render_alloc() || !sound_alloc()) return (0);
 #endif
 
   /* clear any existing patches */
@@ -62,8 +62,8 @@ typedef struct
 
 
 /* Global variables */
-extern ROMINFO rominfo;
-extern uint8 romtype;
+extern THREAD_LOCAL ROMINFO rominfo;
+extern THREAD_LOCAL uint8 romtype;
 
 /* Function prototypes */
 extern int load_bios(int system);
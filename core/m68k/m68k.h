@@ -229,11 +229,23 @@ typedef struct
   uint detected;
 } cpu_idle_t;
 
+/* 68k busy-wait loop skipping */
+typedef struct
+{
+  uint pc;          /* loop start address */
+  uint cycle;       /* cycle count at previous loop iteration */
+  uint horizon;     /* memory is unchanged & I/O reads return same values until this cycle count */
+  uint io;          /* same for current I/O read (set by I/O read handlers, 0 by default) */
+  uint armed;       /* CPU registers at previous loop iteration are valid */
+  uint regs[24];    /* CPU registers at previous loop iteration */
+} cpu_skip_t;
+
 typedef struct
 {
   cpu_memory_map memory_map[256]; /* memory mapping */
 
   cpu_idle_t poll;      /* polling detection */
+  cpu_skip_t skip;      /* busy-wait loop skipping */
 
   uint cycles;          /* current master cycle count */ 
   uint cycle_end;       /* aimed master cycle count for current execution frame */
@@ -280,8 +292,8 @@ typedef struct
 } m68ki_cpu_core;
 
 /* CPU cores */
-extern m68ki_cpu_core m68k;
-extern m68ki_cpu_core s68k;
+extern THREAD_LOCAL m68ki_cpu_core m68k;
+extern THREAD_LOCAL m68ki_cpu_core s68k;
 
 
 /* ======================================================================== */
@@ -379,6 +391,38 @@ extern void m68k_clear_halt(void);
 extern void s68k_pulse_halt(void);
 extern void s68k_clear_halt(void);
 
+#ifdef USE_M68K_BLOCK_CACHE
+/* Release memory allocated by the block cache */
+extern void m68k_shutdown(void);
+extern void s68k_shutdown(void);
+
+/* Enable or disable main 68k block cache at runtime (for benchmarking) */
+extern void m68k_set_block_cache(int enable);
+
+/* Set write-protected cartridge ROM area, where cached opcodes are not fetched again */
+extern void m68k_set_rom_area(const unsigned char *rom, unsigned int size);
+
+/* Discard cached instructions (must be called when ROM banks are remapped or modified) */
+extern void m68k_block_flush(void);
+#else
+#define m68k_set_rom_area(rom, size)
+#define m68k_block_flush()
+#endif
+
+#ifdef USE_IDLE_SKIP
+/* Number of main 68k cycles skipped in busy-wait loops since initialization */
+extern THREAD_LOCAL unsigned long long m68k_idle_cycles;
+#endif
+
+#ifdef USE_EVENT_SCHEDULER
+/* Set the callback for the end of main 68k execution frames.
+ * Each time the cycle count given to m68k_run() is reached, the callback is
+ * called and execution continues until the cycle count it returns (unless 0),
+ * so timed events can be processed without leaving the execution loop.
+ */
+extern void m68k_set_event_callback(unsigned int (*callback)(void));
+#endif
+
 
 /* Peek at the internals of a CPU context.  This can either be a context
  * retrieved using m68k_get_context() or the currently running context.
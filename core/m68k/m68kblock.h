@@ -0,0 +1,193 @@
+/* ======================================================================== */
+/* ========================= BASIC BLOCK CACHE ============================ */
+/* ======================================================================== */
+
+/* Optional block cache (USE_M68K_BLOCK_CACHE), shared by both 68k cores.
+ *
+ * Instruction sequences executed by the interpreter are recorded as blocks of
+ * predecoded entries (opcode, handler, cycles), indexed by the host address
+ * of their first opcode, and are replayed on next executions without going
+ * through the 0x10000-entry opcode handler and cycle tables.
+ *
+ * A block stops at the first instruction that does not continue with the
+ * next one (branches, jumps, exceptions...), at the end of a 64KB bank or
+ * once it is full. During replay, each opcode word is still fetched from
+ * memory and compared with the recorded one before its handler is called, so
+ * execution is exactly the same as with the interpreter: blocks overwritten
+ * in RAM no longer match and are simply recorded again.
+ *
+ * Blocks recorded from write-protected cartridge ROM (see m68k_set_rom_area)
+ * are trusted instead: opcode words are not fetched again and only the
+ * program counter is checked before each instruction. This requires cartridge
+ * mappers and ROM patches to call m68k_block_flush() whenever ROM banks are
+ * remapped or modified, which discards all recorded blocks.
+ */
+
+#ifdef USE_M68K_BLOCK_CACHE
+
+#ifndef M68K_BLOCK_BITS
+#define M68K_BLOCK_BITS (12)
+#endif
+
+#define M68K_BLOCK_COUNT  (1 << M68K_BLOCK_BITS)
+#define M68K_BLOCK_LENGTH (16)
+
+typedef struct
+{
+  void (*handler)(void);          /* opcode handler */
+  uint pc;                        /* opcode address */
+  uint16 ir;                      /* opcode word */
+  uint16 cycles;                  /* opcode execution time */
+} m68ki_block_op_t;
+
+typedef struct
+{
+  const uint8 *host;              /* host address of first opcode */
+  uint pc;                        /* address of first opcode */
+  uint gen;                       /* cache generation when recorded */
+  uint rom;                       /* recorded from write-protected cartridge ROM */
+  uint length;                    /* number of recorded instructions */
+  m68ki_block_op_t op[M68K_BLOCK_LENGTH];
+} m68ki_block_t;
+
+/* Add execution time of a cached instruction. Its handler might have executed
+   next instruction as well (see m68k_set_irq_delay), in which case REG_IR has
+   changed and, as with the interpreter, only the last one is accounted here */
+#define USE_BLOCK_CYCLES(OP) USE_CYCLES(((OP).ir == REG_IR) ? (OP).cycles : CYC_INSTRUCTION[REG_IR])
+
+static THREAD_LOCAL m68ki_block_t *m68ki_block_cache;
+
+/* incremented on each flush, older blocks are ignored */
+static THREAD_LOCAL uint m68ki_block_gen;
+
+/* length of the block being replayed (cleared on flush) */
+static THREAD_LOCAL uint m68ki_block_length;
+
+/* write-protected cartridge ROM area */
+static THREAD_LOCAL const uint8 *m68ki_block_rom_start;
+static THREAD_LOCAL const uint8 *m68ki_block_rom_end;
+
+static int m68ki_block_cache_init(void)
+{
+  if (!m68ki_block_cache)
+  {
+    m68ki_block_cache = (m68ki_block_t *)calloc(M68K_BLOCK_COUNT, sizeof(m68ki_block_t));
+  }
+
+  return (m68ki_block_cache != NULL);
+}
+
+/* Execute one block of instructions, recording it first if needed */
+INLINE void m68ki_block_run(uint cycles)
+{
+  cpu_memory_map *map = &m68ki_cpu.memory_map[(REG_PC >> 16) & 0xff];
+  const uint8 *base = map->base;
+  const uint8 *host = base + (REG_PC & 0xffff);
+  size_t index = (size_t)host >> 1;
+  m68ki_block_t *block = &m68ki_block_cache[(index ^ (index >> M68K_BLOCK_BITS)) & (M68K_BLOCK_COUNT - 1)];
+  m68ki_block_op_t *op = block->op;
+  uint i = 0;
+
+  if ((block->host == host) && (block->pc == REG_PC) && (block->gen == m68ki_block_gen))
+  {
+    if (block->rom)
+    {
+      m68ki_block_length = block->length;
+
+      do
+      {
+        /* leave block on branch or exception */
+        if (REG_PC != op[i].pc)
+        {
+          return;
+        }
+
+        m68ki_trace_t1() /* auto-disable (see m68kcpu.h) */
+        m68ki_use_data_space() /* auto-disable (see m68kcpu.h) */
+
+        REG_PC += 2;
+        REG_IR = op[i].ir;
+
+        op[i].handler();
+        USE_BLOCK_CYCLES(op[i]);
+        m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+      }
+      while ((++i < m68ki_block_length) && (m68ki_cpu.cycles < cycles));
+
+      return;
+    }
+
+    do
+    {
+      m68ki_trace_t1() /* auto-disable (see m68kcpu.h) */
+      m68ki_use_data_space() /* auto-disable (see m68kcpu.h) */
+
+      REG_IR = m68ki_read_imm_16();
+
+      if (REG_IR != op[i].ir)
+      {
+        /* code has changed since it was recorded */
+        if (i == 0)
+        {
+          block->host = NULL;
+        }
+
+        /* execute fetched instruction and leave block */
+        m68ki_instruction_jump_table[REG_IR]();
+        USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+        m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+        return;
+      }
+
+      op[i].handler();
+      USE_BLOCK_CYCLES(op[i]);
+      m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+    }
+    while ((++i < block->length) && (m68ki_cpu.cycles < cycles));
+
+    return;
+  }
+
+  /* record a new block while executing it */
+  block->host = host;
+  block->pc = REG_PC;
+  block->gen = m68ki_block_gen;
+  block->rom = (host >= m68ki_block_rom_start) && (host < m68ki_block_rom_end) && map->write8 && map->write16;
+  block->length = 0;
+
+  do
+  {
+    uint pc = REG_PC;
+
+    m68ki_trace_t1() /* auto-disable (see m68kcpu.h) */
+    m68ki_use_data_space() /* auto-disable (see m68kcpu.h) */
+
+    REG_IR = m68ki_read_imm_16();
+
+    /* entry is valid before execution, in case of address error */
+    op[i].handler = m68ki_instruction_jump_table[REG_IR];
+    op[i].pc = pc;
+    op[i].ir = REG_IR;
+    op[i].cycles = CYC_INSTRUCTION[REG_IR];
+    block->length = ++i;
+
+    op[i-1].handler();
+    USE_BLOCK_CYCLES(op[i-1]);
+    m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+
+    /* instructions are 2 to 10 bytes long, anything else is a branch */
+    if ((REG_PC - pc - 2) > 8)
+    {
+      break;
+    }
+
+    /* blocks do not cross 64KB banks */
+    if ((REG_PC ^ pc) & 0xff0000)
+    {
+      break;
+    }
+  }
+  while ((i < M68K_BLOCK_LENGTH) && (m68ki_cpu.cycles < cycles));
+}
+
+#endif /* USE_M68K_BLOCK_CACHE */
@@ -72,6 +72,26 @@
  */
 #define M68K_CHECK_PC_ADDRESS_ERROR OPT_OFF
 
+/* If ON, loops polling unchanged memory or I/O registers are detected on
+ * backward branches and their remaining iterations are skipped up to the
+ * next event (end of execution frame or I/O register change), which gives
+ * exactly the same result as executing them.
+ */
+#ifdef USE_IDLE_SKIP
+#define M68K_IDLE_SKIP              OPT_ON
+#else
+#define M68K_IDLE_SKIP              OPT_OFF
+#endif
+
+/* If ON, instructions are executed through an instrumented loop while hotspot
+ * profiler is running (see profiler.h).
+ */
+#ifdef USE_PROFILER
+#define M68K_PROFILE                OPT_ON
+#else
+#define M68K_PROFILE                OPT_OFF
+#endif
+
 
 /* ----------------------------- COMPATIBILITY ---------------------------- */
 
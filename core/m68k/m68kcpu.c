@@ -6,6 +6,7 @@ extern int vdp_68k_irq_ack(int int_level);
 
 #define m68ki_cpu m68k
 #define MUL (7)
+#define PROFILER_CPU PROFILER_M68K
 
 /* ======================================================================== */
 /* ================================ INCLUDES ============================== */
@@ -18,6 +19,8 @@ extern int vdp_68k_irq_ack(int int_level);
 #include "m68kconf.h"
 #include "m68kcpu.h"
 #include "m68kops.h"
+#include "m68kblock.h"
+#include "m68kprofile.h"
 
 /* ======================================================================== */
 /* ================================= DATA ================================= */
@@ -27,9 +30,17 @@ extern int vdp_68k_irq_ack(int int_level);
 static unsigned char m68ki_cycles[0x10000];
 #endif
 
-static int irq_latency;
+static THREAD_LOCAL int irq_latency;
 
-m68ki_cpu_core m68k;
+THREAD_LOCAL m68ki_cpu_core m68k;
+
+#ifdef USE_IDLE_SKIP
+THREAD_LOCAL unsigned long long m68k_idle_cycles;
+#endif
+
+#ifdef USE_EVENT_SCHEDULER
+static THREAD_LOCAL unsigned int (*m68k_event_callback)(void);
+#endif
 
 
 /* ======================================================================== */
@@ -190,7 +201,7 @@ void m68k_set_fc_callback(void  (*callback)(unsigned int new_fc))
 
 #ifdef LOGVDP
 extern void error(char *format, ...);
-extern uint16 v_counter;
+extern THREAD_LOCAL uint16 v_counter;
 #endif
 
 /* ASG: rewrote so that the int_level is a mask of the IPL0/IPL1/IPL2 bits */
@@ -253,7 +264,16 @@ void m68k_set_irq_delay(unsigned int int_level)
   m68ki_check_interrupts(); /* Level triggered (IRQ) */
 }
 
+#ifdef USE_EVENT_SCHEDULER
+void m68k_set_event_callback(unsigned int (*callback)(void))
+{
+  m68k_event_callback = callback;
+}
+
+static void m68ki_run(unsigned int cycles)
+#else
 void m68k_run(unsigned int cycles) 
+#endif
 {
   /* Make sure CPU is not already ahead */
   if (m68k.cycles >= cycles)
@@ -274,6 +294,11 @@ void m68k_run(unsigned int cycles)
   /* Save end cycles count for when CPU is stopped */
   m68k.cycle_end = cycles;
 
+#if M68K_IDLE_SKIP
+  /* Busy-wait loops are not skipped across execution frames */
+  m68k.skip.horizon = 0;
+#endif
+
   /* Return point for when we have an address error (TODO: use goto) */
   m68ki_set_address_error_trap() /* auto-disable (see m68kcpu.h) */
 
@@ -281,8 +306,26 @@ void m68k_run(unsigned int cycles)
   error("[%d][%d] m68k run to %d cycles (%x), irq mask = %x (%x)\n", v_counter, m68k.cycles, cycles, m68k.pc,FLAG_INT_MASK, CPU_INT_LEVEL);
 #endif
 
+#if M68K_PROFILE
+  if (profiler_active)
+  {
+    /* Execute instructions through instrumented loop */
+    m68ki_profile_run(cycles);
+    return;
+  }
+#endif
+
   while (m68k.cycles < cycles)
   {
+#ifdef USE_M68K_BLOCK_CACHE
+    if (m68ki_block_cache)
+    {
+      /* Execute next block of cached instructions */
+      m68ki_block_run(cycles);
+      continue;
+    }
+#endif
+
     /* Set tracing accodring to T1. */
     m68ki_trace_t1() /* auto-disable (see m68kcpu.h) */
 
@@ -301,6 +344,18 @@ void m68k_run(unsigned int cycles)
   }
 }
 
+#ifdef USE_EVENT_SCHEDULER
+void m68k_run(unsigned int cycles)
+{
+  /* execution frames are chained as long as the event scheduler can process next events by itself */
+  do
+  {
+    m68ki_run(cycles);
+  }
+  while (m68k_event_callback && (cycles = m68k_event_callback()));
+}
+#endif
+
 int m68k_cycles(void)
 {
   return CYC_INSTRUCTION[REG_IR];
@@ -335,6 +390,23 @@ void m68k_init(void)
 #if M68K_EMULATE_FC == OPT_ON
   m68k_set_fc_callback(NULL);
 #endif
+
+#ifdef USE_M68K_BLOCK_CACHE
+  /* allocate block cache (instructions are interpreted one by one otherwise) */
+  m68ki_block_cache_init();
+
+  /* no trusted ROM area until a cartridge is loaded */
+  m68k_set_rom_area(NULL, 0);
+#endif
+
+#ifdef USE_IDLE_SKIP
+  /* reset skipped cycles counter */
+  m68k_idle_cycles = 0;
+#endif
+
+  /* snapshot areas */
+  snapshot_var(m68k);
+  snapshot_var(irq_latency);
 }
 
 /* Pulse the RESET line on the CPU */
@@ -389,6 +461,44 @@ void m68k_clear_halt(void)
   CPU_STOPPED &= ~STOP_LEVEL_HALT;
 }
 
+#ifdef USE_M68K_BLOCK_CACHE
+void m68k_shutdown(void)
+{
+  /* Release block cache */
+  free(m68ki_block_cache);
+  m68ki_block_cache = NULL;
+}
+
+void m68k_set_block_cache(int enable)
+{
+  if (enable)
+  {
+    m68ki_block_cache_init();
+  }
+  else
+  {
+    m68k_shutdown();
+  }
+}
+
+void m68k_set_rom_area(const unsigned char *rom, unsigned int size)
+{
+  m68ki_block_rom_start = rom;
+  m68ki_block_rom_end = rom + size;
+
+  /* blocks recorded from previous ROM area are no longer trusted */
+  m68k_block_flush();
+}
+
+void m68k_block_flush(void)
+{
+  m68ki_block_gen++;
+
+  /* stop block being replayed, if any */
+  m68ki_block_length = 0;
+}
+#endif
+
 /* ======================================================================== */
 /* ============================== END OF FILE ============================= */
 /* ======================================================================== */
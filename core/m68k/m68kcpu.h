@@ -14,6 +14,9 @@
 #endif /* M68K_EMULATE_ADDRESS_ERROR */
 
 #include "m68k.h"
+#include "state.h"
+#include "snapshot.h"
+#include "profiler.h"
 
 
 /* ======================================================================== */
@@ -541,6 +544,23 @@
 #define m68ki_read_pcrel_16(A) m68k_read_pcrelative_16(A)
 #define m68ki_read_pcrel_32(A) m68k_read_pcrelative_32(A)
 
+/* Busy-wait loop skipping: memory writes & I/O reads limit skipped cycles */
+#if M68K_IDLE_SKIP
+#define m68ki_skip_write() m68ki_cpu.skip.horizon = 0;
+#else
+#define m68ki_skip_write()
+#define m68ki_read_io(handler, address) (*handler)(address)
+#endif
+
+/* Hotspot profiler: memory handler calls & interrupts are reported to profiler */
+#if M68K_PROFILE
+#define m68ki_profile_io(type, address, handler) {if (profiler_active) profiler_io(PROFILER_CPU, type, (address) & 0xffffff, (profiler_handler_t)(handler));}
+#define m68ki_profile_interrupt() {if (profiler_active) profiler_interrupt(PROFILER_CPU, REG_PC);}
+#else
+#define m68ki_profile_io(type, address, handler)
+#define m68ki_profile_interrupt()
+#endif
+
 
 /* ======================================================================== */
 /* =============================== PROTOTYPES ============================= */
@@ -677,6 +697,12 @@ INLINE void m68ki_write_8(uint address, uint value);
 INLINE void m68ki_write_16(uint address, uint value);
 INLINE void m68ki_write_32(uint address, uint value);
 
+#if M68K_IDLE_SKIP
+/* Busy-wait loop skipping */
+INLINE uint m68ki_read_io(uint (*handler)(uint address), uint address);
+INLINE void m68ki_idle_loop(void);
+#endif
+
 /* Indexed and PC-relative ea fetching */
 INLINE uint m68ki_get_ea_pcdi(void);
 INLINE uint m68ki_get_ea_pcix(void);
@@ -847,13 +873,36 @@ INLINE uint m68ki_read_imm_32(void)
  * These functions will also check for address error and set the function
  * code if they are enabled in m68kconf.h.
  */
+#if M68K_IDLE_SKIP
+/* I/O read handlers can set skip.io to the cycle count until which returned
+ * value cannot change, otherwise busy-wait loops reading them are not skipped.
+ */
+INLINE uint m68ki_read_io(uint (*handler)(uint address), uint address)
+{
+  uint value;
+
+  m68ki_cpu.skip.io = 0;
+  value = (*handler)(address);
+  if (m68ki_cpu.skip.io < m68ki_cpu.skip.horizon)
+  {
+    m68ki_cpu.skip.horizon = m68ki_cpu.skip.io;
+  }
+
+  return value;
+}
+#endif
+
 INLINE uint m68ki_read_8(uint address)
 {
   cpu_memory_map *temp = &m68ki_cpu.memory_map[((address)>>16)&0xff];;
 
   m68ki_set_fc(FLAG_S | m68ki_get_address_space()) /* auto-disable (see m68kcpu.h) */
 
-  if (temp->read8) return (*temp->read8)(ADDRESS_68K(address));
+  if (temp->read8)
+  {
+    m68ki_profile_io(PROFILER_READ8, address, temp->read8) /* auto-disable (see m68kcpu.h) */
+    return m68ki_read_io(temp->read8, ADDRESS_68K(address));
+  }
   else return READ_BYTE(temp->base, (address) & 0xffff);
 }
 
@@ -865,7 +914,11 @@ INLINE uint m68ki_read_16(uint address)
   m68ki_check_address_error(address, MODE_READ, FLAG_S | m68ki_get_address_space()) /* auto-disable (see m68kcpu.h) */
   
   temp = &m68ki_cpu.memory_map[((address)>>16)&0xff];
-  if (temp->read16) return (*temp->read16)(ADDRESS_68K(address));
+  if (temp->read16)
+  {
+    m68ki_profile_io(PROFILER_READ16, address, temp->read16) /* auto-disable (see m68kcpu.h) */
+    return m68ki_read_io(temp->read16, ADDRESS_68K(address));
+  }
   else return *(uint16 *)(temp->base + ((address) & 0xffff));
 }
 
@@ -877,7 +930,12 @@ INLINE uint m68ki_read_32(uint address)
   m68ki_check_address_error(address, MODE_READ, FLAG_S | m68ki_get_address_space()) /* auto-disable (see m68kcpu.h) */
 
   temp = &m68ki_cpu.memory_map[((address)>>16)&0xff];
-  if (temp->read16) return ((*temp->read16)(ADDRESS_68K(address)) << 16) | ((*temp->read16)(ADDRESS_68K(address + 2)));
+  if (temp->read16)
+  {
+    m68ki_profile_io(PROFILER_READ16, address, temp->read16) /* auto-disable (see m68kcpu.h) */
+    m68ki_profile_io(PROFILER_READ16, address + 2, temp->read16) /* auto-disable (see m68kcpu.h) */
+    return (m68ki_read_io(temp->read16, ADDRESS_68K(address)) << 16) | (m68ki_read_io(temp->read16, ADDRESS_68K(address + 2)));
+  }
   else return m68k_read_immediate_32(address);
 }
 
@@ -886,10 +944,19 @@ INLINE void m68ki_write_8(uint address, uint value)
   cpu_memory_map *temp;
 
   m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
+  m68ki_skip_write() /* auto-disable (see m68kcpu.h) */
 
   temp = &m68ki_cpu.memory_map[((address)>>16)&0xff];
-  if (temp->write8) (*temp->write8)(ADDRESS_68K(address),value);
-  else WRITE_BYTE(temp->base, (address) & 0xffff, value);
+  if (temp->write8)
+  {
+    m68ki_profile_io(PROFILER_WRITE8, address, temp->write8) /* auto-disable (see m68kcpu.h) */
+    (*temp->write8)(ADDRESS_68K(address),value);
+  }
+  else
+  {
+    WRITE_BYTE(temp->base, (address) & 0xffff, value);
+    MARK_STATE_DIRTY(temp->base + ((address) & 0xffff));
+  }
 }
 
 INLINE void m68ki_write_16(uint address, uint value)
@@ -898,10 +965,19 @@ INLINE void m68ki_write_16(uint address, uint value)
 
   m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
   m68ki_check_address_error(address, MODE_WRITE, FLAG_S | FUNCTION_CODE_USER_DATA); /* auto-disable (see m68kcpu.h) */
+  m68ki_skip_write() /* auto-disable (see m68kcpu.h) */
 
   temp = &m68ki_cpu.memory_map[((address)>>16)&0xff];
-  if (temp->write16) (*temp->write16)(ADDRESS_68K(address),value);
-  else *(uint16 *)(temp->base + ((address) & 0xffff)) = value;
+  if (temp->write16)
+  {
+    m68ki_profile_io(PROFILER_WRITE16, address, temp->write16) /* auto-disable (see m68kcpu.h) */
+    (*temp->write16)(ADDRESS_68K(address),value);
+  }
+  else
+  {
+    *(uint16 *)(temp->base + ((address) & 0xffff)) = value;
+    MARK_STATE_DIRTY(temp->base + ((address) & 0xffff));
+  }
 }
 
 INLINE void m68ki_write_32(uint address, uint value)
@@ -910,14 +986,31 @@ INLINE void m68ki_write_32(uint address, uint value)
 
   m68ki_set_fc(FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
   m68ki_check_address_error(address, MODE_WRITE, FLAG_S | FUNCTION_CODE_USER_DATA) /* auto-disable (see m68kcpu.h) */
+  m68ki_skip_write() /* auto-disable (see m68kcpu.h) */
 
   temp = &m68ki_cpu.memory_map[((address)>>16)&0xff];
-  if (temp->write16) (*temp->write16)(ADDRESS_68K(address),value>>16);
-  else *(uint16 *)(temp->base + ((address) & 0xffff)) = value >> 16;
+  if (temp->write16)
+  {
+    m68ki_profile_io(PROFILER_WRITE16, address, temp->write16) /* auto-disable (see m68kcpu.h) */
+    (*temp->write16)(ADDRESS_68K(address),value>>16);
+  }
+  else
+  {
+    *(uint16 *)(temp->base + ((address) & 0xffff)) = value >> 16;
+    MARK_STATE_DIRTY(temp->base + ((address) & 0xffff));
+  }
 
   temp = &m68ki_cpu.memory_map[((address + 2)>>16)&0xff];
-  if (temp->write16) (*temp->write16)(ADDRESS_68K(address+2),value&0xffff);
-  else *(uint16 *)(temp->base + ((address + 2) & 0xffff)) = value;
+  if (temp->write16)
+  {
+    m68ki_profile_io(PROFILER_WRITE16, address + 2, temp->write16) /* auto-disable (see m68kcpu.h) */
+    (*temp->write16)(ADDRESS_68K(address+2),value&0xffff);
+  }
+  else
+  {
+    *(uint16 *)(temp->base + ((address + 2) & 0xffff)) = value;
+    MARK_STATE_DIRTY(temp->base + ((address + 2) & 0xffff));
+  }
 }
 
 
@@ -1107,11 +1200,23 @@ INLINE void m68ki_jump_vector(uint vector)
 INLINE void m68ki_branch_8(uint offset)
 {
   REG_PC += MAKE_INT_8(offset);
+#if M68K_IDLE_SKIP
+  if (offset & 0x80)
+  {
+    m68ki_idle_loop();
+  }
+#endif
 }
 
 INLINE void m68ki_branch_16(uint offset)
 {
   REG_PC += MAKE_INT_16(offset);
+#if M68K_IDLE_SKIP
+  if (offset & 0x8000)
+  {
+    m68ki_idle_loop();
+  }
+#endif
 }
 
 INLINE void m68ki_branch_32(uint offset)
@@ -1119,6 +1224,86 @@ INLINE void m68ki_branch_32(uint offset)
   REG_PC += offset;
 }
 
+#if M68K_IDLE_SKIP
+/* Busy-wait loop skipping, called on backward branches.
+ * When a loop iteration ends with the same CPU registers as the previous one,
+ * without having written memory, next iterations would execute exactly the
+ * same way as long as I/O registers read by the loop do not change: their
+ * execution time is skipped, up to the last iteration completing before the
+ * end of the execution frame (so that interrupts and the following iterations
+ * are still processed at the same cycle count as without skipping).
+ */
+INLINE void m68ki_idle_loop(void)
+{
+  uint *regs = m68ki_cpu.skip.regs;
+  uint changed = !m68ki_cpu.skip.armed;
+
+  if ((REG_PC != m68ki_cpu.skip.pc) || !m68ki_cpu.skip.horizon)
+  {
+    /* new loop or memory written during last iteration */
+    m68ki_cpu.skip.pc = REG_PC;
+    m68ki_cpu.skip.armed = 0;
+  }
+  else
+  {
+    uint i;
+    uint flags[8];
+
+    flags[0] = FLAG_X;
+    flags[1] = FLAG_N;
+    flags[2] = FLAG_Z;
+    flags[3] = FLAG_V;
+    flags[4] = FLAG_C;
+    flags[5] = FLAG_INT_MASK;
+    flags[6] = FLAG_S;
+    flags[7] = CPU_INT_LEVEL;
+
+    /* compare CPU registers with previous iteration */
+    for (i=0; i<16; i++)
+    {
+      if (regs[i] != REG_DA[i])
+      {
+        regs[i] = REG_DA[i];
+        changed = 1;
+      }
+    }
+    for (i=0; i<8; i++)
+    {
+      if (regs[16 + i] != flags[i])
+      {
+        regs[16 + i] = flags[i];
+        changed = 1;
+      }
+    }
+
+    if (changed)
+    {
+      m68ki_cpu.skip.armed = 1;
+    }
+    else
+    {
+      /* idle loop: skip whole iterations ending before next event */
+      uint period = m68ki_cpu.cycles - m68ki_cpu.skip.cycle;
+      uint end = m68ki_cpu.cycle_end;
+      if (m68ki_cpu.skip.horizon < end)
+      {
+        end = m68ki_cpu.skip.horizon;
+      }
+
+      if ((m68ki_cpu.cycles < end) && ((end - m68ki_cpu.cycles) > (2 * period)))
+      {
+        uint cycles = (((end - m68ki_cpu.cycles - 1) / period) - 1) * period;
+        m68ki_cpu.cycles += cycles;
+        m68k_idle_cycles += cycles;
+      }
+    }
+  }
+
+  m68ki_cpu.skip.cycle = m68ki_cpu.cycles;
+  m68ki_cpu.skip.horizon = 0xffffffff;
+}
+#endif
+
 
 
 /* ---------------------------- Status Register --------------------------- */
@@ -1374,6 +1559,7 @@ INLINE void m68ki_exception_interrupt(uint int_level)
   m68ki_stack_frame_3word(REG_PC, sr);
 
   m68ki_jump(new_pc);
+  m68ki_profile_interrupt() /* auto-disable (see m68kcpu.h) */
 
   /* Update cycle count now */
   USE_CYCLES(CYC_EXCEPTION[vector]);
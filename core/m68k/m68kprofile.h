@@ -0,0 +1,60 @@
+/* ======================================================================== */
+/* =========================== HOTSPOT PROFILER =========================== */
+/* ======================================================================== */
+
+/* Optional instrumented execution loop (USE_PROFILER), shared by both 68k
+ * cores and used instead of the interpreter (or block cache) while hotspot
+ * profiler is running (see profiler.h).
+ *
+ * Cycles used by each instruction are reported with its address. Calls and
+ * returns are tracked from BSR, JSR, TRAP, RTS, RTR and RTE instructions, and
+ * from interrupts: code manipulating return addresses on the stack, or other
+ * exceptions, can leave profiled call stacks out of sync until the
+ * corresponding subroutines return.
+ */
+
+#if M68K_PROFILE
+
+/* Control flow of executed instruction */
+INLINE int m68ki_profile_flow(uint ir)
+{
+  /* BSR, JSR, TRAP */
+  if (((ir & 0xff00) == 0x6100) || ((ir & 0xffc0) == 0x4e80) || ((ir & 0xfff0) == 0x4e40))
+  {
+    return PROFILER_CALL;
+  }
+
+  /* RTE, RTS, RTR */
+  if ((ir == 0x4e73) || (ir == 0x4e75) || (ir == 0x4e77))
+  {
+    return PROFILER_RETURN;
+  }
+
+  return PROFILER_NEXT;
+}
+
+/* Execute instructions until given cycle count, reporting them to profiler */
+INLINE void m68ki_profile_run(uint cycles)
+{
+  /* interrupt taken before execution */
+  profiler_sync(PROFILER_CPU);
+
+  while (m68ki_cpu.cycles < cycles)
+  {
+    uint pc = REG_PC;
+    uint start = m68ki_cpu.cycles;
+
+    m68ki_trace_t1() /* auto-disable (see m68kcpu.h) */
+    m68ki_use_data_space() /* auto-disable (see m68kcpu.h) */
+
+    REG_IR = m68ki_read_imm_16();
+
+    m68ki_instruction_jump_table[REG_IR]();
+    USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+    m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
+
+    profiler_exec(PROFILER_CPU, pc & 0xffffff, m68ki_cpu.cycles - start, m68ki_profile_flow(REG_IR), REG_PC & 0xffffff);
+  }
+}
+
+#endif /* M68K_PROFILE */
@@ -72,6 +72,21 @@
  */
 #define M68K_CHECK_PC_ADDRESS_ERROR OPT_OFF
 
+/* If ON, loops polling unchanged memory or I/O registers are detected on
+ * backward branches and their remaining iterations are skipped up to the
+ * next event (SUB-CPU uses register polling detection instead, see scd.c).
+ */
+#define M68K_IDLE_SKIP              OPT_OFF
+
+/* If ON, instructions are executed through an instrumented loop while hotspot
+ * profiler is running (see profiler.h).
+ */
+#ifdef USE_PROFILER
+#define M68K_PROFILE                OPT_ON
+#else
+#define M68K_PROFILE                OPT_OFF
+#endif
+
 
 /* ----------------------------- COMPATIBILITY ---------------------------- */
 
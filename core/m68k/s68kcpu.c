@@ -6,6 +6,7 @@ extern int scd_68k_irq_ack(int level);
 
 #define m68ki_cpu s68k
 #define MUL (4)
+#define PROFILER_CPU PROFILER_S68K
 
 /* ======================================================================== */
 /* ================================ INCLUDES ============================== */
@@ -18,6 +19,8 @@ extern int scd_68k_irq_ack(int level);
 #include "s68kconf.h"
 #include "m68kcpu.h"
 #include "m68kops.h"
+#include "m68kblock.h"
+#include "m68kprofile.h"
 
 /* ======================================================================== */
 /* ================================= DATA ================================= */
@@ -26,7 +29,7 @@ extern int scd_68k_irq_ack(int level);
 #ifdef BUILD_TABLES
 static unsigned char s68ki_cycles[0x10000];
 #endif
-static int irq_latency;
+static THREAD_LOCAL int irq_latency;
 
 /* IRQ priority */
 static const uint8 irq_level[0x40] = 
@@ -41,7 +44,7 @@ static const uint8 irq_level[0x40] =
   6, 6, 6, 6, 6, 6, 6, 6
 };
 
-m68ki_cpu_core s68k;
+THREAD_LOCAL m68ki_cpu_core s68k;
 
 
 /* ======================================================================== */
@@ -201,7 +204,7 @@ void s68k_set_fc_callback(void  (*callback)(unsigned int new_fc))
 #endif
 
 extern void error(char *format, ...);
-extern uint16 v_counter;
+extern THREAD_LOCAL uint16 v_counter;
 
 /* update IRQ level according to triggered interrupts */
 void s68k_update_irq(unsigned int mask)
@@ -244,9 +247,27 @@ void s68k_run(unsigned int cycles)
 #ifdef LOG_SCD
   error("[%d][%d] s68k run to %d cycles (%x), irq mask = %x (%x)\n", v_counter, s68k.cycles, cycles, s68k.pc,FLAG_INT_MASK, CPU_INT_LEVEL);
 #endif
+
+#if M68K_PROFILE
+  if (profiler_active)
+  {
+    /* Execute instructions through instrumented loop */
+    m68ki_profile_run(cycles);
+    return;
+  }
+#endif
  
   while (s68k.cycles < cycles)
   {
+#ifdef USE_M68K_BLOCK_CACHE
+    if (m68ki_block_cache)
+    {
+      /* Execute next block of cached instructions */
+      m68ki_block_run(cycles);
+      continue;
+    }
+#endif
+
     /* Set tracing accodring to T1. */
     m68ki_trace_t1() /* auto-disable (see m68kcpu.h) */
 
@@ -300,6 +321,15 @@ void s68k_init(void)
 #if M68K_EMULATE_FC == OPT_ON
   s68k_set_fc_callback(NULL);
 #endif
+
+#ifdef USE_M68K_BLOCK_CACHE
+  /* allocate block cache (instructions are interpreted one by one otherwise) */
+  m68ki_block_cache_init();
+#endif
+
+  /* snapshot areas */
+  snapshot_var(s68k);
+  snapshot_var(irq_latency);
 }
 
 /* Pulse the RESET line on the CPU */
@@ -354,6 +384,15 @@ void s68k_clear_halt()
   CPU_STOPPED &= ~STOP_LEVEL_HALT;
 }
 
+#ifdef USE_M68K_BLOCK_CACHE
+void s68k_shutdown(void)
+{
+  /* Release block cache */
+  free(m68ki_block_cache);
+  m68ki_block_cache = NULL;
+}
+#endif
+
 /* ======================================================================== */
 /* ============================== END OF FILE ============================= */
 /* ======================================================================== */
@@ -53,6 +53,24 @@
 #define ALIGNED_(x) __attribute__ ((aligned(x)))
 #endif
 
+/* Storage class of emulated hardware state.
+ * When USE_MULTI_INSTANCE is defined, each host thread owns a separate copy of
+ * all emulated hardware state, allowing several independent emulator instances
+ * to run concurrently in the same process (one instance per thread).
+ * If you define THREAD_LOCAL in makefile or osd.h, it will override this value.
+ */
+#ifndef THREAD_LOCAL
+#ifdef USE_MULTI_INSTANCE
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+#else
+#define THREAD_LOCAL
+#endif
+#endif /* THREAD_LOCAL */
+
 /* Default CD image file access (read-only) functions */
 /* If you need to override default stdio.h functions with custom filesystem API,
    redefine following macros in platform specific include file (osd.h) or Makefile
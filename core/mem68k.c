@@ -207,6 +207,7 @@ void z80_write_byte(unsigned int address, unsigned int data)
     default: /* ZRAM */
     {
       zram[address & 0x1FFF] = data;
+      MARK_STATE_DIRTY(&zram[address & 0x1FFF]);
       m68k.cycles += 2 * 7; /* ZRAM access latency (fixes Pacman 2: New Adventures & Puyo Puyo 2) */
       return;
     }
@@ -339,6 +340,9 @@ unsigned int ctrl_io_read_byte(unsigned int address)
         /* register index ($A12000-A1203F mirrored up to $A120FF) */
         uint8 index = address & 0x3f;
 
+        /* SUB-CPU must catch up before shared registers are accessed (relaxed synchronization) */
+        scd_sync();
+
         /* Memory Mode */
         if (index == 0x03)
         {
@@ -487,6 +491,9 @@ unsigned int ctrl_io_read_word(unsigned int address)
         /* register index ($A12000-A1203F mirrored up to $A120FF) */
         uint8 index = address & 0x3f;
 
+        /* SUB-CPU must catch up before shared registers are accessed (relaxed synchronization) */
+        scd_sync();
+
         /* Memory Mode */
         if (index == 0x02)
         {
@@ -630,6 +637,9 @@ void ctrl_io_write_byte(unsigned int address, unsigned int data)
 #endif
       if (system_hw == SYSTEM_MCD)
       {
+        /* SUB-CPU must catch up before shared registers are accessed (relaxed synchronization) */
+        scd_sync();
+
         /* register index ($A12000-A1203F mirrored up to $A120FF) */
         switch (address & 0x3f)
         {
@@ -887,6 +897,9 @@ void ctrl_io_write_word(unsigned int address, unsigned int data)
 #endif
       if (system_hw == SYSTEM_MCD)
       {
+        /* SUB-CPU must catch up before shared registers are accessed (relaxed synchronization) */
+        scd_sync();
+
         /* register index ($A12000-A1203F mirrored up to $A120FF) */
         switch (address & 0x3e)
         {
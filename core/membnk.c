@@ -39,6 +39,8 @@
 
 #include "shared.h"
 
+THREAD_LOCAL struct _zbank_memory_map zbank_memory_map[256];
+
 /*
   Handlers for access to unused addresses and those which make the
   machine lock up.
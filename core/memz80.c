@@ -99,6 +99,10 @@ unsigned char z80_memory_r(unsigned int address)
     case 0: /* $0000-$3FFF: Z80 RAM (8K mirrored) */
     case 1:
     {
+#ifdef USE_IDLE_SKIP
+      /* Z80 RAM cannot be modified by 68k while Z80 is running */
+      z80_read_horizon = 0xFFFFFFFF;
+#endif
       return zram[address & 0x1FFF];
     }
 
@@ -123,6 +127,9 @@ unsigned char z80_memory_r(unsigned int address)
       {
         return (*zbank_memory_map[address >> 16].read)(address);
       }
+#ifdef USE_IDLE_SKIP
+      z80_read_horizon = 0xFFFFFFFF;
+#endif
       return READ_BYTE(m68k.memory_map[address >> 16].base, address & 0xFFFF);
     }
   }
@@ -137,6 +144,7 @@ void z80_memory_w(unsigned int address, unsigned char data)
     case 1: 
     {
       zram[address & 0x1FFF] = data;
+      MARK_STATE_DIRTY(&zram[address & 0x1FFF]);
       return;
     }
 
@@ -179,6 +187,7 @@ void z80_memory_w(unsigned int address, unsigned char data)
         return;
       }
       WRITE_BYTE(m68k.memory_map[address >> 16].base, address & 0xFFFF, data);
+      MARK_STATE_DIRTY(m68k.memory_map[address >> 16].base + (address & 0xFFFF));
       return;
     }
   }
@@ -0,0 +1,682 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Hotspot profiler
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+#ifdef USE_PROFILER
+
+/* maximal tracked call depth (deeper calls are accounted to deepest tracked subroutine) */
+#define PROFILER_DEPTH 24
+
+/* number of distinct call stacks & memory handler access sites (hash table sizes) */
+#define PROFILER_STACKS 0x8000
+#define PROFILER_SITES  0x1000
+
+typedef struct
+{
+  unsigned long long cycles;    /* cycles used by instruction */
+  uint32 count;                 /* number of executions */
+  uint32 io;                    /* number of executions calling memory handlers */
+} t_profiler_pc;
+
+typedef struct
+{
+  uint8 used;
+  uint8 cpu;
+  uint8 depth;                  /* number of tracked frames */
+  uint32 hash;
+  uint32 site;                  /* memory handler access site (index + 1, zero if none) */
+  uint32 frame[PROFILER_DEPTH]; /* subroutine entry addresses, from outermost */
+  unsigned long long cycles;
+} t_profiler_stack;
+
+typedef struct
+{
+  uint8 used;
+  uint8 cpu;
+  uint8 type;                   /* access type */
+  uint32 address;               /* accessed address (or I/O port) */
+  profiler_handler_t handler;
+  unsigned long long count;
+} t_profiler_site;
+
+typedef struct
+{
+  t_profiler_pc *bank[256];     /* instruction counters, per 64KB bank (allocated on first use) */
+  uint32 frame[PROFILER_DEPTH]; /* current call stack */
+  uint32 hash[PROFILER_DEPTH+1];/* call stack hash, per depth */
+  int depth;                    /* current call depth (can exceed tracked frames) */
+  t_profiler_stack *stack;      /* current call stack entry (NULL if not yet looked up) */
+  uint32 site;                  /* last memory handler access site of current instruction */
+  int irq;                      /* interrupt taken during current instruction */
+  uint32 irq_pc;                /* interrupt handler address */
+  unsigned long long cycles;    /* total used cycles */
+  unsigned long long count;     /* total executed instructions */
+} t_profiler_cpu;
+
+/* Profiler context */
+static THREAD_LOCAL struct
+{
+  t_profiler_cpu cpu[PROFILER_CPUS];
+  t_profiler_stack *stacks;     /* call stacks hash table */
+  int stack_count;
+  t_profiler_site *sites;       /* memory handler access sites hash table */
+  int site_count;
+  unsigned long long lost;      /* cycles not accounted to a call stack (hash table full) */
+} prof;
+
+THREAD_LOCAL int profiler_active;
+
+static const char *cpu_names[PROFILER_CPUS] = {"m68k", "s68k", "z80"};
+static const char *access_names[6] = {"read8", "read16", "write8", "write16", "in", "out"};
+
+/* names of memory handlers shared by all systems */
+static const struct
+{
+  profiler_handler_t handler;
+  const char *name;
+} handler_names[] =
+{
+  {(profiler_handler_t)m68k_read_bus_8,     "m68k_read_bus_8"},
+  {(profiler_handler_t)m68k_read_bus_16,    "m68k_read_bus_16"},
+  {(profiler_handler_t)m68k_unused_8_w,     "m68k_unused_8_w"},
+  {(profiler_handler_t)m68k_unused_16_w,    "m68k_unused_16_w"},
+  {(profiler_handler_t)m68k_lockup_r_8,     "m68k_lockup_r_8"},
+  {(profiler_handler_t)m68k_lockup_r_16,    "m68k_lockup_r_16"},
+  {(profiler_handler_t)m68k_lockup_w_8,     "m68k_lockup_w_8"},
+  {(profiler_handler_t)m68k_lockup_w_16,    "m68k_lockup_w_16"},
+  {(profiler_handler_t)z80_read_byte,       "z80_read_byte"},
+  {(profiler_handler_t)z80_read_word,       "z80_read_word"},
+  {(profiler_handler_t)z80_write_byte,      "z80_write_byte"},
+  {(profiler_handler_t)z80_write_word,      "z80_write_word"},
+  {(profiler_handler_t)ctrl_io_read_byte,   "ctrl_io_read_byte"},
+  {(profiler_handler_t)ctrl_io_read_word,   "ctrl_io_read_word"},
+  {(profiler_handler_t)ctrl_io_write_byte,  "ctrl_io_write_byte"},
+  {(profiler_handler_t)ctrl_io_write_word,  "ctrl_io_write_word"},
+  {(profiler_handler_t)vdp_read_byte,       "vdp_read_byte"},
+  {(profiler_handler_t)vdp_read_word,       "vdp_read_word"},
+  {(profiler_handler_t)vdp_write_byte,      "vdp_write_byte"},
+  {(profiler_handler_t)vdp_write_word,      "vdp_write_word"},
+  {(profiler_handler_t)pico_read_byte,      "pico_read_byte"},
+  {(profiler_handler_t)pico_read_word,      "pico_read_word"},
+  {(profiler_handler_t)z80_memory_r,        "z80_memory_r"},
+  {(profiler_handler_t)z80_memory_w,        "z80_memory_w"},
+  {(profiler_handler_t)z80_unused_port_r,   "z80_unused_port_r"},
+  {(profiler_handler_t)z80_unused_port_w,   "z80_unused_port_w"},
+  {(profiler_handler_t)z80_md_port_r,       "z80_md_port_r"},
+  {(profiler_handler_t)z80_md_port_w,       "z80_md_port_w"},
+  {(profiler_handler_t)z80_gg_port_r,       "z80_gg_port_r"},
+  {(profiler_handler_t)z80_gg_port_w,       "z80_gg_port_w"},
+  {(profiler_handler_t)z80_ms_port_r,       "z80_ms_port_r"},
+  {(profiler_handler_t)z80_ms_port_w,       "z80_ms_port_w"},
+  {(profiler_handler_t)z80_m3_port_r,       "z80_m3_port_r"},
+  {(profiler_handler_t)z80_m3_port_w,       "z80_m3_port_w"},
+  {(profiler_handler_t)z80_sg_port_r,       "z80_sg_port_r"},
+  {(profiler_handler_t)z80_sg_port_w,       "z80_sg_port_w"},
+  {(profiler_handler_t)zbank_unused_r,      "zbank_unused_r"},
+  {(profiler_handler_t)zbank_unused_w,      "zbank_unused_w"},
+  {(profiler_handler_t)zbank_lockup_r,      "zbank_lockup_r"},
+  {(profiler_handler_t)zbank_lockup_w,      "zbank_lockup_w"},
+  {(profiler_handler_t)zbank_read_ctrl_io,  "zbank_read_ctrl_io"},
+  {(profiler_handler_t)zbank_write_ctrl_io, "zbank_write_ctrl_io"},
+  {(profiler_handler_t)zbank_read_vdp,      "zbank_read_vdp"},
+  {(profiler_handler_t)zbank_write_vdp,     "zbank_write_vdp"},
+  {NULL, NULL}
+};
+
+static uint32 hash_value(uint32 hash, uint32 value)
+{
+  hash = (hash ^ value) * 0x9e3779b1;
+  return hash ^ (hash >> 15);
+}
+
+static const char *handler_name(profiler_handler_t handler)
+{
+  int i;
+  for (i=0; handler_names[i].name; i++)
+  {
+    if (handler_names[i].handler == handler)
+    {
+      return handler_names[i].name;
+    }
+  }
+
+  /* system specific handler */
+  return NULL;
+}
+
+static t_profiler_pc *find_pc(int cpu, unsigned int pc)
+{
+  t_profiler_cpu *c = &prof.cpu[cpu];
+  int bank = (pc >> 16) & 0xff;
+
+  /* 68k instructions are word aligned */
+  int shift = (cpu == PROFILER_Z80) ? 0 : 1;
+
+  if (!c->bank[bank])
+  {
+    c->bank[bank] = calloc(0x10000 >> shift, sizeof(t_profiler_pc));
+    if (!c->bank[bank])
+    {
+      return NULL;
+    }
+  }
+
+  return &c->bank[bank][(pc & 0xffff) >> shift];
+}
+
+static t_profiler_stack *find_stack(int cpu, uint32 site)
+{
+  t_profiler_cpu *c = &prof.cpu[cpu];
+  int depth = (c->depth < PROFILER_DEPTH) ? c->depth : PROFILER_DEPTH;
+  uint32 hash = hash_value(c->hash[depth], site);
+  int i = hash & (PROFILER_STACKS - 1);
+  t_profiler_stack *stack;
+
+  while (prof.stacks[i].used)
+  {
+    stack = &prof.stacks[i];
+    if ((stack->hash == hash) && (stack->cpu == cpu) && (stack->depth == depth) && (stack->site == site) &&
+        !memcmp(stack->frame, c->frame, depth * sizeof(uint32)))
+    {
+      return stack;
+    }
+    i = (i + 1) & (PROFILER_STACKS - 1);
+  }
+
+  /* hash table is kept at most 3/4 full */
+  if (prof.stack_count >= ((PROFILER_STACKS * 3) / 4))
+  {
+    return NULL;
+  }
+
+  stack = &prof.stacks[i];
+  stack->used = 1;
+  stack->cpu = cpu;
+  stack->depth = depth;
+  stack->hash = hash;
+  stack->site = site;
+  memcpy(stack->frame, c->frame, depth * sizeof(uint32));
+  stack->cycles = 0;
+  prof.stack_count++;
+  return stack;
+}
+
+static void push_frame(t_profiler_cpu *c, unsigned int pc)
+{
+  if (c->depth < PROFILER_DEPTH)
+  {
+    c->frame[c->depth] = pc;
+    c->hash[c->depth + 1] = hash_value(c->hash[c->depth], pc);
+  }
+
+  c->depth++;
+  c->stack = NULL;
+}
+
+static void pop_frame(t_profiler_cpu *c)
+{
+  /* ignore returns from subroutines called before profiler was started */
+  if (c->depth > 0)
+  {
+    c->depth--;
+    c->stack = NULL;
+  }
+}
+
+int profiler_start(void)
+{
+  /* profile is kept when profiler is restarted */
+  if (!prof.stacks)
+  {
+    prof.stacks = calloc(PROFILER_STACKS, sizeof(t_profiler_stack));
+    prof.sites = calloc(PROFILER_SITES, sizeof(t_profiler_site));
+    if (!prof.stacks || !prof.sites)
+    {
+      profiler_shutdown();
+      return 0;
+    }
+
+    profiler_reset();
+  }
+
+  profiler_active = 1;
+  return 1;
+}
+
+void profiler_stop(void)
+{
+  profiler_active = 0;
+}
+
+void profiler_reset(void)
+{
+  int i, j;
+
+  for (i=0; i<PROFILER_CPUS; i++)
+  {
+    t_profiler_cpu *c = &prof.cpu[i];
+
+    for (j=0; j<256; j++)
+    {
+      free(c->bank[j]);
+    }
+
+    memset(c, 0, sizeof(t_profiler_cpu));
+    c->hash[0] = hash_value(0, i + 1);
+  }
+
+  if (prof.stacks)
+  {
+    memset(prof.stacks, 0, PROFILER_STACKS * sizeof(t_profiler_stack));
+  }
+
+  if (prof.sites)
+  {
+    memset(prof.sites, 0, PROFILER_SITES * sizeof(t_profiler_site));
+  }
+
+  prof.stack_count = 0;
+  prof.site_count = 0;
+  prof.lost = 0;
+}
+
+void profiler_shutdown(void)
+{
+  profiler_active = 0;
+  profiler_reset();
+  free(prof.stacks);
+  free(prof.sites);
+  prof.stacks = NULL;
+  prof.sites = NULL;
+}
+
+void profiler_exec(int cpu, unsigned int pc, unsigned int cycles, int flow, unsigned int target)
+{
+  t_profiler_cpu *c = &prof.cpu[cpu];
+  t_profiler_pc *entry = find_pc(cpu, pc);
+  t_profiler_stack *stack;
+
+  if (entry)
+  {
+    entry->cycles += cycles;
+    entry->count++;
+    entry->io += (c->site != 0);
+  }
+
+  c->cycles += cycles;
+  c->count++;
+
+  /* instructions calling memory handlers are accounted to a distinct stack */
+  if (c->site)
+  {
+    stack = find_stack(cpu, c->site);
+    c->site = 0;
+  }
+  else
+  {
+    if (!c->stack)
+    {
+      c->stack = find_stack(cpu, 0);
+    }
+    stack = c->stack;
+  }
+
+  if (stack)
+  {
+    stack->cycles += cycles;
+  }
+  else
+  {
+    prof.lost += cycles;
+  }
+
+  if (flow == PROFILER_CALL)
+  {
+    push_frame(c, target);
+  }
+  else if (flow == PROFILER_RETURN)
+  {
+    pop_frame(c);
+  }
+
+  /* interrupt taken by executed instruction */
+  profiler_sync(cpu);
+}
+
+void profiler_interrupt(int cpu, unsigned int pc)
+{
+  /* interrupt frame is pushed once current instruction has been accounted */
+  prof.cpu[cpu].irq = 1;
+  prof.cpu[cpu].irq_pc = pc;
+}
+
+void profiler_sync(int cpu)
+{
+  t_profiler_cpu *c = &prof.cpu[cpu];
+
+  if (c->irq)
+  {
+    c->irq = 0;
+    push_frame(c, c->irq_pc);
+  }
+}
+
+void profiler_io(int cpu, int type, unsigned int address, profiler_handler_t handler)
+{
+  uint32 hash = hash_value(hash_value(cpu, type), address);
+  int i = hash & (PROFILER_SITES - 1);
+  t_profiler_site *site;
+
+  while (prof.sites[i].used)
+  {
+    site = &prof.sites[i];
+    if ((site->address == address) && (site->cpu == cpu) && (site->type == type))
+    {
+      site->count++;
+      prof.cpu[cpu].site = i + 1;
+      return;
+    }
+    i = (i + 1) & (PROFILER_SITES - 1);
+  }
+
+  /* hash table is kept at most 3/4 full */
+  if (prof.site_count >= ((PROFILER_SITES * 3) / 4))
+  {
+    return;
+  }
+
+  site = &prof.sites[i];
+  site->used = 1;
+  site->cpu = cpu;
+  site->type = type;
+  site->address = address;
+  site->handler = handler;
+  site->count = 1;
+  prof.site_count++;
+  prof.cpu[cpu].site = i + 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Profile export                                                            */
+/* ------------------------------------------------------------------------- */
+
+typedef struct
+{
+  int cpu;
+  unsigned int pc;
+  t_profiler_pc *entry;
+} t_profiler_hotspot;
+
+static int compare_hotspots(const void *a, const void *b)
+{
+  const t_profiler_hotspot *p = (const t_profiler_hotspot *)a;
+  const t_profiler_hotspot *q = (const t_profiler_hotspot *)b;
+
+  if (p->entry->cycles != q->entry->cycles)
+  {
+    return (p->entry->cycles < q->entry->cycles) ? 1 : -1;
+  }
+
+  if (p->cpu != q->cpu)
+  {
+    return p->cpu - q->cpu;
+  }
+
+  return (p->pc > q->pc) - (p->pc < q->pc);
+}
+
+static int compare_sites(const void *a, const void *b)
+{
+  const t_profiler_site *p = *(const t_profiler_site **)a;
+  const t_profiler_site *q = *(const t_profiler_site **)b;
+
+  if (p->count != q->count)
+  {
+    return (p->count < q->count) ? 1 : -1;
+  }
+
+  return (p->address > q->address) - (p->address < q->address);
+}
+
+static void print_address(FILE *fp, int cpu, unsigned int address)
+{
+  fprintf(fp, (cpu == PROFILER_Z80) ? "$%04x" : "$%06x", address);
+}
+
+static void print_site_address(FILE *fp, const t_profiler_site *site)
+{
+  if (site->type >= PROFILER_IN)
+  {
+    /* I/O port */
+    fprintf(fp, "$%02x    ", site->address);
+  }
+  else
+  {
+    print_address(fp, site->cpu, site->address);
+    fprintf(fp, (site->cpu == PROFILER_Z80) ? "  " : "");
+  }
+}
+
+static void print_site(FILE *fp, const t_profiler_site *site)
+{
+  const char *name = handler_name(site->handler);
+
+  /* handler name (or access type) followed by accessed address */
+  fprintf(fp, "%s[", name ? name : access_names[site->type]);
+  if (site->type >= PROFILER_IN)
+  {
+    fprintf(fp, "$%02x", site->address);
+  }
+  else
+  {
+    print_address(fp, site->cpu, site->address);
+  }
+  fprintf(fp, "]");
+}
+
+static int write_flat(const char *filename)
+{
+  FILE *fp;
+  t_profiler_hotspot *hotspots;
+  t_profiler_site **sites;
+  int i, j, k, count = 0;
+
+  /* collect executed instructions */
+  for (i=0; i<PROFILER_CPUS; i++)
+  {
+    int size = (i == PROFILER_Z80) ? 0x10000 : 0x8000;
+    for (j=0; j<256; j++)
+    {
+      if (prof.cpu[i].bank[j])
+      {
+        for (k=0; k<size; k++)
+        {
+          count += (prof.cpu[i].bank[j][k].count != 0);
+        }
+      }
+    }
+  }
+
+  hotspots = malloc((count + 1) * sizeof(t_profiler_hotspot));
+  sites = malloc((prof.site_count + 1) * sizeof(t_profiler_site *));
+  fp = fopen(filename, "w");
+  if (!hotspots || !sites || !fp)
+  {
+    free(hotspots);
+    free(sites);
+    if (fp) fclose(fp);
+    return 0;
+  }
+
+  count = 0;
+  for (i=0; i<PROFILER_CPUS; i++)
+  {
+    int shift = (i == PROFILER_Z80) ? 0 : 1;
+    for (j=0; j<256; j++)
+    {
+      if (prof.cpu[i].bank[j])
+      {
+        for (k=0; k<(0x10000 >> shift); k++)
+        {
+          if (prof.cpu[i].bank[j][k].count)
+          {
+            hotspots[count].cpu = i;
+            hotspots[count].pc = (j << 16) | (k << shift);
+            hotspots[count].entry = &prof.cpu[i].bank[j][k];
+            count++;
+          }
+        }
+      }
+    }
+  }
+
+  qsort(hotspots, count, sizeof(t_profiler_hotspot), compare_hotspots);
+
+  fprintf(fp, "Genesis Plus GX hotspot profile\n\n");
+  for (i=0; i<PROFILER_CPUS; i++)
+  {
+    if (prof.cpu[i].count)
+    {
+      fprintf(fp, "%-4s: %llu cycles, %llu instructions\n", cpu_names[i], prof.cpu[i].cycles, prof.cpu[i].count);
+    }
+  }
+
+  fprintf(fp, "\nInstructions:\n\n");
+  fprintf(fp, "cpu   address        cycles        %%      executed  handler calls\n");
+  for (i=0; i<count; i++)
+  {
+    t_profiler_pc *entry = hotspots[i].entry;
+    int cpu = hotspots[i].cpu;
+    fprintf(fp, "%-4s  ", cpu_names[cpu]);
+    print_address(fp, cpu, hotspots[i].pc);
+    fprintf(fp, (cpu == PROFILER_Z80) ? "    " : "  ");
+    fprintf(fp, " %14llu  %6.2f%%  %12u  %12u\n", entry->cycles, prof.cpu[cpu].cycles ? (entry->cycles * 100.0 / prof.cpu[cpu].cycles) : 0.0, entry->count, entry->io);
+  }
+
+  /* memory handler access sites */
+  count = 0;
+  for (i=0; i<PROFILER_SITES; i++)
+  {
+    if (prof.sites[i].used)
+    {
+      sites[count++] = &prof.sites[i];
+    }
+  }
+
+  qsort(sites, count, sizeof(t_profiler_site *), compare_sites);
+
+  fprintf(fp, "\nMemory handlers:\n\n");
+  fprintf(fp, "cpu   access   address              calls  handler\n");
+  for (i=0; i<count; i++)
+  {
+    const char *name = handler_name(sites[i]->handler);
+    int cpu = sites[i]->cpu;
+    fprintf(fp, "%-4s  %-7s  ", cpu_names[cpu], access_names[sites[i]->type]);
+    print_site_address(fp, sites[i]);
+    fprintf(fp, "   %14llu  %s\n", sites[i]->count, name ? name : "-");
+  }
+
+  free(hotspots);
+  free(sites);
+  fclose(fp);
+  return 1;
+}
+
+static int write_folded(const char *filename)
+{
+  int i, j;
+  FILE *fp = fopen(filename, "w");
+  if (!fp) return 0;
+
+  for (i=0; i<PROFILER_STACKS; i++)
+  {
+    t_profiler_stack *stack = &prof.stacks[i];
+
+    if (!stack->used || !stack->cycles)
+    {
+      continue;
+    }
+
+    fprintf(fp, "%s", cpu_names[stack->cpu]);
+
+    for (j=0; j<stack->depth; j++)
+    {
+      fprintf(fp, ";");
+      print_address(fp, stack->cpu, stack->frame[j]);
+    }
+
+    if (stack->site)
+    {
+      fprintf(fp, ";");
+      print_site(fp, &prof.sites[stack->site - 1]);
+    }
+
+    fprintf(fp, " %llu\n", stack->cycles);
+  }
+
+  if (prof.lost)
+  {
+    fprintf(fp, "[untracked] %llu\n", prof.lost);
+  }
+
+  fclose(fp);
+  return 1;
+}
+
+int profiler_write(const char *flat, const char *folded)
+{
+  if (!prof.stacks || !prof.sites)
+  {
+    return 0;
+  }
+
+  if (flat && !write_flat(flat))
+  {
+    return 0;
+  }
+
+  if (folded && !write_folded(folded))
+  {
+    return 0;
+  }
+
+  return 1;
+}
+
+#endif /* USE_PROFILER */
@@ -0,0 +1,97 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Hotspot profiler
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#ifdef USE_PROFILER
+
+/* While profiler is running, CPU cores execute instructions through instrumented loops  */
+/* which accumulate used cycles per instruction address and per call stack. Call stacks  */
+/* hold subroutine entry addresses, tracked from call & return instructions and from     */
+/* interrupts, and memory handler calls (counted per accessed address) add a last frame  */
+/* to the stack of the instruction that triggered them.                                  */
+/*                                                                                       */
+/* Results are exported as a flat profile (hottest instructions & memory handlers) and   */
+/* as folded stacks ("cpu;frame;frame... cycles" lines, as used by flame graph tools).   */
+/* Cycles are counted in master clock cycles of each CPU (see system.h & scd.h).         */
+/*                                                                                       */
+/* Hooks are only compiled in CPU cores with USE_PROFILER and, while profiler is not     */
+/* running, only cost one test per CPU execution call and per memory handler call.       */
+
+/* Profiled CPUs */
+#define PROFILER_M68K 0
+#define PROFILER_S68K 1
+#define PROFILER_Z80  2
+#define PROFILER_CPUS 3
+
+/* Memory handler accesses */
+#define PROFILER_READ8   0
+#define PROFILER_READ16  1
+#define PROFILER_WRITE8  2
+#define PROFILER_WRITE16 3
+#define PROFILER_IN      4
+#define PROFILER_OUT     5
+
+/* Control flow of executed instructions */
+#define PROFILER_NEXT   0
+#define PROFILER_CALL   1
+#define PROFILER_RETURN 2
+
+/* Memory handler (only used to report handler names) */
+typedef void (*profiler_handler_t)(void);
+
+/* Global variables */
+extern THREAD_LOCAL int profiler_active;
+
+/* Function prototypes */
+extern int profiler_start(void);
+extern void profiler_stop(void);
+extern void profiler_reset(void);
+extern void profiler_shutdown(void);
+extern int profiler_write(const char *flat, const char *folded);
+
+/* CPU cores hooks */
+extern void profiler_exec(int cpu, unsigned int pc, unsigned int cycles, int flow, unsigned int target);
+extern void profiler_interrupt(int cpu, unsigned int pc);
+extern void profiler_sync(int cpu);
+extern void profiler_io(int cpu, int type, unsigned int address, profiler_handler_t handler);
+
+#endif /* USE_PROFILER */
+
+#endif /* _PROFILER_H_ */
@@ -0,0 +1,354 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Rewind buffer
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+/* maximal number of frames kept in rewind buffer */
+#define REWIND_MAX_FRAMES 0x10000
+
+/* minimal length of unmodified data being excluded from patches */
+#define REWIND_MIN_RUN 4
+
+typedef struct
+{
+  int pos;                /* patch position in rewind buffer */
+  int size;               /* patch size */
+} t_rewind_frame;
+
+/* Rewind buffer context */
+static THREAD_LOCAL struct
+{
+  uint8 *buffer;          /* patches ring buffer */
+  int capacity;           /* ring buffer size */
+  int write;              /* end of most recent patch in ring buffer */
+  t_rewind_frame *frame;  /* stored patches, from oldest to most recent */
+  int first;              /* oldest patch index */
+  int count;              /* number of stored patches */
+  uint8 *head;            /* most recent state */
+  int size;               /* most recent state size (zero if no state was saved yet) */
+  uint8 *delta;           /* delta savestate buffer */
+  uint8 *patch;           /* patch encoding buffer */
+} rw;
+
+static uint8 *write_varint(uint8 *ptr, uint32 value)
+{
+  while (value >= 0x80)
+  {
+    *ptr++ = value | 0x80;
+    value >>= 7;
+  }
+  *ptr++ = value;
+  return ptr;
+}
+
+static uint8 *read_varint(uint8 *ptr, uint32 *value)
+{
+  int shift = 0;
+  *value = 0;
+  do
+  {
+    *value |= (*ptr & 0x7f) << shift;
+    shift += 7;
+  }
+  while (*ptr++ & 0x80);
+  return ptr;
+}
+
+/* Patch format:                                                                  */
+/*  (offset, length) varint pairs, each one followed by XOR data encoded as        */
+/*  (unmodified bytes count, modified bytes count) varint pairs, the latter being  */
+/*  followed by modified bytes XORed with previous state, terminated by a          */
+/*  zero-length record.                                                            */
+static uint8 *rewind_encode(uint8 *patch, uint8 *data, uint32 offset, uint32 length)
+{
+  uint8 *head = rw.head + offset;
+  uint8 *start = patch;
+  uint32 i = 0;
+
+  patch = write_varint(patch, offset);
+  patch = write_varint(patch, length);
+
+  while (i < length)
+  {
+    uint32 skip = i;
+    uint32 end, run = 0;
+
+    /* unmodified bytes */
+    while ((skip < length) && (data[skip] == head[skip]))
+    {
+      skip++;
+    }
+
+    /* nothing modified within this record */
+    if ((i == 0) && (skip == length))
+    {
+      return start;
+    }
+
+    /* modified bytes, up to next run of unmodified bytes */
+    for (end = skip; end < length; end++)
+    {
+      if (data[end] != head[end])
+      {
+        run = 0;
+      }
+      else if (++run == REWIND_MIN_RUN)
+      {
+        end -= (REWIND_MIN_RUN - 1);
+        break;
+      }
+    }
+
+    patch = write_varint(patch, skip - i);
+    patch = write_varint(patch, end - skip);
+    for (i = skip; i < end; i++)
+    {
+      *patch++ = data[i] ^ head[i];
+      head[i] = data[i];
+    }
+  }
+
+  return patch;
+}
+
+static void rewind_drop(void)
+{
+  rw.first = (rw.first + 1) % REWIND_MAX_FRAMES;
+  rw.count--;
+}
+
+static void rewind_store(int size)
+{
+  t_rewind_frame *frame;
+
+  /* patch can not be stored, history is lost */
+  if (size > rw.capacity)
+  {
+    rw.count = 0;
+    rw.write = 0;
+    return;
+  }
+
+  if (rw.count == REWIND_MAX_FRAMES)
+  {
+    rewind_drop();
+  }
+
+  /* wrap to start of ring buffer, dropping oldest patches stored at the end */
+  if ((rw.write + size) > rw.capacity)
+  {
+    while (rw.count && (rw.frame[rw.first].pos >= rw.write))
+    {
+      rewind_drop();
+    }
+    rw.write = 0;
+  }
+
+  /* drop oldest patches overwritten by new patch */
+  while (rw.count && (rw.frame[rw.first].pos < (rw.write + size)) &&
+         ((rw.frame[rw.first].pos + rw.frame[rw.first].size) > rw.write))
+  {
+    rewind_drop();
+  }
+
+  frame = &rw.frame[(rw.first + rw.count) % REWIND_MAX_FRAMES];
+  frame->pos = rw.write;
+  frame->size = size;
+  memcpy(rw.buffer + rw.write, rw.patch, size);
+  rw.write += size;
+  rw.count++;
+}
+
+int rewind_init(int budget)
+{
+  rewind_shutdown();
+
+  rw.buffer = malloc(budget);
+  rw.frame = malloc(REWIND_MAX_FRAMES * sizeof(t_rewind_frame));
+  rw.head = malloc(STATE_SIZE);
+  rw.delta = malloc(STATE_DELTA_SIZE);
+  rw.patch = malloc(STATE_DELTA_SIZE * 2);
+  if (!rw.buffer || !rw.frame || !rw.head || !rw.delta || !rw.patch)
+  {
+    rewind_shutdown();
+    return 0;
+  }
+
+  rw.capacity = budget;
+
+  /* first saved state will be a full state */
+  state_delta_reset();
+  return 1;
+}
+
+void rewind_shutdown(void)
+{
+  free(rw.buffer);
+  free(rw.frame);
+  free(rw.head);
+  free(rw.delta);
+  free(rw.patch);
+  memset(&rw, 0, sizeof(rw));
+}
+
+int rewind_push(void)
+{
+  uint8 *ptr, *patch;
+  uint32 size, full, offset, length;
+
+  if (!rw.buffer)
+  {
+    return 0;
+  }
+
+  if (!state_save_delta(rw.delta))
+  {
+    return 0;
+  }
+
+  memcpy(&size, rw.delta + 4, 4);
+  memcpy(&full, rw.delta + 8, 4);
+
+  /* state layout changed (or first saved state): history is restarted from full state */
+  if (size != rw.size)
+  {
+    if (!full)
+    {
+      state_delta_reset();
+      if (!state_save_delta(rw.delta))
+      {
+        return 0;
+      }
+    }
+
+    memcpy(rw.head, rw.delta + 20, size);
+    rw.size = size;
+    rw.count = 0;
+    rw.write = 0;
+    return 1;
+  }
+
+  /* encode modified areas as XOR patch, updating most recent state */
+  ptr = rw.delta + 12;
+  patch = rw.patch;
+  memcpy(&offset, ptr, 4);
+  memcpy(&length, ptr + 4, 4);
+  while (length)
+  {
+    patch = rewind_encode(patch, ptr + 8, offset, length);
+    ptr += (8 + length);
+    memcpy(&offset, ptr, 4);
+    memcpy(&length, ptr + 4, 4);
+  }
+  patch = write_varint(patch, 0);
+  patch = write_varint(patch, 0);
+
+  rewind_store(patch - rw.patch);
+  return 1;
+}
+
+int rewind_step(void)
+{
+  t_rewind_frame *frame;
+  uint8 *patch, *ptr;
+  uint32 full, offset, length, i, skip, count;
+
+  if (!rw.count)
+  {
+    return 0;
+  }
+
+  /* most recent patch */
+  frame = &rw.frame[(rw.first + rw.count - 1) % REWIND_MAX_FRAMES];
+  patch = rw.buffer + frame->pos;
+
+  /* restore previous state, updated areas being copied to a delta savestate */
+  ptr = rw.delta + 12;
+  patch = read_varint(patch, &offset);
+  patch = read_varint(patch, &length);
+  while (length)
+  {
+    for (i = 0; i < length; )
+    {
+      patch = read_varint(patch, &skip);
+      patch = read_varint(patch, &count);
+      for (i += skip; count--; i++)
+      {
+        rw.head[offset + i] ^= *patch++;
+      }
+    }
+
+    memcpy(ptr, &offset, 4);
+    memcpy(ptr + 4, &length, 4);
+    memcpy(ptr + 8, rw.head + offset, length);
+    ptr += (8 + length);
+
+    patch = read_varint(patch, &offset);
+    patch = read_varint(patch, &length);
+  }
+
+  /* patch space is reclaimed */
+  rw.write = frame->pos;
+  rw.count--;
+
+  memset(ptr, 0, 8);
+  memcpy(rw.delta, "DLT!", 4);
+  memcpy(rw.delta + 4, &rw.size, 4);
+  memset(rw.delta + 8, 0, 4);
+
+  /* partial delta can not be applied if delta savestates image is out of sync (state loaded since last saved state) */
+  if (state_load_delta(rw.delta))
+  {
+    return 1;
+  }
+
+  /* fallback to full state */
+  full = 1;
+  offset = 0;
+  memcpy(rw.delta + 8, &full, 4);
+  memcpy(rw.delta + 12, &offset, 4);
+  memcpy(rw.delta + 16, &rw.size, 4);
+  memcpy(rw.delta + 20, rw.head, rw.size);
+  memset(rw.delta + 20 + rw.size, 0, 8);
+  return state_load_delta(rw.delta) ? 1 : 0;
+}
+
+int rewind_count(void)
+{
+  return rw.count;
+}
@@ -9,6 +9,7 @@
 #include "types.h"
 #include "osd.h"
 #include "macros.h"
+#include "timing.h"
 #include "loadrom.h"
 #include "m68k.h"
 #include "z80.h"
@@ -16,12 +17,15 @@
 #include "genesis.h"
 #include "vdp_ctrl.h"
 #include "vdp_render.h"
+#include "vdp_blit.h"
+#include "vdp_thread.h"
 #include "mem68k.h"
 #include "memz80.h"
 #include "membnk.h"
 #include "io_ctrl.h"
 #include "input.h"
 #include "sound.h"
+#include "audio_stream.h"
 #include "psg.h"
 #include "ym2413.h"
 #include "ym2612.h"
@@ -33,6 +37,10 @@
 #include "areplay.h"
 #include "svp.h"
 #include "state.h"
+#include "context.h"
+#include "rewind.h"
+#include "snapshot.h"
+#include "profiler.h"
 
 #endif /* _SHARED_H_ */
 
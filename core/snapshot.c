@@ -0,0 +1,236 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Fast in-memory snapshots
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+#define SNAPSHOT_MAX_AREAS 256
+#define SNAPSHOT_MAX_EXTERNAL 8
+
+/* CD drive state is restored through its savestate handler which also seeks CD image files */
+#define SNAPSHOT_CDD_SIZE 0x40
+
+/* Hardware state areas registered by each module */
+static THREAD_LOCAL struct
+{
+  int count;
+  uint8 *data[SNAPSHOT_MAX_AREAS];
+  int size[SNAPSHOT_MAX_AREAS];
+} areas;
+
+void snapshot_register(void *data, int size)
+{
+  int i;
+
+  /* modules are registered again each time they are initialized */
+  for (i=0; i<areas.count; i++)
+  {
+    if (areas.data[i] == data)
+    {
+      areas.size[i] = size;
+      return;
+    }
+  }
+
+  if (areas.count < SNAPSHOT_MAX_AREAS)
+  {
+    areas.data[areas.count] = data;
+    areas.size[areas.count++] = size;
+  }
+}
+
+/* external hardware state areas (depending on loaded game) */
+/* as with savestates, cartridge backup memory is not included */
+static int snapshot_external(uint8 **data, int *size)
+{
+  int count = 0;
+
+  if (system_hw == SYSTEM_MCD)
+  {
+    /* PRG-RAM, Word-RAM, Backup RAM, ASIC registers & graphics processor (excluding look-up tables) */
+    data[count] = scd.prg_ram;
+    size[count++] = (uint8 *)scd.gfx_hw.lut_offset - scd.prg_ram;
+
+    /* CD data controller */
+    data[count] = (uint8 *)&scd.cdc_hw;
+    size[count++] = sizeof(scd.cdc_hw);
+
+    /* PCM chip */
+    data[count] = (uint8 *)&scd.pcm_hw;
+    size[count++] = sizeof(scd.pcm_hw);
+  }
+  else if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  {
+    /* cartridge hardware */
+    data[count] = (uint8 *)&cart.hw;
+    size[count++] = sizeof(cart.hw);
+
+    /* SVP */
+    if (svp)
+    {
+      data[count] = svp->iram_rom;
+      size[count++] = 0x800;
+      data[count] = svp->dram;
+      size[count++] = sizeof(svp->dram);
+      data[count] = (uint8 *)&svp->ssp1601;
+      size[count++] = sizeof(svp->ssp1601);
+    }
+  }
+
+  return count;
+}
+
+/* Snapshot format (host-dependent):                                      */
+/*  snapshot size (4 bytes) + areas count (4 bytes) + hardware type       */
+/*  (4 bytes), followed by VRAM, external hardware areas, registered      */
+/*  areas and CD drive state (Mega CD only).                               */
+int snapshot_size(void)
+{
+  uint8 *data[SNAPSHOT_MAX_EXTERNAL];
+  int size[SNAPSHOT_MAX_EXTERNAL];
+  int i, count, total = 12 + sizeof(vram);
+
+  count = snapshot_external(data, size);
+  for (i=0; i<count; i++)
+  {
+    total += size[i];
+  }
+
+  for (i=0; i<areas.count; i++)
+  {
+    total += areas.size[i];
+  }
+
+  if (system_hw == SYSTEM_MCD)
+  {
+    total += SNAPSHOT_CDD_SIZE;
+  }
+
+  return total;
+}
+
+int snapshot_save(unsigned char *arena)
+{
+  uint8 *data[SNAPSHOT_MAX_EXTERNAL];
+  int size[SNAPSHOT_MAX_EXTERNAL];
+  uint32 header[3];
+  int i, count, bufferptr = 12;
+
+  memcpy(&arena[bufferptr], vram, sizeof(vram));
+  bufferptr += sizeof(vram);
+
+  count = snapshot_external(data, size);
+  for (i=0; i<count; i++)
+  {
+    memcpy(&arena[bufferptr], data[i], size[i]);
+    bufferptr += size[i];
+  }
+
+  for (i=0; i<areas.count; i++)
+  {
+    memcpy(&arena[bufferptr], areas.data[i], areas.size[i]);
+    bufferptr += areas.size[i];
+  }
+
+  if (system_hw == SYSTEM_MCD)
+  {
+    memset(&arena[bufferptr], 0, SNAPSHOT_CDD_SIZE);
+    cdd_context_save(&arena[bufferptr]);
+    bufferptr += SNAPSHOT_CDD_SIZE;
+  }
+
+  header[0] = bufferptr;
+  header[1] = areas.count;
+  header[2] = system_hw;
+  memcpy(arena, header, 12);
+
+  return bufferptr;
+}
+
+int snapshot_load(unsigned char *arena)
+{
+  uint8 *data[SNAPSHOT_MAX_EXTERNAL];
+  int size[SNAPSHOT_MAX_EXTERNAL];
+  uint32 header[3];
+  int i, count, bufferptr = 12;
+
+  /* snapshot layout must match current hardware */
+  memcpy(header, arena, 12);
+  if ((header[0] != (uint32)snapshot_size()) || (header[1] != (uint32)areas.count) || (header[2] != system_hw))
+  {
+    return 0;
+  }
+
+  /* VRAM is restored by pattern, modified patterns being invalidated in pattern cache */
+  for (i=0; i<0x800; i++)
+  {
+    if (memcmp(&vram[i << 5], &arena[bufferptr + (i << 5)], 32))
+    {
+      memcpy(&vram[i << 5], &arena[bufferptr + (i << 5)], 32);
+      if (bg_name_dirty[i] == 0)
+      {
+        bg_name_list[bg_list_index++] = i;
+      }
+      bg_name_dirty[i] = 0xFF;
+    }
+  }
+  bufferptr += sizeof(vram);
+
+  count = snapshot_external(data, size);
+  for (i=0; i<count; i++)
+  {
+    memcpy(data[i], &arena[bufferptr], size[i]);
+    bufferptr += size[i];
+  }
+
+  for (i=0; i<areas.count; i++)
+  {
+    memcpy(areas.data[i], &arena[bufferptr], areas.size[i]);
+    bufferptr += areas.size[i];
+  }
+
+  if (system_hw == SYSTEM_MCD)
+  {
+    cdd_context_load(&arena[bufferptr]);
+    bufferptr += SNAPSHOT_CDD_SIZE;
+  }
+
+  /* emulated hardware state is no longer in sync with delta savestates */
+  state_delta_reset();
+
+  return bufferptr;
+}
@@ -0,0 +1,60 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Fast in-memory snapshots
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+/* Snapshots are raw copies of emulated hardware state, saved to (and restored from) a       */
+/* contiguous memory arena without any reset or memory map reconstruction, so that a few     */
+/* frames can be restored and emulated again within a single frame (rollback netplay).      */
+/*                                                                                          */
+/* Snapshots hold host pointers and are only valid for the instance that saved them, as     */
+/* long as the loaded game and hardware configuration are not modified. They should be      */
+/* saved and restored between frames.                                                       */
+
+/* Hardware state is registered by each module when initialized */
+#define snapshot_var(var) \
+  snapshot_register(&(var), sizeof(var))
+
+/* Function prototypes */
+extern void snapshot_register(void *data, int size);
+extern int snapshot_size(void);
+extern int snapshot_save(unsigned char *arena);
+extern int snapshot_load(unsigned char *arena);
+
+#endif /* _SNAPSHOT_H_ */
@@ -0,0 +1,318 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Native-rate sound chip output streams
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+/* maximal number of native samples per frame (Nuked OPN2 core outputs about 25500 samples per PAL frame) */
+#define AUDIO_STREAM_PENDING (1 << 15)
+
+typedef struct
+{
+  int16 *buffer;          /* ring buffer (interleaved stereo samples) */
+  unsigned int size;      /* ring buffer size, in stereo samples (power of two) */
+  unsigned int head;      /* number of samples written to ring buffer (modulo 2^32) */
+  unsigned int tail;      /* number of samples read from ring buffer (modulo 2^32) */
+  int *pending;           /* output variations of samples not yet integrated (stereo) */
+  unsigned int used;      /* number of pending samples with output variations */
+  unsigned int offset;    /* time units elapsed since first pending sample, at start of frame */
+  unsigned int ratio;     /* time units per native sample */
+  double clock;           /* time units per second */
+  int out[2];             /* last integrated output */
+} t_audio_stream;
+
+static THREAD_LOCAL t_audio_stream streams[AUDIO_STREAM_COUNT];
+
+THREAD_LOCAL unsigned int audio_stream_mask;
+THREAD_LOCAL int audio_stream_only;
+
+int audio_stream_enable(int id, int size)
+{
+  t_audio_stream *s;
+  unsigned int length = 1;
+
+  if ((id < 0) || (id >= AUDIO_STREAM_COUNT))
+  {
+    return 0;
+  }
+
+  s = &streams[id];
+
+  /* release previous buffers */
+  audio_stream_mask &= ~(1 << id);
+  free(s->buffer);
+  free(s->pending);
+  s->buffer = NULL;
+  s->pending = NULL;
+
+  if (size <= 0)
+  {
+    return 1;
+  }
+
+  /* ring buffer size is rounded up to a power of two */
+  while (length < (unsigned int)size)
+  {
+    length <<= 1;
+  }
+
+  s->buffer = (int16 *)malloc(length * 2 * sizeof(int16));
+  s->pending = (int *)calloc(AUDIO_STREAM_PENDING * 2, sizeof(int));
+  if (!s->buffer || !s->pending)
+  {
+    free(s->buffer);
+    free(s->pending);
+    s->buffer = NULL;
+    s->pending = NULL;
+    return 0;
+  }
+
+  s->size = length;
+  s->head = s->tail = 0;
+  s->used = 0;
+  s->offset = 0;
+  s->out[0] = s->out[1] = 0;
+  if (!s->ratio)
+  {
+    s->ratio = 1;
+  }
+
+  audio_stream_mask |= (1 << id);
+  return 1;
+}
+
+void audio_stream_exclusive(int enable)
+{
+  audio_stream_only = enable;
+}
+
+double audio_stream_rate(int id)
+{
+  if ((id < 0) || (id >= AUDIO_STREAM_COUNT) || !streams[id].ratio)
+  {
+    return 0.0;
+  }
+
+  return streams[id].clock / streams[id].ratio;
+}
+
+int audio_stream_read(int id, const int16 **samples)
+{
+  t_audio_stream *s;
+  unsigned int avail, pos;
+
+  *samples = NULL;
+
+  if ((id < 0) || (id >= AUDIO_STREAM_COUNT) || !(audio_stream_mask & (1 << id)))
+  {
+    return 0;
+  }
+
+  s = &streams[id];
+  avail = s->head - s->tail;
+  pos = s->tail & (s->size - 1);
+
+  /* only return samples located before the end of ring buffer */
+  if (avail > (s->size - pos))
+  {
+    avail = s->size - pos;
+  }
+
+  *samples = &s->buffer[pos << 1];
+  return avail;
+}
+
+void audio_stream_skip(int id, int samples)
+{
+  t_audio_stream *s;
+
+  if ((id < 0) || (id >= AUDIO_STREAM_COUNT) || (samples <= 0))
+  {
+    return;
+  }
+
+  s = &streams[id];
+  if ((unsigned int)samples > (s->head - s->tail))
+  {
+    samples = s->head - s->tail;
+  }
+
+  s->tail += samples;
+}
+
+void audio_stream_shutdown(void)
+{
+  int i;
+
+  for (i=0; i<AUDIO_STREAM_COUNT; i++)
+  {
+    audio_stream_enable(i, 0);
+    memset(&streams[i], 0, sizeof(t_audio_stream));
+  }
+
+  audio_stream_only = 0;
+}
+
+void audio_stream_set_clock(int id, double clock)
+{
+  streams[id].clock = clock;
+}
+
+void audio_stream_set_ratio(int id, unsigned int ratio)
+{
+  streams[id].ratio = ratio ? ratio : 1;
+}
+
+void audio_stream_reset(void)
+{
+  int i;
+
+  for (i=0; i<AUDIO_STREAM_COUNT; i++)
+  {
+    t_audio_stream *s = &streams[i];
+
+    if (s->pending)
+    {
+      memset(s->pending, 0, AUDIO_STREAM_PENDING * 2 * sizeof(int));
+      s->head = s->tail = 0;
+      s->used = 0;
+      s->offset = 0;
+      s->out[0] = s->out[1] = 0;
+    }
+  }
+}
+
+void audio_stream_delta(int id, unsigned int time, int delta_l, int delta_r)
+{
+  t_audio_stream *s = &streams[id];
+  unsigned int index = (time + s->offset) / s->ratio;
+
+  /* variations beyond pending samples are delayed, so that output remains consistent */
+  if (index >= AUDIO_STREAM_PENDING)
+  {
+    index = AUDIO_STREAM_PENDING - 1;
+  }
+
+  s->pending[index << 1] += delta_l;
+  s->pending[(index << 1) + 1] += delta_r;
+
+  if (index >= s->used)
+  {
+    s->used = index + 1;
+  }
+}
+
+void audio_stream_deltas(int id, unsigned int time, unsigned int step, const int *deltas, int count)
+{
+  t_audio_stream *s = &streams[id];
+  unsigned int index = 0;
+
+  time += s->offset;
+
+  while (count-- > 0)
+  {
+    index = time / s->ratio;
+    if (index >= AUDIO_STREAM_PENDING)
+    {
+      index = AUDIO_STREAM_PENDING - 1;
+    }
+
+    s->pending[index << 1] += deltas[0];
+    s->pending[(index << 1) + 1] += deltas[1];
+    time += step;
+    deltas += 2;
+  }
+
+  /* variations are added in chronological order */
+  if (index >= s->used)
+  {
+    s->used = index + 1;
+  }
+}
+
+void audio_stream_end(int id, unsigned int time)
+{
+  t_audio_stream *s = &streams[id];
+  unsigned int count = (time + s->offset) / s->ratio;
+  unsigned int mask = s->size - 1;
+  unsigned int i, rest;
+  int *in = s->pending;
+  int l = s->out[0];
+  int r = s->out[1];
+
+  /* integrate output variations of completed samples into ring buffer */
+  for (i=0; i<count; i++)
+  {
+    int16 *out = &s->buffer[((s->head + i) & mask) << 1];
+
+    if (i < s->used)
+    {
+      l += in[i << 1];
+      r += in[(i << 1) + 1];
+    }
+
+    /* clipping (16-bit samples) */
+    out[0] = (l > 32767) ? 32767 : ((l < -32768) ? -32768 : l);
+    out[1] = (r > 32767) ? 32767 : ((r < -32768) ? -32768 : r);
+  }
+
+  s->out[0] = l;
+  s->out[1] = r;
+  s->head += count;
+  s->offset = time + s->offset - (count * s->ratio);
+
+  /* oldest samples are overwritten if not read */
+  if ((s->head - s->tail) > s->size)
+  {
+    s->tail = s->head - s->size;
+  }
+
+  /* move output variations of next frame samples to start of pending buffer */
+  if (s->used > count)
+  {
+    rest = s->used - count;
+    memmove(in, in + (count << 1), rest * 2 * sizeof(int));
+    memset(in + (rest << 1), 0, count * 2 * sizeof(int));
+  }
+  else
+  {
+    rest = 0;
+    memset(in, 0, s->used * 2 * sizeof(int));
+  }
+
+  s->used = rest;
+}
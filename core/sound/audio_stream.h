@@ -0,0 +1,98 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Native-rate sound chip output streams
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _AUDIO_STREAM_H_
+#define _AUDIO_STREAM_H_
+
+/* Besides mixed output resampled through Blip Buffer, output of each sound chip can be   */
+/* captured at its native rate, before any resampling or filtering. Sound chips add the   */
+/* same output variations as the ones added to Blip Buffer (see sound.c, psg.c, pcm.c &   */
+/* cdd.c), which are integrated at the end of each frame into interleaved stereo 16-bit   */
+/* samples and stored in a ring buffer allocated for each enabled stream.                 */
+/*                                                                                        */
+/* Streams are read in place: audio_stream_read() returns the oldest unread samples that  */
+/* are contiguous in ring buffer and audio_stream_skip() releases them once consumed.     */
+/* When samples are not read fast enough, the oldest ones are overwritten.                */
+/*                                                                                        */
+/* When host-rate output is not needed, band-limited synthesis can be skipped entirely    */
+/* with audio_stream_exclusive(): mixed output returned by audio_update() is then silent. */
+
+/* Native-rate streams */
+#define AUDIO_STREAM_FM    0  /* YM2612 / YM3438 / YM2413 (one sample per FM chip output) */
+#define AUDIO_STREAM_PSG   1  /* SN76489 (one sample per 16 PSG clocks) */
+#define AUDIO_STREAM_PCM   2  /* Mega-CD RF5C164 (one sample per PCM chip output) */
+#define AUDIO_STREAM_CDDA  3  /* Mega-CD audio tracks (44100 Hz) */
+#define AUDIO_STREAM_COUNT 4
+
+/* Global variables */
+extern THREAD_LOCAL unsigned int audio_stream_mask;
+extern THREAD_LOCAL int audio_stream_only;
+
+/* Function prototypes (consumers) */
+extern int audio_stream_enable(int id, int size);
+extern void audio_stream_exclusive(int enable);
+extern double audio_stream_rate(int id);
+extern int audio_stream_read(int id, const int16 **samples);
+extern void audio_stream_skip(int id, int samples);
+extern void audio_stream_shutdown(void);
+
+/* Function prototypes (sound chips) */
+extern void audio_stream_set_clock(int id, double clock);
+extern void audio_stream_set_ratio(int id, unsigned int ratio);
+extern void audio_stream_reset(void);
+extern void audio_stream_delta(int id, unsigned int time, int delta_l, int delta_r);
+extern void audio_stream_deltas(int id, unsigned int time, unsigned int step, const int *deltas, int count);
+extern void audio_stream_end(int id, unsigned int time);
+
+/* Sound chips output variations (only a test when stream is disabled) */
+INLINE void audio_stream_add_delta(int id, unsigned int time, int delta_l, int delta_r)
+{
+  if (audio_stream_mask & (1 << id)) audio_stream_delta(id, time, delta_l, delta_r);
+}
+
+INLINE void audio_stream_add_deltas(int id, unsigned int time, unsigned int step, const int *deltas, int count)
+{
+  if (audio_stream_mask & (1 << id)) audio_stream_deltas(id, time, step, deltas, count);
+}
+
+INLINE void audio_stream_end_frame(int id, unsigned int time)
+{
+  if (audio_stream_mask & (1 << id)) audio_stream_end(id, time);
+}
+
+#endif /* _AUDIO_STREAM_H_ */
@@ -6,6 +6,8 @@
 /*  - added blip_mix_samples function (see blip_buf.h)              */
 /*  - added stereo buffer support (define #BLIP_MONO to disable)    */
 /*  - added inverted stereo output (define #BLIP_INVERT to enable)*/
+/*  - added SSE2 / AVX2 stereo synthesis & integration              */
+/*  - added blip_add_deltas_uniform functions (see blip_buf.h)      */
 
 #include "blip_buf.h"
 
@@ -16,6 +18,18 @@
 #include <string.h>
 #include <stdlib.h>
 
+/* SSE2 is always available on x86-64 (AVX2 support is detected at runtime) */
+#if !defined(BLIP_MONO)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAVE_SSE2_BLIP
+#include <emmintrin.h>
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))))
+#define HAVE_AVX2_BLIP
+#include <immintrin.h>
+#endif
+#endif
+#endif
+
 /* Library Copyright (C) 2003-2009 Shay Green. This library is free software;
 you can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -82,6 +96,11 @@ struct blip_t
   int integrator[2];
   buf_t* buffer[2];
 #endif
+#ifdef HAVE_SSE2_BLIP
+  /* SIMD functions (selected on creation, NULL for generic C code) */
+  void (*synth)( buf_t* out_l, buf_t* out_r, short const* pairs, int const* delta );
+  void (*integrate)( int* sum_l, int* sum_r, buf_t const* const* in_l, buf_t const* const* in_r, int inputs, short out [], int count );
+#endif
 };
 
 #ifdef BLIP_MONO
@@ -89,6 +108,15 @@ struct blip_t
 #define SAMPLES( blip ) ((buf_t*) ((blip) + 1))
 #endif
 
+/* Synthesis is inlined in single delta & uniform deltas functions */
+#if defined(__GNUC__)
+#define BLIP_INLINE static __inline__ __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define BLIP_INLINE static __forceinline
+#else
+#define BLIP_INLINE static
+#endif
+
 /* Arithmetic (sign-preserving) right shift */
 #define ARITH_SHIFT( n, shift ) \
 	((n) >> (shift))
@@ -126,6 +154,159 @@ static void check_assumptions( void )
 }
 #endif
 
+#ifdef HAVE_SSE2_BLIP
+
+/* Band-limited steps are synthesized and read with SIMD instructions, with exactly
+the same results as generic C code. Coefficients of two consecutive phases are
+interleaved (see bl_pairs), so that each output is computed with 16-bit multiply-adds
+of both deltas, split into 16-bit halves. Integrator outputs are clamped with signed
+saturation. */
+
+/* Packs low (high) 16-bit halves of both deltas into a 32-bit value */
+static int delta_lo( int delta0, int delta1 )
+{
+	return (int) (((unsigned) delta1 << 16) | (delta0 & 0xFFFF));
+}
+
+static int delta_hi( int delta0, int delta1 )
+{
+	/* sign-extended low halves are subtracted first */
+	unsigned hi0 = ((unsigned) delta0 - (unsigned) (((delta0 & 0xFFFF) ^ 0x8000) - 0x8000)) >> 16;
+	unsigned hi1 = ((unsigned) delta1 - (unsigned) (((delta1 & 0xFFFF) ^ 0x8000) - 0x8000)) >> 16;
+	return (int) ((hi1 << 16) | hi0);
+}
+
+static __m128i synth_sse2_step( __m128i pairs, __m128i lo, __m128i hi )
+{
+	return _mm_add_epi32( _mm_madd_epi16( pairs, lo ), _mm_slli_epi32( _mm_madd_epi16( pairs, hi ), 16 ) );
+}
+
+static void synth_sse2( buf_t* out_l, buf_t* out_r, short const* pairs, int const* delta )
+{
+	__m128i lo_l = _mm_set1_epi32( delta_lo( delta[0], delta[1] ) );
+	__m128i hi_l = _mm_set1_epi32( delta_hi( delta[0], delta[1] ) );
+	int i;
+
+	if ( (delta[0] == delta[2]) && (delta[1] == delta[3]) )
+	{
+		for ( i = 0; i < half_width*2; i += 4 )
+		{
+			__m128i out = synth_sse2_step( _mm_loadu_si128( (__m128i const*) (pairs + i*2) ), lo_l, hi_l );
+			_mm_storeu_si128( (__m128i*) (out_l + i), _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out_l + i) ), out ) );
+			_mm_storeu_si128( (__m128i*) (out_r + i), _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out_r + i) ), out ) );
+		}
+	}
+	else
+	{
+		__m128i lo_r = _mm_set1_epi32( delta_lo( delta[2], delta[3] ) );
+		__m128i hi_r = _mm_set1_epi32( delta_hi( delta[2], delta[3] ) );
+
+		for ( i = 0; i < half_width*2; i += 4 )
+		{
+			__m128i in = _mm_loadu_si128( (__m128i const*) (pairs + i*2) );
+			_mm_storeu_si128( (__m128i*) (out_l + i), _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out_l + i) ), synth_sse2_step( in, lo_l, hi_l ) ) );
+			_mm_storeu_si128( (__m128i*) (out_r + i), _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out_r + i) ), synth_sse2_step( in, lo_r, hi_r ) ) );
+		}
+	}
+}
+
+#ifdef HAVE_AVX2_BLIP
+__attribute__((target("avx2"))) static __m256i synth_avx2_step( __m256i pairs, __m256i lo, __m256i hi )
+{
+	return _mm256_add_epi32( _mm256_madd_epi16( pairs, lo ), _mm256_slli_epi32( _mm256_madd_epi16( pairs, hi ), 16 ) );
+}
+
+__attribute__((target("avx2"))) static void synth_avx2( buf_t* out_l, buf_t* out_r, short const* pairs, int const* delta )
+{
+	__m256i in0 = _mm256_loadu_si256( (__m256i const*) pairs );
+	__m256i in1 = _mm256_loadu_si256( (__m256i const*) (pairs + 16) );
+	__m256i lo = _mm256_set1_epi32( delta_lo( delta[0], delta[1] ) );
+	__m256i hi = _mm256_set1_epi32( delta_hi( delta[0], delta[1] ) );
+	__m256i out0 = synth_avx2_step( in0, lo, hi );
+	__m256i out1 = synth_avx2_step( in1, lo, hi );
+
+	_mm256_storeu_si256( (__m256i*) out_l, _mm256_add_epi32( _mm256_loadu_si256( (__m256i const*) out_l ), out0 ) );
+	_mm256_storeu_si256( (__m256i*) (out_l + 8), _mm256_add_epi32( _mm256_loadu_si256( (__m256i const*) (out_l + 8) ), out1 ) );
+
+	if ( (delta[0] != delta[2]) || (delta[1] != delta[3]) )
+	{
+		lo = _mm256_set1_epi32( delta_lo( delta[2], delta[3] ) );
+		hi = _mm256_set1_epi32( delta_hi( delta[2], delta[3] ) );
+		out0 = synth_avx2_step( in0, lo, hi );
+		out1 = synth_avx2_step( in1, lo, hi );
+	}
+
+	_mm256_storeu_si256( (__m256i*) out_r, _mm256_add_epi32( _mm256_loadu_si256( (__m256i const*) out_r ), out0 ) );
+	_mm256_storeu_si256( (__m256i*) (out_r + 8), _mm256_add_epi32( _mm256_loadu_si256( (__m256i const*) (out_r + 8) ), out1 ) );
+}
+#endif
+
+/* Integrates one stereo input (left in low lane, right in next lane) */
+static __m128i integrate_sse2_step( __m128i sum, __m128i in, short out [] )
+{
+	/* Eliminate fraction */
+	__m128i s = _mm_srai_epi32( sum, delta_bits );
+
+	/* CLAMP */
+	s = _mm_packs_epi32( s, s );
+	{
+		int pair = _mm_cvtsi128_si32( s );
+		memcpy( out, &pair, sizeof (pair) );
+	}
+	s = _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 );
+
+	/* High-pass filter */
+	return _mm_sub_epi32( _mm_add_epi32( sum, in ), _mm_slli_epi32( s, delta_bits - bass_shift ) );
+}
+
+static void integrate_sse2( int* sum_l, int* sum_r, buf_t const* const* in_l, buf_t const* const* in_r, int inputs, short out [], int count )
+{
+	__m128i sum = _mm_set_epi32( 0, 0, *sum_r, *sum_l );
+	int i, k;
+
+	/* four samples per iteration, inputs being mixed first */
+	for ( i = 0; i + 4 <= count; i += 4 )
+	{
+		__m128i l = _mm_loadu_si128( (__m128i const*) (in_l[0] + i) );
+		__m128i r = _mm_loadu_si128( (__m128i const*) (in_r[0] + i) );
+		__m128i in;
+
+		for ( k = 1; k < inputs; k++ )
+		{
+			l = _mm_add_epi32( l, _mm_loadu_si128( (__m128i const*) (in_l[k] + i) ) );
+			r = _mm_add_epi32( r, _mm_loadu_si128( (__m128i const*) (in_r[k] + i) ) );
+		}
+
+		in = _mm_unpacklo_epi32( l, r );
+		sum = integrate_sse2_step( sum, in, out );
+		sum = integrate_sse2_step( sum, _mm_srli_si128( in, 8 ), out + 2 );
+		in = _mm_unpackhi_epi32( l, r );
+		sum = integrate_sse2_step( sum, in, out + 4 );
+		sum = integrate_sse2_step( sum, _mm_srli_si128( in, 8 ), out + 6 );
+		out += 8;
+	}
+
+	for ( ; i < count; i++ )
+	{
+		int l = in_l[0][i];
+		int r = in_r[0][i];
+
+		for ( k = 1; k < inputs; k++ )
+		{
+			l += in_l[k][i];
+			r += in_r[k][i];
+		}
+
+		sum = integrate_sse2_step( sum, _mm_set_epi32( 0, 0, r, l ), out );
+		out += 2;
+	}
+
+	*sum_l = _mm_cvtsi128_si32( sum );
+	*sum_r = _mm_cvtsi128_si32( _mm_srli_si128( sum, 4 ) );
+}
+
+#endif
+
 blip_t* blip_new( int size )
 {
 	blip_t* m;
@@ -149,6 +330,17 @@ blip_t* blip_new( int size )
       blip_delete(m);
       return 0;
     }
+#endif
+#ifdef HAVE_SSE2_BLIP
+    m->synth = synth_sse2;
+    m->integrate = integrate_sse2;
+#ifdef HAVE_AVX2_BLIP
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+      m->synth = synth_avx2;
+    }
+#endif
 #endif
 		m->factor = time_unit / blip_max_ratio;
 		m->size   = size;
@@ -265,6 +457,15 @@ static void remove_samples( blip_t* m, int count )
 #endif
 }
 
+void blip_discard_samples( blip_t* m, int count )
+{
+	if ( count > (m->offset >> time_bits) )
+		count = m->offset >> time_bits;
+
+	if ( count > 0 )
+		remove_samples( m, count );
+}
+
 int blip_read_samples( blip_t* m, short out [], int count)
 {
 #ifdef BLIP_ASSERT
@@ -286,6 +487,11 @@ int blip_read_samples( blip_t* m, short out [], int count)
 		int sum2 = m->integrator[1];
 #endif
 		buf_t const* end = in + count;
+#ifdef HAVE_SSE2_BLIP
+		if ( m->integrate )
+			m->integrate( &sum, &sum2, &in, &in2, 1, out, count );
+		else
+#endif
 		do
 		{
 			/* Eliminate fraction */
@@ -363,6 +569,11 @@ int blip_mix_samples( blip_t* m1, blip_t* m2, blip_t* m3, short out [], int coun
 #endif
 
     end = in[0] + count;
+#ifdef HAVE_SSE2_BLIP
+    if ( m1->integrate )
+      m1->integrate( &sum, &sum2, in, in2, 3, out, count );
+    else
+#endif
     do
     {
       /* Eliminate fraction */
@@ -455,6 +666,77 @@ static short const bl_step [phase_count + 1] [half_width] =
 {    0,   43, -115,  350, -488, 1136, -914, 5861}
 };
 
+#ifdef HAVE_SSE2_BLIP
+/* bl_step [phase] & bl_step [phase + 1] coefficients for each output, interleaved */
+static short const bl_pairs [phase_count] [half_width*4] =
+{
+{    43,    44,  -115,  -118,   350,   348,  -488,  -473,  1136,  1076,  -914,  -799,  5861,  5274, 21022, 21001,
+   5861,  6464,  -914, -1021,  1136,  1190,  -488,  -499,   350,   350,  -115,  -110,    43,    40,     0,     1},
+{    44,    45,  -118,  -121,   348,   344,  -473,  -454,  1076,  1011,  -799,  -677,  5274,  4706, 21001, 20936,
+   6464,  7082, -1021, -1119,  1190,  1238,  -499,  -506,   350,   347,  -110,  -102,    40,    35,     1,     3},
+{    45,    46,  -121,  -122,   344,   336,  -454,  -431,  1011,   942,  -677,  -549,  4706,  4156, 20936, 20829,
+   7082,  7713, -1119, -1205,  1238,  1278,  -506,  -507,   347,   341,  -102,   -94,    35,    31,     3,     4},
+{    46,    47,  -122,  -123,   336,   327,  -431,  -404,   942,   868,  -549,  -418,  4156,  3629, 20829, 20679,
+   7713,  8355, -1205, -1280,  1278,  1312,  -507,  -504,   341,   333,   -94,   -85,    31,    26,     4,     6},
+{    47,    47,  -123,  -122,   327,   316,  -404,  -375,   868,   792,  -418,  -285,  3629,  3124, 20679, 20488,
+   8355,  9005, -1280, -1339,  1312,  1337,  -504,  -496,   333,   322,   -85,   -75,    26,    22,     6,     7},
+{    47,    47,  -122,  -120,   316,   303,  -375,  -344,   792,   714,  -285,  -151,  3124,  2644, 20488, 20256,
+   9005,  9660, -1339, -1383,  1337,  1354,  -496,  -483,   322,   309,   -75,   -63,    22,    16,     7,     9},
+{    47,    46,  -120,  -117,   303,   289,  -344,  -310,   714,   634,  -151,   -17,  2644,  2188, 20256, 19985,
+   9660, 10319, -1383, -1410,  1354,  1362,  -483,  -464,   309,   292,   -63,   -49,    16,     9,     9,    11},
+{    46,    46,  -117,  -114,   289,   273,  -310,  -275,   634,   553,   -17,   117,  2188,  1758, 19985, 19675,
+  10319, 10979, -1410, -1419,  1362,  1361,  -464,  -439,   292,   272,   -49,   -35,     9,     3,    11,    13},
+{    46,    44,  -114,  -108,   273,   255,  -275,  -237,   553,   471,   117,   247,  1758,  1356, 19675, 19327,
+  10979, 11638, -1419, -1408,  1361,  1351,  -439,  -410,   272,   250,   -35,   -19,     3,    -4,    13,    15},
+{    44,    43,  -108,  -103,   255,   237,  -237,  -199,   471,   390,   247,   373,  1356,   981, 19327, 18944,
+  11638, 12293, -1408, -1376,  1351,  1331,  -410,  -375,   250,   226,   -19,    -3,    -4,   -12,    15,    18},
+{    43,    42,  -103,   -98,   237,   218,  -199,  -160,   390,   310,   373,   495,   981,   633, 18944, 18527,
+  12293, 12942, -1376, -1322,  1331,  1301,  -375,  -335,   226,   199,    -3,    16,   -12,   -20,    18,    20},
+{    42,    40,   -98,   -91,   218,   198,  -160,  -121,   310,   231,   495,   611,   633,   314, 18527, 18078,
+  12942, 13582, -1322, -1244,  1301,  1261,  -335,  -290,   199,   170,    16,    34,   -20,   -27,    20,    22},
+{    40,    38,   -91,   -84,   198,   178,  -121,   -81,   231,   153,   611,   722,   314,    22, 18078, 17599,
+  13582, 14210, -1244, -1142,  1261,  1211,  -290,  -239,   170,   139,    34,    53,   -27,   -36,    22,    25},
+{    38,    36,   -84,   -76,   178,   157,   -81,   -43,   153,    80,   722,   824,    22,  -241, 17599, 17092,
+  14210, 14824, -1142, -1015,  1211,  1152,  -239,  -184,   139,   106,    53,    73,   -36,   -44,    25,    27},
+{    36,    34,   -76,   -68,   157,   135,   -43,    -3,    80,     8,   824,   919,  -241,  -476, 17092, 16558,
+  14824, 15422, -1015,  -862,  1152,  1083,  -184,  -123,   106,    70,    73,    94,   -44,   -52,    27,    29},
+{    34,    32,   -68,   -61,   135,   115,    -3,    34,     8,   -60,   919,  1006,  -476,  -683, 16558, 16001,
+  15422, 16001,  -862,  -683,  1083,  1006,  -123,   -60,    70,    34,    94,   115,   -52,   -61,    29,    32},
+{    32,    29,   -61,   -52,   115,    94,    34,    70,   -60,  -123,  1006,  1083,  -683,  -862, 16001, 15422,
+  16001, 16558,  -683,  -476,  1006,   919,   -60,     8,    34,    -3,   115,   135,   -61,   -68,    32,    34},
+{    29,    27,   -52,   -44,    94,    73,    70,   106,  -123,  -184,  1083,  1152,  -862, -1015, 15422, 14824,
+  16558, 17092,  -476,  -241,   919,   824,     8,    80,    -3,   -43,   135,   157,   -68,   -76,    34,    36},
+{    27,    25,   -44,   -36,    73,    53,   106,   139,  -184,  -239,  1152,  1211, -1015, -1142, 14824, 14210,
+  17092, 17599,  -241,    22,   824,   722,    80,   153,   -43,   -81,   157,   178,   -76,   -84,    36,    38},
+{    25,    22,   -36,   -27,    53,    34,   139,   170,  -239,  -290,  1211,  1261, -1142, -1244, 14210, 13582,
+  17599, 18078,    22,   314,   722,   611,   153,   231,   -81,  -121,   178,   198,   -84,   -91,    38,    40},
+{    22,    20,   -27,   -20,    34,    16,   170,   199,  -290,  -335,  1261,  1301, -1244, -1322, 13582, 12942,
+  18078, 18527,   314,   633,   611,   495,   231,   310,  -121,  -160,   198,   218,   -91,   -98,    40,    42},
+{    20,    18,   -20,   -12,    16,    -3,   199,   226,  -335,  -375,  1301,  1331, -1322, -1376, 12942, 12293,
+  18527, 18944,   633,   981,   495,   373,   310,   390,  -160,  -199,   218,   237,   -98,  -103,    42,    43},
+{    18,    15,   -12,    -4,    -3,   -19,   226,   250,  -375,  -410,  1331,  1351, -1376, -1408, 12293, 11638,
+  18944, 19327,   981,  1356,   373,   247,   390,   471,  -199,  -237,   237,   255,  -103,  -108,    43,    44},
+{    15,    13,    -4,     3,   -19,   -35,   250,   272,  -410,  -439,  1351,  1361, -1408, -1419, 11638, 10979,
+  19327, 19675,  1356,  1758,   247,   117,   471,   553,  -237,  -275,   255,   273,  -108,  -114,    44,    46},
+{    13,    11,     3,     9,   -35,   -49,   272,   292,  -439,  -464,  1361,  1362, -1419, -1410, 10979, 10319,
+  19675, 19985,  1758,  2188,   117,   -17,   553,   634,  -275,  -310,   273,   289,  -114,  -117,    46,    46},
+{    11,     9,     9,    16,   -49,   -63,   292,   309,  -464,  -483,  1362,  1354, -1410, -1383, 10319,  9660,
+  19985, 20256,  2188,  2644,   -17,  -151,   634,   714,  -310,  -344,   289,   303,  -117,  -120,    46,    47},
+{     9,     7,    16,    22,   -63,   -75,   309,   322,  -483,  -496,  1354,  1337, -1383, -1339,  9660,  9005,
+  20256, 20488,  2644,  3124,  -151,  -285,   714,   792,  -344,  -375,   303,   316,  -120,  -122,    47,    47},
+{     7,     6,    22,    26,   -75,   -85,   322,   333,  -496,  -504,  1337,  1312, -1339, -1280,  9005,  8355,
+  20488, 20679,  3124,  3629,  -285,  -418,   792,   868,  -375,  -404,   316,   327,  -122,  -123,    47,    47},
+{     6,     4,    26,    31,   -85,   -94,   333,   341,  -504,  -507,  1312,  1278, -1280, -1205,  8355,  7713,
+  20679, 20829,  3629,  4156,  -418,  -549,   868,   942,  -404,  -431,   327,   336,  -123,  -122,    47,    46},
+{     4,     3,    31,    35,   -94,  -102,   341,   347,  -507,  -506,  1278,  1238, -1205, -1119,  7713,  7082,
+  20829, 20936,  4156,  4706,  -549,  -677,   942,  1011,  -431,  -454,   336,   344,  -122,  -121,    46,    45},
+{     3,     1,    35,    40,  -102,  -110,   347,   350,  -506,  -499,  1238,  1190, -1119, -1021,  7082,  6464,
+  20936, 21001,  4706,  5274,  -677,  -799,  1011,  1076,  -454,  -473,   344,   348,  -121,  -118,    45,    44},
+{     1,     0,    40,    43,  -110,  -115,   350,   350,  -499,  -488,  1190,  1136, -1021,  -914,  6464,  5861,
+  21001, 21022,  5274,  5861,  -799,  -914,  1076,  1136,  -473,  -488,   348,   350,  -118,  -115,    44,    43}
+};
+#endif
+
 /* Shifting by pre_shift allows calculation using unsigned int rather than
 possibly-wider fixed_t. On 32-bit platforms, this is likely more efficient.
 And by having pre_shift 32, a 32-bit platform can easily do the shift by
@@ -462,11 +744,10 @@ simply ignoring the low half. */
 
 #ifndef BLIP_MONO
 
-void blip_add_delta( blip_t* m, unsigned time, int delta_l, int delta_r )
+BLIP_INLINE void add_delta( blip_t* m, unsigned fixed, int delta_l, int delta_r )
 {
   if (delta_l | delta_r)
   {
-    unsigned fixed = (unsigned) ((time * m->factor + m->offset) >> pre_shift);
     int phase = fixed >> phase_shift & (phase_count - 1);
     short const* in  = bl_step [phase];
     short const* rev = bl_step [phase_count - phase];
@@ -488,6 +769,21 @@ void blip_add_delta( blip_t* m, unsigned time, int delta_l, int delta_r )
     assert( pos <= m->size + end_frame_extra );
 #endif
 
+#ifdef HAVE_SSE2_BLIP
+    if (m->synth)
+    {
+      int deltas[4];
+      delta = (delta_l * interp) >> delta_bits;
+      deltas[0] = delta_l - delta;
+      deltas[1] = delta;
+      delta = (delta_r * interp) >> delta_bits;
+      deltas[2] = delta_r - delta;
+      deltas[3] = delta;
+      m->synth(out_l, out_r, bl_pairs[phase], deltas);
+      return;
+    }
+#endif
+
     if (delta_l == delta_r)
     {
       buf_t out;
@@ -585,11 +881,10 @@ void blip_add_delta( blip_t* m, unsigned time, int delta_l, int delta_r )
   }
 }
 
-void blip_add_delta_fast( blip_t* m, unsigned time, int delta_l, int delta_r )
+BLIP_INLINE void add_delta_fast( blip_t* m, unsigned fixed, int delta_l, int delta_r )
 {
   if (delta_l | delta_r)
   {
-    unsigned fixed = (unsigned) ((time * m->factor + m->offset) >> pre_shift);
     int interp = fixed >> (frac_bits - delta_bits) & (delta_unit - 1);
     int pos = fixed >> frac_bits;
 
@@ -627,6 +922,44 @@ void blip_add_delta_fast( blip_t* m, unsigned time, int delta_l, int delta_r )
   }
 }
 
+void blip_add_delta( blip_t* m, unsigned time, int delta_l, int delta_r )
+{
+  add_delta( m, (unsigned) ((time * m->factor + m->offset) >> pre_shift), delta_l, delta_r );
+}
+
+void blip_add_delta_fast( blip_t* m, unsigned time, int delta_l, int delta_r )
+{
+  add_delta_fast( m, (unsigned) ((time * m->factor + m->offset) >> pre_shift), delta_l, delta_r );
+}
+
+void blip_add_deltas_uniform( blip_t* m, unsigned time, unsigned step, int const* deltas, int count )
+{
+  /* time of each delta is incremented in fixed-point output samples */
+  fixed_t pos = time * m->factor + m->offset;
+  fixed_t inc = step * m->factor;
+
+  while (count-- > 0)
+  {
+    add_delta( m, (unsigned) (pos >> pre_shift), deltas[0], deltas[1] );
+    deltas += 2;
+    pos += inc;
+  }
+}
+
+void blip_add_deltas_uniform_fast( blip_t* m, unsigned time, unsigned step, int const* deltas, int count )
+{
+  /* time of each delta is incremented in fixed-point output samples */
+  fixed_t pos = time * m->factor + m->offset;
+  fixed_t inc = step * m->factor;
+
+  while (count-- > 0)
+  {
+    add_delta_fast( m, (unsigned) (pos >> pre_shift), deltas[0], deltas[1] );
+    deltas += 2;
+    pos += inc;
+  }
+}
+
 #else
 
 void blip_add_delta( blip_t* m, unsigned time, int delta )
@@ -683,4 +1016,26 @@ void blip_add_delta_fast( blip_t* m, unsigned time, int delta )
 	out [7] += delta * delta_unit - delta2;
 	out [8] += delta2;
 }
+
+void blip_add_deltas_uniform( blip_t* m, unsigned time, unsigned step, int const* deltas, int count )
+{
+	while ( count-- > 0 )
+	{
+		if ( *deltas )
+			blip_add_delta( m, time, *deltas );
+		deltas++;
+		time += step;
+	}
+}
+
+void blip_add_deltas_uniform_fast( blip_t* m, unsigned time, unsigned step, int const* deltas, int count )
+{
+	while ( count-- > 0 )
+	{
+		if ( *deltas )
+			blip_add_delta_fast( m, time, *deltas );
+		deltas++;
+		time += step;
+	}
+}
 #endif
@@ -36,6 +36,13 @@ void blip_add_delta( blip_t*, unsigned time, int delta_l, int delta_r );
 /** Same as blip_add_delta(), but uses faster, lower-quality synthesis. */
 void blip_add_delta_fast( blip_t*, unsigned int clock_time, int delta_l, int delta_r );
 
+/** Adds 'count' pairs of left/right deltas, the first one at specified clock time
+and next ones every 'clock_step' clocks. Zero deltas are skipped. */
+void blip_add_deltas_uniform( blip_t*, unsigned int clock_time, unsigned int clock_step, int const* deltas, int count );
+
+/** Same as blip_add_deltas_uniform(), but uses faster, lower-quality synthesis. */
+void blip_add_deltas_uniform_fast( blip_t*, unsigned int clock_time, unsigned int clock_step, int const* deltas, int count );
+
 #else
 
 /** Adds positive/negative delta into buffer at specified clock time. */
@@ -44,6 +51,13 @@ void blip_add_delta( blip_t*, unsigned int clock_time, int delta );
 /** Same as blip_add_delta(), but uses faster, lower-quality synthesis. */
 void blip_add_delta_fast( blip_t*, unsigned int clock_time, int delta );
 
+/** Adds 'count' deltas, the first one at specified clock time and next ones every
+'clock_step' clocks. Zero deltas are skipped. */
+void blip_add_deltas_uniform( blip_t*, unsigned int clock_time, unsigned int clock_step, int const* deltas, int count );
+
+/** Same as blip_add_deltas_uniform(), but uses faster, lower-quality synthesis. */
+void blip_add_deltas_uniform_fast( blip_t*, unsigned int clock_time, unsigned int clock_step, int const* deltas, int count );
+
 #endif
 
 /** Length of time frame, in clocks, needed to make sample_count additional
@@ -71,6 +85,9 @@ int blip_read_samples( blip_t*, short out [], int count);
 /* Same as above function except sample is mixed from three blip buffers source */
 int blip_mix_samples( blip_t* m1, blip_t* m2, blip_t* m3, short out [], int count);
 
+/** Removes at most 'count' samples without reading them. */
+void blip_discard_samples( blip_t*, int count );
+
 /** Frees buffer. No effect if NULL is passed. */
 void blip_delete( blip_t* );
 
@@ -49,6 +49,9 @@
 /* maximal channel output (roughly adjusted to match VA4 MD1 PSG/FM balance with 1.5x amplification of PSG output) */
 #define PSG_MAX_VOLUME 2800
 
+/* Maximal number of channel transitions added to blip buffer at once */
+#define PSG_MAX_DELTAS 64
+
 static const uint8 noiseShiftWidth[2] = {14,15};
 
 static const uint8 noiseBitMask[2] = {0x6,0x9};
@@ -74,7 +77,7 @@ static const uint16 chanVolume[16] = {
   0                             /*  OFF  */
 };
 
-static struct
+static THREAD_LOCAL struct
 {
   int clocks;
   int latch;
@@ -92,6 +95,8 @@ static struct
 } psg;
 
 static void psg_update(unsigned int clocks);
+static void psg_skip(unsigned int clocks);
+static void psg_add_delta(unsigned int time, int delta_l, int delta_r);
 
 void psg_init(PSG_TYPE type)
 {
@@ -110,6 +115,12 @@ void psg_init(PSG_TYPE type)
   /* Initialize Noise LSFR type */
   psg.noiseShiftWidth = noiseShiftWidth[type];
   psg.noiseBitMask = noiseBitMask[type];
+
+  /* native-rate output stream (one sample per internal cycle) */
+  audio_stream_set_ratio(AUDIO_STREAM_PSG, PSG_MCYCLES_RATIO);
+
+  /* snapshot areas */
+  snapshot_var(psg);
 }
 
 void psg_reset()
@@ -210,14 +221,7 @@ int psg_context_load(uint8 *state)
   }
 
   /* update mixed channels output */
-  if (config.hq_psg)
-  {
-    blip_add_delta(snd.blips[0], psg.clocks, delta[0], delta[1]);
-  }
-  else
-  {
-    blip_add_delta_fast(snd.blips[0], psg.clocks, delta[0], delta[1]);
-  }
+  psg_add_delta(psg.clocks, delta[0], delta[1]);
 
   return bufferptr;
 }
@@ -450,26 +454,89 @@ void psg_end_frame(unsigned int clocks)
   {
     psg.freqCounter[i] -= clocks;
   }
+
+  /* end of native-rate output stream frame */
+  audio_stream_end_frame(AUDIO_STREAM_PSG, clocks);
+}
+
+/* Add channel output variation */
+static void psg_add_delta(unsigned int time, int delta_l, int delta_r)
+{
+  /* no audio output (see audio_set_skip) */
+  if (snd.skip)
+  {
+    return;
+  }
+
+  audio_stream_add_delta(AUDIO_STREAM_PSG, time, delta_l, delta_r);
+
+  if (audio_stream_only)
+  {
+    return;
+  }
+
+  if (config.hq_psg)
+  {
+    blip_add_delta(snd.blips[0], time, delta_l, delta_r);
+  }
+  else
+  {
+    blip_add_delta_fast(snd.blips[0], time, delta_l, delta_r);
+  }
+}
+
+/* Add channel output variations occurring at regular intervals */
+static void psg_add_deltas(unsigned int time, unsigned int step, const int *deltas, int count)
+{
+  audio_stream_add_deltas(AUDIO_STREAM_PSG, time, step, deltas, count);
+
+  if (audio_stream_only)
+  {
+    return;
+  }
+
+  if (config.hq_psg)
+  {
+    blip_add_deltas_uniform(snd.blips[0], time, step, deltas, count);
+  }
+  else
+  {
+    blip_add_deltas_uniform_fast(snd.blips[0], time, step, deltas, count);
+  }
+}
+
+/* Shift noise register */
+INLINE int psg_noise_shift(int shiftValue)
+{
+  /* White noise (-----1xx) */
+  if (psg.regs[6] & 0x04)
+  {
+    /* shift and apply XOR feedback network */
+    return (shiftValue >> 1) | (noiseFeedback[shiftValue & psg.noiseBitMask] << psg.noiseShiftWidth);
+  }
+
+  /* Periodic noise (-----0xx): shift and feedback current output */
+  return (shiftValue >> 1) | ((shiftValue & 0x01) << psg.noiseShiftWidth);
 }
 
 static void psg_update(unsigned int clocks)
 {
   int i, timestamp, polarity;
 
+  /* only update generators state when there is no audio output */
+  if (snd.skip)
+  {
+    psg_skip(clocks);
+    return;
+  }
+
   for (i=0; i<4; i++)
   {
     /* apply any pending channel volume variations */
     if (psg.chanDelta[i][0] | psg.chanDelta[i][1])
     {
       /* update channel output */
-      if (config.hq_psg)
-      {
-        blip_add_delta(snd.blips[0], psg.clocks, psg.chanDelta[i][0], psg.chanDelta[i][1]);
-      }
-      else
-      {
-        blip_add_delta_fast(snd.blips[0], psg.clocks, psg.chanDelta[i][0], psg.chanDelta[i][1]);
-      }
+      psg_add_delta(psg.clocks, psg.chanDelta[i][0], psg.chanDelta[i][1]);
 
       /* clear pending channel volume variations */
       psg.chanDelta[i][0] = 0;
@@ -488,21 +555,27 @@ static void psg_update(unsigned int clocks)
       /* process all transitions occurring until current clock timestamp */
       while (timestamp < clocks)
       {
-        /* invert tone generator polarity */
-        polarity = -polarity;
+        int deltas[PSG_MAX_DELTAS * 2];
+        int start = timestamp;
+        int count = 0;
 
-        /* update channel output */
-        if (config.hq_psg)
-        {
-          blip_add_delta(snd.blips[0], timestamp, polarity*psg.chanOut[i][0], polarity*psg.chanOut[i][1]);
-        }
-        else
+        do
         {
-          blip_add_delta_fast(snd.blips[0], timestamp, polarity*psg.chanOut[i][0], polarity*psg.chanOut[i][1]);
+          /* invert tone generator polarity */
+          polarity = -polarity;
+
+          /* channel output variation */
+          deltas[count * 2] = polarity*psg.chanOut[i][0];
+          deltas[count * 2 + 1] = polarity*psg.chanOut[i][1];
+          count++;
+
+          /* timestamp of next transition */
+          timestamp += psg.freqInc[i];
         }
+        while ((timestamp < clocks) && (count < PSG_MAX_DELTAS));
 
-        /* timestamp of next transition */
-        timestamp += psg.freqInc[i];
+        /* update channel output */
+        psg_add_deltas(start, psg.freqInc[i], deltas, count);
       }
     }
 
@@ -515,45 +588,45 @@ static void psg_update(unsigned int clocks)
       /* process all transitions occurring until current clock timestamp */
       while (timestamp < clocks)
       {
-        /* invert noise generator polarity */
-        polarity = -polarity;
+        int deltas[PSG_MAX_DELTAS * 2];
+        int start = timestamp;
+        int count = 0;
 
-        /* noise register is shifted on positive edge only */
-        if (polarity > 0)
+        do
         {
-          /* current shift register output */
-          int shiftOutput = shiftValue & 0x01;
+          /* invert noise generator polarity */
+          polarity = -polarity;
 
-          /* White noise (-----1xx) */
-          if (psg.regs[6] & 0x04)
+          /* noise register is shifted on positive edge only */
+          if (polarity > 0)
           {
-            /* shift and apply XOR feedback network */
-            shiftValue = (shiftValue >> 1) | (noiseFeedback[shiftValue & psg.noiseBitMask] << psg.noiseShiftWidth);
-          }
+            /* current shift register output */
+            int shiftOutput = shiftValue & 0x01;
 
-          /* Periodic noise (-----0xx) */
-          else
-          {
-            /* shift and feedback current output */
-            shiftValue = (shiftValue >> 1) | (shiftOutput << psg.noiseShiftWidth);
-          }
+            /* shift noise register */
+            shiftValue = psg_noise_shift(shiftValue);
 
-          /* shift register output variation */
-          shiftOutput = (shiftValue & 0x1) - shiftOutput;
+            /* shift register output variation */
+            shiftOutput = (shiftValue & 0x1) - shiftOutput;
 
-          /* update noise channel output */
-          if (config.hq_psg)
-          {
-            blip_add_delta(snd.blips[0], timestamp, shiftOutput*psg.chanOut[3][0], shiftOutput*psg.chanOut[3][1]);
+            /* noise channel output variation */
+            deltas[count * 2] = shiftOutput*psg.chanOut[3][0];
+            deltas[count * 2 + 1] = shiftOutput*psg.chanOut[3][1];
           }
           else
           {
-            blip_add_delta_fast(snd.blips[0], timestamp, shiftOutput*psg.chanOut[3][0], shiftOutput*psg.chanOut[3][1]);
+            deltas[count * 2] = 0;
+            deltas[count * 2 + 1] = 0;
           }
+          count++;
+
+          /* timestamp of next transition */
+          timestamp += psg.freqInc[3];
         }
+        while ((timestamp < clocks) && (count < PSG_MAX_DELTAS));
 
-        /* timestamp of next transition */
-        timestamp += psg.freqInc[3];
+        /* update noise channel output */
+        psg_add_deltas(start, psg.freqInc[3], deltas, count);
       }
 
       /* save shift register value */
@@ -567,3 +640,59 @@ static void psg_update(unsigned int clocks)
     psg.polarity[i] = polarity;
   }
 }  
+
+/* Same as psg_update, except that channels output is not generated */
+static void psg_skip(unsigned int clocks)
+{
+  int i, count;
+
+  for (i=0; i<4; i++)
+  {
+    /* pending channel volume variations are not needed */
+    psg.chanDelta[i][0] = 0;
+    psg.chanDelta[i][1] = 0;
+
+    /* check if transitions occur until current clock timestamp */
+    if (psg.freqCounter[i] < clocks)
+    {
+      /* number of transitions */
+      count = (clocks - psg.freqCounter[i] + psg.freqInc[i] - 1) / psg.freqInc[i];
+
+      /* timestamp of next transition */
+      psg.freqCounter[i] += count * psg.freqInc[i];
+
+      /* Tone channels */
+      if (i < 3)
+      {
+        /* tone generator polarity is inverted on each transition */
+        if (count & 1)
+        {
+          psg.polarity[i] = -psg.polarity[i];
+        }
+      }
+
+      /* Noise channel */
+      else
+      {
+        int polarity = psg.polarity[3];
+        int shiftValue = psg.noiseShiftValue;
+
+        do
+        {
+          /* invert noise generator polarity */
+          polarity = -polarity;
+
+          /* noise register is shifted on positive edge only */
+          if (polarity > 0)
+          {
+            shiftValue = psg_noise_shift(shiftValue);
+          }
+        }
+        while (--count);
+
+        psg.polarity[3] = polarity;
+        psg.noiseShiftValue = shiftValue;
+      }
+    }
+  }
+}
@@ -40,60 +40,76 @@
 #include "shared.h"
 #include "blip_buf.h"
 
+#ifdef USE_YM3438_THREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 /* FM output buffer (large enough to hold a whole frame at original chips rate) */
 #ifdef HAVE_YM3438_CORE
-static int fm_buffer[1080 * 2 * 24];
+#define FM_BUFFER_SIZE (1080 * 2 * 24)
+#else
+#define FM_BUFFER_SIZE (1080 * 2)
+#endif
+#ifdef USE_DYNAMIC_ALLOC
+static THREAD_LOCAL int *fm_buffer;
 #else
-static int fm_buffer[1080 * 2];
+static THREAD_LOCAL int fm_buffer[FM_BUFFER_SIZE];
 #endif
 
-static int fm_last[2];
-static int *fm_ptr;
+static THREAD_LOCAL int fm_last[2];
+static THREAD_LOCAL int *fm_ptr;
 
 /* Cycle-accurate FM samples */
-static uint32 fm_cycles_ratio;
-static uint32 fm_cycles_start;
-static uint32 fm_cycles_count;
+static THREAD_LOCAL uint32 fm_cycles_ratio;
+static THREAD_LOCAL uint32 fm_cycles_start;
+static THREAD_LOCAL uint32 fm_cycles_count;
 
 /* YM chip function pointers */
-static void (*YM_Reset)(void);
-static void (*YM_Update)(int *buffer, int length);
-static void (*YM_Write)(unsigned int a, unsigned int v);
-static unsigned int (*YM_Read)(unsigned int a);
+static THREAD_LOCAL void (*YM_Reset)(void);
+static THREAD_LOCAL void (*YM_Update)(int *buffer, int length);
+static THREAD_LOCAL void (*YM_Skip)(int length);
+static THREAD_LOCAL void (*YM_Write)(unsigned int a, unsigned int v);
+static THREAD_LOCAL unsigned int (*YM_Read)(unsigned int a);
 
 #ifdef HAVE_YM3438_CORE
-static ym3438_t ym3438;
-static int ym3438_accm[24][2];
-static int ym3438_sample[2];
-static unsigned int ym3438_cycles;
+static THREAD_LOCAL ym3438_t ym3438;
+static THREAD_LOCAL int ym3438_accm[24][2];
+static THREAD_LOCAL int ym3438_sample[2];
+static THREAD_LOCAL unsigned int ym3438_cycles;
 
 void YM3438_Reset(void)
 {
   OPN2_Reset(&ym3438);
 }
 
-void YM3438_Update(int *buffer, int length)
+static void ym3438_clock(ym3438_t *chip, int accm[24][2], int sample[2], unsigned int *cycles, int *buffer, int length)
 {
   int i, j;
   for (i = 0; i < length; i++)
   {
-    OPN2_Clock(&ym3438, ym3438_accm[ym3438_cycles]);
-    ym3438_cycles = (ym3438_cycles + 1) % 24;
-    if (ym3438_cycles == 0)
+    OPN2_Clock(chip, accm[*cycles]);
+    *cycles = (*cycles + 1) % 24;
+    if (*cycles == 0)
     {
-      ym3438_sample[0] = 0;
-      ym3438_sample[1] = 0;
+      sample[0] = 0;
+      sample[1] = 0;
       for (j = 0; j < 24; j++)
       {
-        ym3438_sample[0] += ym3438_accm[j][0];
-        ym3438_sample[1] += ym3438_accm[j][1];
+        sample[0] += accm[j][0];
+        sample[1] += accm[j][1];
       }
     }
-    *buffer++ = ym3438_sample[0] * 8;
-    *buffer++ = ym3438_sample[1] * 8;
+    *buffer++ = sample[0] * 8;
+    *buffer++ = sample[1] * 8;
   }
 }
 
+void YM3438_Update(int *buffer, int length)
+{
+  ym3438_clock(&ym3438, ym3438_accm, ym3438_sample, &ym3438_cycles, buffer, length);
+}
+
 void YM3438_Write(unsigned int a, unsigned int v)
 {
   OPN2_Write(&ym3438, a, v);
@@ -103,6 +119,289 @@ unsigned int YM3438_Read(unsigned int a)
 {
   return OPN2_Read(&ym3438, a);
 }
+
+#ifdef USE_YM3438_THREAD
+/* Chip events queue (must be a power of two) */
+#define YM3438_QUEUE_SIZE 0x1000
+
+/* Polling iterations before a waiting thread goes to sleep (multi-core CPU only) */
+#define YM3438_SPIN 4000
+
+/* Pending events needed to wake up a sleeping YM3438 thread */
+#define YM3438_BATCH 64
+
+/* Chip events */
+#define YM3438_SYNC  0
+#define YM3438_WRITE 1
+#define YM3438_RESET 2
+
+typedef struct
+{
+  unsigned int time;      /* FM buffer position (in samples) */
+  uint8 type;
+  uint8 address;
+  uint8 data;
+} t_ym3438_event;
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t work;    /* signaled when events are queued */
+  pthread_cond_t done;    /* signaled when events are processed */
+  t_ym3438_event queue[YM3438_QUEUE_SIZE];
+  unsigned int head;      /* next queued event (written by emulation thread only) */
+  unsigned int tail;      /* next processed event (written by YM3438 thread only) */
+  int sleeping;           /* YM3438 thread waiting for events */
+  int waiting;            /* emulation thread waiting for YM3438 thread */
+  unsigned int pending;   /* pending events count the emulation thread is waiting for */
+  int quit;
+  int spin;               /* polling iterations before sleeping */
+  unsigned int time;      /* YM3438 thread FM buffer position (in samples) */
+
+  /* emulation thread chip state & FM output buffer */
+  ym3438_t *chip;
+  int (*accm)[2];
+  int *sample;
+  unsigned int *cycles;
+  int *buffer;
+} t_ym3438_thread;
+
+static THREAD_LOCAL t_ym3438_thread *ym3438_thread;
+
+static void *ym3438_thread_main(void *arg)
+{
+  t_ym3438_thread *yt = (t_ym3438_thread *)arg;
+  t_ym3438_event *event;
+  unsigned int tail = yt->tail;
+  int i;
+
+  while (1)
+  {
+    /* wait for queued events */
+    for (i = 0; (i < yt->spin) && (__atomic_load_n(&yt->head, __ATOMIC_SEQ_CST) == tail); i++);
+    if (__atomic_load_n(&yt->head, __ATOMIC_SEQ_CST) == tail)
+    {
+      pthread_mutex_lock(&yt->lock);
+      __atomic_store_n(&yt->sleeping, 1, __ATOMIC_SEQ_CST);
+      while ((__atomic_load_n(&yt->head, __ATOMIC_SEQ_CST) == tail) && !yt->quit)
+      {
+        pthread_cond_wait(&yt->work, &yt->lock);
+      }
+      __atomic_store_n(&yt->sleeping, 0, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&yt->lock);
+
+      if (yt->quit)
+      {
+        return NULL;
+      }
+    }
+
+    event = &yt->queue[tail & (YM3438_QUEUE_SIZE - 1)];
+
+    /* run chip until event time */
+    if (event->time > yt->time)
+    {
+      ym3438_clock(yt->chip, yt->accm, yt->sample, yt->cycles, yt->buffer + (yt->time << 1), event->time - yt->time);
+      yt->time = event->time;
+    }
+
+    switch (event->type)
+    {
+      case YM3438_WRITE:
+        OPN2_Write(yt->chip, event->address, event->data);
+        break;
+
+      case YM3438_RESET:
+        OPN2_Reset(yt->chip);
+        break;
+    }
+
+    /* event processed */
+    __atomic_store_n(&yt->tail, ++tail, __ATOMIC_SEQ_CST);
+
+    /* wake up emulation thread if needed */
+    if (__atomic_load_n(&yt->waiting, __ATOMIC_SEQ_CST) && ((__atomic_load_n(&yt->head, __ATOMIC_SEQ_CST) - tail) <= yt->pending))
+    {
+      pthread_mutex_lock(&yt->lock);
+      pthread_cond_signal(&yt->done);
+      pthread_mutex_unlock(&yt->lock);
+    }
+  }
+}
+
+/* Wait until no more than the specified number of events are pending */
+static void ym3438_thread_wait(unsigned int pending)
+{
+  t_ym3438_thread *yt = ym3438_thread;
+  int i;
+
+  for (i = 0; (i < yt->spin) && ((yt->head - __atomic_load_n(&yt->tail, __ATOMIC_SEQ_CST)) > pending); i++);
+  if ((yt->head - __atomic_load_n(&yt->tail, __ATOMIC_SEQ_CST)) > pending)
+  {
+    pthread_mutex_lock(&yt->lock);
+    pthread_cond_signal(&yt->work);
+    yt->pending = pending;
+    __atomic_store_n(&yt->waiting, 1, __ATOMIC_SEQ_CST);
+    while ((yt->head - __atomic_load_n(&yt->tail, __ATOMIC_SEQ_CST)) > pending)
+    {
+      pthread_cond_wait(&yt->done, &yt->lock);
+    }
+    __atomic_store_n(&yt->waiting, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&yt->lock);
+  }
+}
+
+static void ym3438_thread_push(int type, unsigned int address, unsigned int data)
+{
+  t_ym3438_thread *yt = ym3438_thread;
+  t_ym3438_event *event;
+
+  /* wait for free entries if queue is full */
+  if ((yt->head - __atomic_load_n(&yt->tail, __ATOMIC_SEQ_CST)) == YM3438_QUEUE_SIZE)
+  {
+    ym3438_thread_wait(YM3438_QUEUE_SIZE / 2);
+  }
+
+  /* event is timestamped with current FM buffer position */
+  event = &yt->queue[yt->head & (YM3438_QUEUE_SIZE - 1)];
+  event->time = (fm_ptr - fm_buffer) >> 1;
+  event->type = type;
+  event->address = address;
+  event->data = data;
+  __atomic_store_n(&yt->head, yt->head + 1, __ATOMIC_SEQ_CST);
+
+  /* wake up YM3438 thread once enough events are pending */
+  if (__atomic_load_n(&yt->sleeping, __ATOMIC_SEQ_CST) && ((yt->head - __atomic_load_n(&yt->tail, __ATOMIC_SEQ_CST)) >= YM3438_BATCH))
+  {
+    pthread_mutex_lock(&yt->lock);
+    pthread_cond_signal(&yt->work);
+    pthread_mutex_unlock(&yt->lock);
+  }
+}
+
+/* Wait until FM buffer is filled up to current position */
+static void ym3438_thread_sync(void)
+{
+  ym3438_thread_push(YM3438_SYNC, 0, 0);
+  ym3438_thread_wait(0);
+}
+
+static void YM3438_Reset_Async(void)
+{
+  ym3438_thread_push(YM3438_RESET, 0, 0);
+}
+
+static void YM3438_Update_Async(int *buffer, int length)
+{
+  /* FM buffer is filled by YM3438 thread */
+}
+
+static void YM3438_Write_Async(unsigned int a, unsigned int v)
+{
+  ym3438_thread_push(YM3438_WRITE, a, v);
+}
+
+static unsigned int YM3438_Read_Async(unsigned int a)
+{
+  /* chip status must be up to date */
+  ym3438_thread_sync();
+  return OPN2_Read(&ym3438, a);
+}
+
+static void ym3438_thread_attach(void)
+{
+  YM_Reset = YM3438_Reset_Async;
+  YM_Update = YM3438_Update_Async;
+  YM_Write = YM3438_Write_Async;
+  YM_Read = YM3438_Read_Async;
+}
+
+int ym3438_thread_init(void)
+{
+  t_ym3438_thread *yt;
+
+  /* Nuked OPN2 core only */
+  if (ym3438_thread || (YM_Update != YM3438_Update))
+  {
+    return 0;
+  }
+
+  yt = (t_ym3438_thread *)calloc(1, sizeof(t_ym3438_thread));
+  if (!yt)
+  {
+    return 0;
+  }
+
+  yt->chip = &ym3438;
+  yt->accm = ym3438_accm;
+  yt->sample = ym3438_sample;
+  yt->cycles = &ym3438_cycles;
+  yt->buffer = fm_buffer;
+  yt->time = (fm_ptr - fm_buffer) >> 1;
+
+  /* polling is only useful if both threads can run concurrently */
+#ifdef _SC_NPROCESSORS_ONLN
+  if (sysconf(_SC_NPROCESSORS_ONLN) > 1)
+  {
+    yt->spin = YM3438_SPIN;
+  }
+#endif
+
+  pthread_mutex_init(&yt->lock, NULL);
+  pthread_cond_init(&yt->work, NULL);
+  pthread_cond_init(&yt->done, NULL);
+
+  if (pthread_create(&yt->thread, NULL, ym3438_thread_main, yt))
+  {
+    pthread_cond_destroy(&yt->done);
+    pthread_cond_destroy(&yt->work);
+    pthread_mutex_destroy(&yt->lock);
+    free(yt);
+    return 0;
+  }
+
+  ym3438_thread = yt;
+
+  /* chip is now accessed through YM3438 thread */
+  ym3438_thread_attach();
+  return 1;
+}
+
+void ym3438_thread_shutdown(void)
+{
+  t_ym3438_thread *yt = ym3438_thread;
+
+  if (!yt)
+  {
+    return;
+  }
+
+  /* wait for pending events */
+  ym3438_thread_wait(0);
+
+  pthread_mutex_lock(&yt->lock);
+  yt->quit = 1;
+  pthread_cond_signal(&yt->work);
+  pthread_mutex_unlock(&yt->lock);
+  pthread_join(yt->thread, NULL);
+
+  pthread_cond_destroy(&yt->done);
+  pthread_cond_destroy(&yt->work);
+  pthread_mutex_destroy(&yt->lock);
+  free(yt);
+  ym3438_thread = NULL;
+
+  /* chip is now accessed directly */
+  if (YM_Update == YM3438_Update_Async)
+  {
+    YM_Reset = YM3438_Reset;
+    YM_Update = YM3438_Update;
+    YM_Write = YM3438_Write;
+    YM_Read = YM3438_Read;
+  }
+}
+#endif
 #endif
 
 /* Run FM chip until required M-cycles */
@@ -113,19 +412,56 @@ INLINE void fm_update(unsigned int cycles)
     /* number of samples to run */
     unsigned int samples = (cycles - fm_cycles_count + fm_cycles_ratio - 1) / fm_cycles_ratio;
 
-    /* run FM chip to sample buffer */
-    YM_Update(fm_ptr, samples);
+    timing_begin(TIMING_FM);
+    if (snd.skip && YM_Skip)
+    {
+      /* only update FM chip state when there is no audio output */
+      YM_Skip(samples);
+    }
+    else
+    {
+      /* run FM chip to sample buffer */
+      YM_Update(fm_ptr, samples);
 
-    /* update FM buffer pointer */
-    fm_ptr += (samples << 1);
+      /* update FM buffer pointer */
+      fm_ptr += (samples << 1);
+    }
+    timing_end();
 
     /* update FM cycle counter */
     fm_cycles_count += samples * fm_cycles_ratio;
   }
 }
 
+#ifdef USE_DYNAMIC_ALLOC
+int sound_alloc(void)
+{
+  /* allocate FM output buffer if required */
+  if (!fm_buffer)
+  {
+    fm_buffer = (int *)malloc(FM_BUFFER_SIZE * sizeof(int));
+  }
+
+  return (fm_buffer != NULL);
+}
+
+void sound_free(void)
+{
+  free(fm_buffer);
+  fm_buffer = NULL;
+}
+#endif
+
 void sound_init( void )
 {
+#ifdef USE_YM3438_THREAD
+  /* wait for pending YM3438 events */
+  if (ym3438_thread)
+  {
+    ym3438_thread_wait(0);
+  }
+#endif
+
   /* Initialize FM chip */
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
@@ -139,9 +475,18 @@ void sound_init( void )
       memset(&ym3438_accm, 0, sizeof(ym3438_accm));
       YM_Reset = YM3438_Reset;
       YM_Update = YM3438_Update;
+      YM_Skip = NULL; /* operators are always clocked together with timers & envelope generators */
       YM_Write = YM3438_Write;
       YM_Read = YM3438_Read;
 
+#ifdef USE_YM3438_THREAD
+      /* chip is accessed through YM3438 thread */
+      if (ym3438_thread)
+      {
+        ym3438_thread_attach();
+      }
+#endif
+
       /* chip is running at VCLK / 6 = MCLK / 7 / 6 */
       fm_cycles_ratio = 6 * 7;
     }
@@ -153,6 +498,7 @@ void sound_init( void )
       YM2612Config(config.dac_bits);
       YM_Reset = YM2612ResetChip;
       YM_Update = YM2612Update;
+      YM_Skip = YM2612Skip;
       YM_Write = YM2612Write;
       YM_Read = YM2612Read;
 
@@ -166,6 +512,7 @@ void sound_init( void )
     YM2413Init();
     YM_Reset = YM2413ResetChip;
     YM_Update = YM2413Update;
+    YM_Skip = NULL;
     YM_Write = YM2413Write;
     YM_Read = NULL;
 
@@ -173,8 +520,28 @@ void sound_init( void )
     fm_cycles_ratio = 72 * 15;
   }
 
+  /* native-rate output stream (one sample per FM chip output) */
+  audio_stream_set_ratio(AUDIO_STREAM_FM, fm_cycles_ratio);
+
   /* Initialize PSG chip */
   psg_init((system_hw == SYSTEM_SG) ? PSG_DISCRETE : PSG_INTEGRATED);
+
+  /* snapshot areas (FM output buffer is flushed at the end of each frame) */
+  snapshot_var(fm_last);
+  snapshot_var(fm_ptr);
+  snapshot_var(fm_cycles_ratio);
+  snapshot_var(fm_cycles_start);
+  snapshot_var(fm_cycles_count);
+  snapshot_var(YM_Reset);
+  snapshot_var(YM_Update);
+  snapshot_var(YM_Write);
+  snapshot_var(YM_Read);
+#ifdef HAVE_YM3438_CORE
+  snapshot_var(ym3438);
+  snapshot_var(ym3438_accm);
+  snapshot_var(ym3438_sample);
+  snapshot_var(ym3438_cycles);
+#endif
 }
 
 void sound_reset(void)
@@ -192,11 +559,22 @@ void sound_reset(void)
   
   /* reset FM cycle counters */
   fm_cycles_start = fm_cycles_count = 0;
+
+#ifdef USE_YM3438_THREAD
+  /* reset YM3438 thread FM buffer position */
+  if (ym3438_thread)
+  {
+    ym3438_thread_wait(0);
+    ym3438_thread->time = 0;
+  }
+#endif
 }
 
 int sound_update(unsigned int cycles)
 {
-  int prev_l, prev_r, preamp, time, l, r, *ptr;
+  int prev_l, prev_r, preamp, time, l, r, i, samples;
+
+  timing_begin(TIMING_SOUND);
 
   /* Run PSG chip until end of frame */
   psg_end_frame(cycles);
@@ -204,6 +582,15 @@ int sound_update(unsigned int cycles)
   /* Run FM chip until end of frame */
   fm_update(cycles);
 
+#ifdef USE_YM3438_THREAD
+  /* wait for FM buffer to be filled by YM3438 thread */
+  if (YM_Update == YM3438_Update_Async)
+  {
+    ym3438_thread_sync();
+    ym3438_thread->time = 0;
+  }
+#endif
+
   /* FM output pre-amplification */
   preamp = config.fm_preamp;
 
@@ -214,45 +601,45 @@ int sound_update(unsigned int cycles)
   prev_l = fm_last[0];
   prev_r = fm_last[1];
 
-  /* FM buffer start pointer */
-  ptr = fm_buffer;
+  /* number of FM samples until end of frame (at least one) */
+  samples = (time < cycles) ? ((cycles - time + fm_cycles_ratio - 1) / fm_cycles_ratio) : 1;
 
-  /* flush FM samples */
-  if (config.hq_fm)
+  /* FM outputs are discarded when there is no audio output (see audio_set_skip) */
+  if (!snd.skip)
   {
-    /* high-quality Band-Limited synthesis */
-    do
+    /* convert FM outputs to left & right channels variations */
+    for (i=0; i<(samples << 1); i+=2)
     {
-      /* left & right channels */
-      l = ((*ptr++ * preamp) / 100);
-      r = ((*ptr++ * preamp) / 100);
-      blip_add_delta(snd.blips[0], time, l-prev_l, r-prev_r);
+      l = ((fm_buffer[i] * preamp) / 100);
+      r = ((fm_buffer[i+1] * preamp) / 100);
+      fm_buffer[i] = l - prev_l;
+      fm_buffer[i+1] = r - prev_r;
       prev_l = l;
       prev_r = r;
-
-      /* increment time counter */
-      time += fm_cycles_ratio;
     }
-    while (time < cycles);
-  }
-  else
-  {
-    /* faster Linear Interpolation */
-    do
-    {
-      /* left & right channels */
-      l = ((*ptr++ * preamp) / 100);
-      r = ((*ptr++ * preamp) / 100);
-      blip_add_delta_fast(snd.blips[0], time, l-prev_l, r-prev_r);
-      prev_l = l;
-      prev_r = r;
 
-      /* increment time counter */
-      time += fm_cycles_ratio;
+    /* native-rate output stream */
+    audio_stream_add_deltas(AUDIO_STREAM_FM, time, fm_cycles_ratio, fm_buffer, samples);
+
+    /* flush FM samples, unless host-rate output is not needed */
+    if (!audio_stream_only)
+    {
+      if (config.hq_fm)
+      {
+        /* high-quality Band-Limited synthesis */
+        blip_add_deltas_uniform(snd.blips[0], time, fm_cycles_ratio, fm_buffer, samples);
+      }
+      else
+      {
+        /* faster Linear Interpolation */
+        blip_add_deltas_uniform_fast(snd.blips[0], time, fm_cycles_ratio, fm_buffer, samples);
+      }
     }
-    while (time < cycles);
   }
 
+  /* increment time counter */
+  time += samples * fm_cycles_ratio;
+
   /* reset FM buffer pointer */
   fm_ptr = fm_buffer;
 
@@ -265,6 +652,9 @@ int sound_update(unsigned int cycles)
 
   /* end of blip buffer time frame */
   blip_end_frame(snd.blips[0], cycles);
+  audio_stream_end_frame(AUDIO_STREAM_FM, cycles);
+
+  timing_end();
 
   /* return number of available samples */
   return blip_samples_avail(snd.blips[0]);
@@ -273,6 +663,14 @@ int sound_update(unsigned int cycles)
 int sound_context_save(uint8 *state)
 {
   int bufferptr = 0;
+
+#ifdef USE_YM3438_THREAD
+  /* wait for pending YM3438 events */
+  if (ym3438_thread)
+  {
+    ym3438_thread_wait(0);
+  }
+#endif
   
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
@@ -311,6 +709,14 @@ int sound_context_load(uint8 *state)
   int bufferptr = 0;
   uint8 config_ym3438;
 
+#ifdef USE_YM3438_THREAD
+  /* wait for pending YM3438 events */
+  if (ym3438_thread)
+  {
+    ym3438_thread_wait(0);
+  }
+#endif
+
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
     #ifdef HAVE_YM3438_CORE
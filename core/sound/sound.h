@@ -49,5 +49,22 @@ extern int sound_update(unsigned int cycles);
 extern void fm_reset(unsigned int cycles);
 extern void fm_write(unsigned int cycles, unsigned int address, unsigned int data);
 extern unsigned int fm_read(unsigned int cycles, unsigned int address);
+#ifdef USE_DYNAMIC_ALLOC
+extern int sound_alloc(void);
+extern void sound_free(void);
+#endif
+
+#ifdef USE_YM3438_THREAD
+#ifndef HAVE_YM3438_CORE
+#error "USE_YM3438_THREAD requires HAVE_YM3438_CORE"
+#endif
+
+/* Nuked OPN2 core running on a separate thread: FM register writes are   */
+/* timestamped and queued, FM samples being generated by the YM3438 thread */
+/* which only waits for the emulation thread when FM status is read or at */
+/* the end of the frame. Output is identical to synchronous emulation.    */
+extern int ym3438_thread_init(void);
+extern void ym3438_thread_shutdown(void);
+#endif
 
 #endif /* _SOUND_H_ */
@@ -496,13 +496,13 @@ static unsigned char table[19][8] = {
   {0x05, 0x01, 0x00, 0x00, 0xf8, 0xba, 0x49, 0x55 },/* TOM(multi,env verified), TOP CYM(multi verified, env verified) */
 };
 
-static signed int output[2];
+static THREAD_LOCAL signed int output[2];
 
-static UINT32  LFO_AM;
-static INT32  LFO_PM;
+static THREAD_LOCAL UINT32  LFO_AM;
+static THREAD_LOCAL INT32  LFO_PM;
 
 /* emulated chip */
-static YM2413 ym2413;
+static THREAD_LOCAL YM2413 ym2413;
 
 /* advance LFO to next sample */
 INLINE void advance_lfo(void)
@@ -1598,6 +1598,12 @@ void YM2413Init(void)
 
   /* init global tables */
   OPLL_initalize();
+
+  /* snapshot areas */
+  snapshot_var(ym2413);
+  snapshot_var(output);
+  snapshot_var(LFO_AM);
+  snapshot_var(LFO_PM);
 }
 
 void YM2413ResetChip(void)
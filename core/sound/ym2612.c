@@ -618,13 +618,13 @@ typedef struct
 } YM2612;
 
 /* emulated chip */
-static YM2612 ym2612;
+static THREAD_LOCAL YM2612 ym2612;
 
 /* current chip state */
-static INT32  m2,c1,c2;   /* Phase Modulation input for operators 2,3,4 */
-static INT32  mem;        /* one sample delay memory */
-static INT32  out_fm[8];  /* outputs of working channels */
-static UINT32 bitmask;    /* working channels output bitmasking (DAC quantization) */ 
+static THREAD_LOCAL INT32  m2,c1,c2;   /* Phase Modulation input for operators 2,3,4 */
+static THREAD_LOCAL INT32  mem;        /* one sample delay memory */
+static THREAD_LOCAL INT32  out_fm[8];  /* outputs of working channels */
+static THREAD_LOCAL UINT32 bitmask;    /* working channels output bitmasking (DAC quantization) */ 
 
 
 INLINE void FM_KEYON(FM_CH *CH , int s )
@@ -1890,6 +1890,15 @@ void YM2612Init(void)
 {
   memset(&ym2612,0,sizeof(YM2612));
   init_tables();
+
+  /* snapshot areas */
+  snapshot_var(ym2612);
+  snapshot_var(m2);
+  snapshot_var(c1);
+  snapshot_var(c2);
+  snapshot_var(mem);
+  snapshot_var(out_fm);
+  snapshot_var(bitmask);
 }
 
 /* reset OPN registers */
@@ -1986,13 +1995,9 @@ unsigned int YM2612Read(unsigned int a)
   return ym2612.OPN.ST.status & 0xff;
 }
 
-/* Generate samples for ym2612 */
-void YM2612Update(int *buffer, int length)
+/* refresh PG increments and EG rates if required */
+INLINE void refresh_fc_eg_channels(void)
 {
-  int i;
-  int lt,rt;
-
-  /* refresh PG increments and EG rates if required */
   refresh_fc_eg_chan(&ym2612.CH[0]);
   refresh_fc_eg_chan(&ym2612.CH[1]);
 
@@ -2015,6 +2020,16 @@ void YM2612Update(int *buffer, int length)
   refresh_fc_eg_chan(&ym2612.CH[3]);
   refresh_fc_eg_chan(&ym2612.CH[4]);
   refresh_fc_eg_chan(&ym2612.CH[5]);
+}
+
+/* Generate samples for ym2612 */
+void YM2612Update(int *buffer, int length)
+{
+  int i;
+  int lt,rt;
+
+  /* refresh PG increments and EG rates if required */
+  refresh_fc_eg_channels();
 
   /* buffering */
   for(i=0; i < length ; i++)
@@ -2111,6 +2126,57 @@ void YM2612Update(int *buffer, int length)
   INTERNAL_TIMER_B(length);
 }
 
+/* Same as YM2612Update, except that operators output is not calculated: */
+/* only timers, LFO and envelope generators are updated.                 */
+void YM2612Skip(int length)
+{
+  int i;
+
+  /* refresh PG increments and EG rates if required */
+  refresh_fc_eg_channels();
+
+  for(i=0; i < length ; i++)
+  {
+    /* update SSG-EG output */
+    update_ssg_eg_channels(&ym2612.CH[0]);
+
+    /* advance LFO */
+    advance_lfo();
+
+    /* advance envelope generator */
+    ym2612.OPN.eg_timer ++;
+
+    /* EG is updated every 3 samples */
+    if (ym2612.OPN.eg_timer >= 3)
+    {
+      ym2612.OPN.eg_timer = 0;
+      ym2612.OPN.eg_cnt++;
+      advance_eg_channels(&ym2612.CH[0], ym2612.OPN.eg_cnt);
+    }
+
+    /* CSM mode: if CSM Key ON has occured, CSM Key OFF need to be sent       */
+    /* only if Timer A does not overflow again (i.e CSM Key ON not set again) */
+    ym2612.OPN.SL3.key_csm <<= 1;
+
+    /* timer A control */
+    INTERNAL_TIMER_A();
+
+    /* CSM Mode Key ON still disabled */
+    if (ym2612.OPN.SL3.key_csm & 2)
+    {
+      /* CSM Mode Key OFF (verified by Nemesis on real hardware) */
+      FM_KEYOFF_CSM(&ym2612.CH[2],SLOT1);
+      FM_KEYOFF_CSM(&ym2612.CH[2],SLOT2);
+      FM_KEYOFF_CSM(&ym2612.CH[2],SLOT3);
+      FM_KEYOFF_CSM(&ym2612.CH[2],SLOT4);
+      ym2612.OPN.SL3.key_csm = 0;
+    }
+  }
+
+  /* timer B control */
+  INTERNAL_TIMER_B(length);
+}
+
 void YM2612Config(unsigned char dac_bits)
 {
   int i;
@@ -38,6 +38,23 @@
 
 #include "shared.h"
 
+#define STATE_RAM_MAX 8
+
+/* RAM blocks modified since last delta savestate */
+THREAD_LOCAL uint8 state_dirty[STATE_DIRTY_SIZE];
+
+/* Delta savestate context */
+static THREAD_LOCAL struct
+{
+  uint8 *image;               /* last saved (or loaded) full state */
+  int size;                   /* image size (zero if image is out of sync with emulated hardware) */
+  uint8 *ptr;                 /* current delta output position (NULL outside of delta savestates) */
+  int run;                    /* start of image area not yet copied to delta output */
+  int count;                  /* number of RAM areas saved so far */
+  uint8 *ram[STATE_RAM_MAX];  /* RAM areas saved in image */
+  int offset[STATE_RAM_MAX];  /* position of RAM areas in image */
+} delta;
+
 int state_load(unsigned char *state)
 {
   int i, bufferptr = 0;
@@ -203,14 +220,14 @@ int state_save(unsigned char *state)
   /* GENESIS */
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
-    save_param(work_ram, sizeof(work_ram));
-    save_param(zram, sizeof(zram));
+    save_ram(work_ram, sizeof(work_ram));
+    save_ram(zram, sizeof(zram));
     save_param(&zstate, sizeof(zstate));
     save_param(&zbank, sizeof(zbank));
   }
   else
   {
-    save_param(work_ram, 0x2000);
+    save_ram(work_ram, 0x2000);
   }
 
   /* IO */
@@ -281,3 +298,212 @@ int state_save(unsigned char *state)
   /* return total size */
   return bufferptr;
 }
+
+/* copy pending image area to delta output */
+static void state_delta_flush(int end)
+{
+  uint32 offset = delta.run;
+  uint32 length = end - delta.run;
+
+  if (length)
+  {
+    memcpy(delta.ptr, &offset, 4);
+    memcpy(delta.ptr + 4, &length, 4);
+    memcpy(delta.ptr + 8, delta.image + offset, length);
+    delta.ptr += (8 + length);
+  }
+}
+
+int state_save_ram(unsigned char *state, unsigned char *ram, int size)
+{
+  int offset, next;
+
+  /* full copy, unless RAM area was previously saved at the same position of an up-to-date image */
+  if (!delta.ptr || !delta.size || (delta.count >= STATE_RAM_MAX) ||
+      (delta.ram[delta.count] != ram) || (delta.offset[delta.count] != (state - delta.image)))
+  {
+    memcpy(state, ram, size);
+  }
+  else
+  {
+    for (offset = 0; offset < size; offset = next)
+    {
+      /* end of current 1KB block */
+      next = offset + (1 << STATE_BLOCK_SHIFT) - ((size_t)(ram + offset) & ((1 << STATE_BLOCK_SHIFT) - 1));
+      if (next > size)
+      {
+        next = size;
+      }
+
+      if (state_dirty[((size_t)(ram + offset) >> STATE_BLOCK_SHIFT) & (STATE_DIRTY_SIZE - 1)])
+      {
+        /* modified block is updated in image */
+        memcpy(state + offset, ram + offset, next - offset);
+      }
+      else
+      {
+        /* unmodified block is excluded from delta output */
+        state_delta_flush(state + offset - delta.image);
+        delta.run = state + next - delta.image;
+      }
+    }
+  }
+
+  /* keep track of RAM areas saved in image */
+  if (delta.ptr && (delta.count < STATE_RAM_MAX))
+  {
+    delta.ram[delta.count] = ram;
+    delta.offset[delta.count++] = state - delta.image;
+  }
+
+  return size;
+}
+
+void state_mark_dirty(unsigned char *ram, int size)
+{
+  int offset;
+
+  for (offset = 0; offset < size; offset += (1 << STATE_BLOCK_SHIFT))
+  {
+    MARK_STATE_DIRTY(ram + offset);
+  }
+
+  MARK_STATE_DIRTY(ram + size - 1);
+}
+
+void state_delta_reset(void)
+{
+  /* next delta savestate will hold full state */
+  delta.size = 0;
+}
+
+void state_delta_shutdown(void)
+{
+  free(delta.image);
+  memset(&delta, 0, sizeof(delta));
+}
+
+/* Delta savestate format:                                                  */
+/*  "DLT!" + full state size (4 bytes) + full state flag (4 bytes)           */
+/*  followed by (offset, length, data) records updating previous full state, */
+/*  terminated by a zero-length record.                                      */
+/* Deltas must be loaded in the same order they were saved, starting from    */
+/* a delta holding full state.                                               */
+int state_save_delta(unsigned char *state)
+{
+  uint32 size, full;
+  int bufferptr;
+
+  /* allocate full state image on first use */
+  if (!delta.image)
+  {
+    delta.image = malloc(STATE_SIZE);
+    if (!delta.image)
+    {
+      return 0;
+    }
+    delta.size = 0;
+  }
+
+  /* delta savestate holds full state if image is out of sync */
+  full = !delta.size;
+
+  /* update image, copying modified areas to delta output */
+  delta.ptr = state + 12;
+  delta.run = 0;
+  delta.count = 0;
+  size = state_save(delta.image);
+  state_delta_flush(size);
+
+  /* check if state layout changed (hardware configuration modified) */
+  if (!full && (size != delta.size))
+  {
+    delta.ptr = NULL;
+    delta.size = 0;
+    return state_save_delta(state);
+  }
+
+  /* end of delta */
+  memset(delta.ptr, 0, 8);
+  bufferptr = delta.ptr + 8 - state;
+  delta.ptr = NULL;
+
+  /* delta header */
+  memcpy(state, "DLT!", 4);
+  memcpy(state + 4, &size, 4);
+  memcpy(state + 8, &full, 4);
+
+  /* image is now up-to-date */
+  delta.size = size;
+  memset(state_dirty, 0, sizeof(state_dirty));
+
+  return bufferptr;
+}
+
+int state_load_delta(unsigned char *state)
+{
+  uint32 size, full, offset, length;
+  int bufferptr = 0;
+
+  /* signature check */
+  char id[4];
+  load_param(id, 4);
+  if (memcmp(id, "DLT!", 4))
+  {
+    return 0;
+  }
+
+  load_param(&size, 4);
+  load_param(&full, 4);
+  if (size > STATE_SIZE)
+  {
+    return 0;
+  }
+
+  /* allocate full state image on first use */
+  if (!delta.image)
+  {
+    delta.image = malloc(STATE_SIZE);
+    if (!delta.image)
+    {
+      return 0;
+    }
+    delta.size = 0;
+  }
+
+  /* partial delta can only be applied to the image it was generated from */
+  if (!full && (delta.size != size))
+  {
+    return 0;
+  }
+
+  /* update image */
+  load_param(&offset, 4);
+  load_param(&length, 4);
+  while (length)
+  {
+    if ((offset + length) > size)
+    {
+      delta.size = 0;
+      return 0;
+    }
+    memcpy(delta.image + offset, &state[bufferptr], length);
+    bufferptr += length;
+    load_param(&offset, 4);
+    load_param(&length, 4);
+  }
+
+  /* restore full state from image */
+  if (!state_load(delta.image))
+  {
+    delta.size = 0;
+    return 0;
+  }
+
+  /* image is now up-to-date (RAM areas will be fully saved on next delta savestate) */
+  delta.size = size;
+  memset(delta.ram, 0, sizeof(delta.ram));
+  memset(state_dirty, 0, sizeof(state_dirty));
+
+  return bufferptr;
+}
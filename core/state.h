@@ -50,8 +50,30 @@
   memcpy(&state[bufferptr], param, size); \
   bufferptr+= size;
 
+/* RAM areas written with save_ram are only copied when modified during delta savestates */
+#define save_ram(param, size) \
+  bufferptr+= state_save_ram(&state[bufferptr], param, size);
+
+/* Delta savestates */
+/* RAM modifications are tracked by blocks of 1KB, indexed by host address */
+#define STATE_BLOCK_SHIFT 10
+#define STATE_DIRTY_SIZE  0x1000
+#define STATE_DELTA_SIZE  (STATE_SIZE + (STATE_SIZE >> 6) + 0x100)
+
+#define MARK_STATE_DIRTY(ptr) \
+  state_dirty[((size_t)(ptr) >> STATE_BLOCK_SHIFT) & (STATE_DIRTY_SIZE - 1)] = 1
+
+/* Global variables */
+extern THREAD_LOCAL uint8 state_dirty[STATE_DIRTY_SIZE];
+
 /* Function prototypes */
 extern int state_load(unsigned char *state);
 extern int state_save(unsigned char *state);
+extern int state_load_delta(unsigned char *state);
+extern int state_save_delta(unsigned char *state);
+extern int state_save_ram(unsigned char *state, unsigned char *ram, int size);
+extern void state_mark_dirty(unsigned char *ram, int size);
+extern void state_delta_reset(void);
+extern void state_delta_shutdown(void);
 
 #endif
@@ -42,18 +42,24 @@
 #include "shared.h"
 #include "eq.h"
 
+/* SSE2 is always available on x86-64 */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAVE_SSE2_EQ
+#include <emmintrin.h>
+#endif
+
 /* Global variables */
-t_bitmap bitmap;
-t_snd snd;
-uint32 mcycles_vdp;
-uint8 system_hw;
-uint8 system_bios;
-uint32 system_clock;
-int16 SVP_cycles = 800; 
-
-static uint8 pause_b;
-static EQSTATE eq[2];
-static int16 llp,rrp;
+THREAD_LOCAL t_bitmap bitmap;
+THREAD_LOCAL t_snd snd;
+THREAD_LOCAL uint32 mcycles_vdp;
+THREAD_LOCAL uint8 system_hw;
+THREAD_LOCAL uint8 system_bios;
+THREAD_LOCAL uint32 system_clock;
+THREAD_LOCAL int16 SVP_cycles = 800; 
+
+static THREAD_LOCAL uint8 pause_b;
+static THREAD_LOCAL EQSTATE eq[2];
+static THREAD_LOCAL int16 llp,rrp;
 
 /******************************************************************************************/
 /* Audio subsystem                                                                        */
@@ -130,6 +136,10 @@ void audio_set_rate(int samplerate, double framerate)
   /* resampled to desired rate at the end of each frame, using Blip Buffer.            */
   blip_set_rates(snd.blips[0], mclk, samplerate);
 
+  /* FM & PSG native-rate output streams use the same timebase */
+  audio_stream_set_clock(AUDIO_STREAM_FM, mclk);
+  audio_stream_set_clock(AUDIO_STREAM_PSG, mclk);
+
   /* Mega CD sound hardware */
   if (system_hw == SYSTEM_MCD)
   {
@@ -161,6 +171,9 @@ void audio_reset(void)
     }
   }
 
+  /* Clear native-rate output streams */
+  audio_stream_reset();
+
   /* Low-Pass filter */
   llp = 0;
   rrp = 0;
@@ -190,27 +203,215 @@ void audio_shutdown(void)
   }
 }
 
-int audio_update(int16 *buffer)
+/* Apply low-pass filter or 3-band EQ, then mono mixing, in a single pass over output buffer */
+void audio_filter(int16 *buffer, int samples, int filter, int mono)
 {
+  int16 *out = buffer;
+  int32 l, r;
+
+  if (samples <= 0)
+  {
+    return;
+  }
+
+  if (filter & 1)
+  {
+    /* single-pole low-pass filter (6 dB/octave) */
+    uint32 factora  = config.lp_range;
+    uint32 factorb  = 0x10000 - factora;
+
+    /* restore previous sample */
+    l = llp;
+    r = rrp;
+
+    do
+    {
+      /* apply low-pass filter */
+      l = l*factora + out[0]*factorb;
+      r = r*factora + out[1]*factorb;
+
+      /* 16.16 fixed point */
+      l >>= 16;
+      r >>= 16;
+
+      /* update sound buffer */
+      if (mono)
+      {
+        out[0] = out[1] = ((int16)l + (int16)r) / 2;
+      }
+      else
+      {
+        out[0] = l;
+        out[1] = r;
+      }
+      out += 2;
+    }
+    while (--samples);
+
+    /* save last samples for next frame */
+    llp = l;
+    rrp = r;
+  }
+  else if (filter & 2)
+  {
+#ifdef HAVE_SSE2_EQ
+    /* 3 Band EQ of both channels (low lane: left channel, high lane: right channel) */
+    const __m128d vsa = _mm_set1_pd(1.0 / 4294967295.0); /* see eq.c */
+    const __m128d lf = _mm_set_pd(eq[1].lf, eq[0].lf);
+    const __m128d hf = _mm_set_pd(eq[1].hf, eq[0].hf);
+    const __m128d lg = _mm_set_pd(eq[1].lg, eq[0].lg);
+    const __m128d mg = _mm_set_pd(eq[1].mg, eq[0].mg);
+    const __m128d hg = _mm_set_pd(eq[1].hg, eq[0].hg);
+    __m128d f1p0 = _mm_set_pd(eq[1].f1p0, eq[0].f1p0);
+    __m128d f1p1 = _mm_set_pd(eq[1].f1p1, eq[0].f1p1);
+    __m128d f1p2 = _mm_set_pd(eq[1].f1p2, eq[0].f1p2);
+    __m128d f1p3 = _mm_set_pd(eq[1].f1p3, eq[0].f1p3);
+    __m128d f2p0 = _mm_set_pd(eq[1].f2p0, eq[0].f2p0);
+    __m128d f2p1 = _mm_set_pd(eq[1].f2p1, eq[0].f2p1);
+    __m128d f2p2 = _mm_set_pd(eq[1].f2p2, eq[0].f2p2);
+    __m128d f2p3 = _mm_set_pd(eq[1].f2p3, eq[0].f2p3);
+    __m128d sdm1 = _mm_set_pd(eq[1].sdm1, eq[0].sdm1);
+    __m128d sdm2 = _mm_set_pd(eq[1].sdm2, eq[0].sdm2);
+    __m128d sdm3 = _mm_set_pd(eq[1].sdm3, eq[0].sdm3);
+
+    do
+    {
+      __m128d sample = _mm_cvtepi32_pd(_mm_set_epi32(0, 0, out[1], out[0]));
+      __m128d low, mid, high;
+      int32 pair;
+
+      /* Filter #1 (lowpass) */
+      f1p0 = _mm_add_pd(f1p0, _mm_add_pd(_mm_mul_pd(lf, _mm_sub_pd(sample, f1p0)), vsa));
+      f1p1 = _mm_add_pd(f1p1, _mm_mul_pd(lf, _mm_sub_pd(f1p0, f1p1)));
+      f1p2 = _mm_add_pd(f1p2, _mm_mul_pd(lf, _mm_sub_pd(f1p1, f1p2)));
+      f1p3 = _mm_add_pd(f1p3, _mm_mul_pd(lf, _mm_sub_pd(f1p2, f1p3)));
+      low = f1p3;
+
+      /* Filter #2 (highpass) */
+      f2p0 = _mm_add_pd(f2p0, _mm_add_pd(_mm_mul_pd(hf, _mm_sub_pd(sample, f2p0)), vsa));
+      f2p1 = _mm_add_pd(f2p1, _mm_mul_pd(hf, _mm_sub_pd(f2p0, f2p1)));
+      f2p2 = _mm_add_pd(f2p2, _mm_mul_pd(hf, _mm_sub_pd(f2p1, f2p2)));
+      f2p3 = _mm_add_pd(f2p3, _mm_mul_pd(hf, _mm_sub_pd(f2p2, f2p3)));
+      high = _mm_sub_pd(sdm3, f2p3);
+
+      /* midrange */
+      mid = _mm_sub_pd(sample, _mm_add_pd(high, low));
+
+      /* shuffle history buffer */
+      sdm3 = sdm2;
+      sdm2 = sdm1;
+      sdm1 = sample;
+
+      /* scale, combine & clip (16-bit samples) */
+      low = _mm_add_pd(_mm_add_pd(_mm_mul_pd(low, lg), _mm_mul_pd(mid, mg)), _mm_mul_pd(high, hg));
+      pair = _mm_cvtsi128_si32(_mm_packs_epi32(_mm_cvttpd_epi32(low), _mm_setzero_si128()));
+      l = (int16)(pair & 0xffff);
+      r = (int16)(pair >> 16);
+
+      /* update sound buffer */
+      if (mono)
+      {
+        out[0] = out[1] = (l + r) / 2;
+      }
+      else
+      {
+        out[0] = l;
+        out[1] = r;
+      }
+      out += 2;
+    }
+    while (--samples);
+
+    /* save filters state for next frame */
+    _mm_storel_pd(&eq[0].f1p0, f1p0); _mm_storeh_pd(&eq[1].f1p0, f1p0);
+    _mm_storel_pd(&eq[0].f1p1, f1p1); _mm_storeh_pd(&eq[1].f1p1, f1p1);
+    _mm_storel_pd(&eq[0].f1p2, f1p2); _mm_storeh_pd(&eq[1].f1p2, f1p2);
+    _mm_storel_pd(&eq[0].f1p3, f1p3); _mm_storeh_pd(&eq[1].f1p3, f1p3);
+    _mm_storel_pd(&eq[0].f2p0, f2p0); _mm_storeh_pd(&eq[1].f2p0, f2p0);
+    _mm_storel_pd(&eq[0].f2p1, f2p1); _mm_storeh_pd(&eq[1].f2p1, f2p1);
+    _mm_storel_pd(&eq[0].f2p2, f2p2); _mm_storeh_pd(&eq[1].f2p2, f2p2);
+    _mm_storel_pd(&eq[0].f2p3, f2p3); _mm_storeh_pd(&eq[1].f2p3, f2p3);
+    _mm_storel_pd(&eq[0].sdm1, sdm1); _mm_storeh_pd(&eq[1].sdm1, sdm1);
+    _mm_storel_pd(&eq[0].sdm2, sdm2); _mm_storeh_pd(&eq[1].sdm2, sdm2);
+    _mm_storel_pd(&eq[0].sdm3, sdm3); _mm_storeh_pd(&eq[1].sdm3, sdm3);
+#else
+    do
+    {
+      /* 3 Band EQ */
+      l = do_3band(&eq[0],out[0]);
+      r = do_3band(&eq[1],out[1]);
+
+      /* clipping (16-bit samples) */
+      if (l > 32767) l = 32767;
+      else if (l < -32768) l = -32768;
+      if (r > 32767) r = 32767;
+      else if (r < -32768) r = -32768;
+
+      /* update sound buffer */
+      if (mono)
+      {
+        out[0] = out[1] = (l + r) / 2;
+      }
+      else
+      {
+        out[0] = l;
+        out[1] = r;
+      }
+      out += 2;
+    }
+    while (--samples);
+#endif
+  }
+  else if (mono)
+  {
+    do
+    {
+      out[0] = out[1] = (out[0] + out[1]) / 2;
+      out += 2;
+    }
+    while (--samples);
+  }
+}
+
+static int audio_frame(int16 *buffer)
+{
+  int size;
+
+  /* resampling & filtering, unless timed by another subsystem */
+  timing_begin(TIMING_AUDIO);
+
   /* run sound chips until end of frame */
-  int size = sound_update(mcycles_vdp);
+  size = sound_update(mcycles_vdp);
 
   /* Mega CD specific */
   if (system_hw == SYSTEM_MCD)
   {
+    timing_begin(TIMING_CD);
+
     /* sync PCM chip with other sound chips */
     pcm_update(size);
 
     /* read CDDA samples */
     cdd_read_audio(size);
 
+    timing_end();
+
 #ifdef ALIGN_SND
     /* return an aligned number of samples if required */
     size &= ALIGN_SND;
 #endif
 
-    /* resample & mix FM/PSG, PCM & CD-DA streams to output buffer */
-    blip_mix_samples(snd.blips[0], snd.blips[1], snd.blips[2], buffer, size);
+    if (!buffer)
+    {
+      /* no audio output: drop PCM & CD-DA streams */
+      blip_discard_samples(snd.blips[1], size);
+      blip_discard_samples(snd.blips[2], size);
+    }
+    else
+    {
+      /* resample & mix FM/PSG, PCM & CD-DA streams to output buffer */
+      blip_mix_samples(snd.blips[0], snd.blips[1], snd.blips[2], buffer, size);
+    }
   }
   else
   {
@@ -219,88 +420,62 @@ int audio_update(int16 *buffer)
     size &= ALIGN_SND;
 #endif
 
-    /* resample FM/PSG mixed stream to output buffer */
-    blip_read_samples(snd.blips[0], buffer, size);
+    if (buffer)
+    {
+      /* resample FM/PSG mixed stream to output buffer */
+      blip_read_samples(snd.blips[0], buffer, size);
+    }
   }
 
-  /* Audio filtering */
-  if (config.filter)
+  if (!buffer)
   {
-    int samples = size;
-    int16 *out = buffer;
-    int32 l, r;
+    /* no audio output: FM/PSG stream only advances resampler time */
+    blip_discard_samples(snd.blips[0], size);
+    timing_end();
+    return 0;
+  }
 
-    if (config.filter & 1)
-    {
-      /* single-pole low-pass filter (6 dB/octave) */
-      uint32 factora  = config.lp_range;
-      uint32 factorb  = 0x10000 - factora;
+  /* Audio filtering & mono output mixing */
+  audio_filter(buffer, size, config.filter, config.mono);
 
-      /* restore previous sample */
-      l = llp;
-      r = rrp;
+#ifdef LOGSOUND
+  error("%d samples returned\n\n",size);
+#endif
 
-      do
-      {
-        /* apply low-pass filter */
-        l = l*factora + out[0]*factorb;
-        r = r*factora + out[1]*factorb;
+  timing_end();
+  return size;
+}
 
-        /* 16.16 fixed point */
-        l >>= 16;
-        r >>= 16;
+int audio_update(int16 *buffer)
+{
+  /* sound chips were already run at the end of emulated frame */
+  if (snd.skip)
+  {
+    return 0;
+  }
 
-        /* update sound buffer */
-        *out++ = l;
-        *out++ = r;
-      }
-      while (--samples);
+  return audio_frame(buffer);
+}
 
-      /* save last samples for next frame */
-      llp = l;
-      rrp = r;
-    }
-    else if (config.filter & 2)
-    {
-      do
-      {
-        /* 3 Band EQ */
-        l = do_3band(&eq[0],out[0]);
-        r = do_3band(&eq[1],out[1]);
-
-        /* clipping (16-bit samples) */
-        if (l > 32767) l = 32767;
-        else if (l < -32768) l = -32768;
-        if (r > 32767) r = 32767;
-        else if (r < -32768) r = -32768;
-
-        /* update sound buffer */
-        *out++ = l;
-        *out++ = r;
-      }
-      while (--samples);
-    }
+void audio_set_skip(int skip)
+{
+  if (snd.skip == skip)
+  {
+    return;
   }
 
-  /* Mono output mixing */
-  if (config.mono)
+  snd.skip = skip;
+
+  /* restart audio output from silence */
+  if (!skip)
   {
-    int16 out;
-    int samples = size;
-    do
+    blip_clear(snd.blips[0]);
+    if (snd.blips[1])
     {
-      out = (buffer[0] + buffer[1]) / 2;
-      *buffer++ = out;
-      *buffer++ = out;
+      blip_clear(snd.blips[1]);
+      blip_clear(snd.blips[2]);
     }
-    while (--samples);
   }
-
-#ifdef LOGSOUND
-  error("%d samples returned\n\n",size);
-#endif
-
-  return size;
 }
 
 /****************************************************************
@@ -313,6 +488,10 @@ void system_init(void)
   vdp_init();
   render_init();
   sound_init();
+
+  /* snapshot areas */
+  snapshot_var(mcycles_vdp);
+  snapshot_var(pause_b);
 }
 
 void system_reset(void)
@@ -323,13 +502,134 @@ void system_reset(void)
   vdp_reset();
   sound_reset();
   audio_reset();
+
+  /* emulated hardware state is no longer in sync with delta savestates */
+  state_delta_reset();
+}
+
+/* Vertical Blanking line events (Genesis mode) */
+static void gen_vblank_line(int line, int start, int end)
+{
+  /* update VCounter */
+  v_counter = line;
+
+  /* render overscan */
+  if ((line < end) || (line >= start))
+  {
+    blank_line(line, -bitmap.viewport.x, bitmap.viewport.w + 2*bitmap.viewport.x);
+  }
+
+  /* update 6-Buttons & Lightguns */
+  input_refresh();
+}
+
+/* Active Display line events (Genesis mode) */
+static void gen_active_line(int line, int do_skip)
+{
+  /* update VCounter */
+  v_counter = line;
+
+  /* run VDP DMA */
+  if (dma_length)
+  {
+    vdp_dma_update(mcycles_vdp);
+  }
+
+  /* render scanline */
+  if (!do_skip)
+  {
+    render_line(line);
+  }
+
+  /* update 6-Buttons & Lightguns */
+  input_refresh();
+
+  /* H-Int counter */
+  if (h_counter == 0)
+  {
+    /* reload H-Int counter */
+    h_counter = reg[10];
+    
+    /* Horizontal Interrupt is pending */
+    hint_pending = 0x10;
+    if (reg[0] & 0x10)
+    {
+      /* level 4 interrupt */
+      m68k_update_irq(4);
+    }
+  }
+  else
+  {
+    /* decrement H-Int counter */
+    h_counter--;
+  }
 }
 
+#ifdef USE_EVENT_SCHEDULER
+/* Genesis mode event scheduler
+ *
+ * Each line is normally emulated in lock-step: the 68k, Z80 and SVP are run
+ * until the end of the line, then VDP events of the next line are processed.
+ * When the Z80 is stopped or halted and there is no SVP, the 68k is the only
+ * running CPU: next line events are then processed from the 68k execution loop
+ * (see m68k_set_event_callback), between the same two 68k instructions as in
+ * lock-step, so emulation output is unchanged. A halted Z80 can only resume
+ * on interrupt, reset or bus request, which are all resynchronization points
+ * (see gen_zbusreq_w & gen_zreset_w), so it is run up to the 68k once lock-step
+ * is resumed.
+ */
+static THREAD_LOCAL struct
+{
+  int line;     /* current line */
+  int last;     /* last line of scheduled area */
+  int active;   /* scheduled area is Active Display */
+  int start;    /* Vertical Blanking overscan area */
+  int end;
+  int do_skip;  /* Active Display rendering is disabled */
+} sched;
+
+static unsigned int gen_line_event(void)
+{
+  /* leave 68k execution loop at end of scheduled area or when other CPUs are running */
+  if ((sched.line >= sched.last) || svp || ((zstate == 1) && !Z80.halt))
+  {
+    return 0;
+  }
+
+  /* Z80 cycle count follows 68k when Z80 is stopped */
+  if (zstate != 1)
+  {
+    Z80.cycles = mcycles_vdp + MCYCLES_PER_LINE;
+  }
+
+  /* update VDP cycle count */
+  mcycles_vdp += MCYCLES_PER_LINE;
+
+  /* process next line events */
+  sched.line++;
+  if (sched.active)
+  {
+    gen_active_line(sched.line, sched.do_skip);
+  }
+  else
+  {
+    gen_vblank_line(sched.line, sched.start, sched.end);
+  }
+
+  /* run 68k until end of line */
+  return mcycles_vdp + MCYCLES_PER_LINE;
+}
+#endif
+
 void system_frame_gen(int do_skip)
 {
   /* line counters */
   int start, end, line;
 
+  /* frame timing (CPU emulation unless timed by another subsystem) */
+  timing_frame();
+  timing_begin(TIMING_CPU);
+
   /* reset frame cycle counter */
   mcycles_vdp = 0;
 
@@ -517,23 +817,29 @@ void system_frame_gen(int do_skip)
   start = lines_per_frame - bitmap.viewport.y;
   end = bitmap.viewport.h + bitmap.viewport.y;
 
+#ifdef USE_EVENT_SCHEDULER
+  /* next Vertical Blanking lines can be processed from 68k execution loop */
+  sched.last = lines_per_frame - 2;
+  sched.active = 0;
+  sched.start = start;
+  sched.end = end;
+  m68k_set_event_callback(gen_line_event);
+#endif
+
   /* Vertical Blanking */
   do
   {
-    /* update VCounter */
-    v_counter = line;
-
-    /* render overscan */
-    if ((line < end) || (line >= start))
-    {
-      blank_line(line, -bitmap.viewport.x, bitmap.viewport.w + 2*bitmap.viewport.x);
-    }
-
-    /* update 6-Buttons & Lightguns */
-    input_refresh();
+    /* line events */
+    gen_vblank_line(line, start, end);
 
     /* run 68k & Z80 until end of line */
+#ifdef USE_EVENT_SCHEDULER
+    sched.line = line;
+    m68k_run(mcycles_vdp + MCYCLES_PER_LINE);
+    line = sched.line;
+#else
     m68k_run(mcycles_vdp + MCYCLES_PER_LINE);
+#endif
     if (zstate == 1)
     {
       z80_run(mcycles_vdp + MCYCLES_PER_LINE);
@@ -553,6 +859,10 @@ void system_frame_gen(int do_skip)
     mcycles_vdp += MCYCLES_PER_LINE;
   }
   while (++line < (lines_per_frame - 1));
+
+#ifdef USE_EVENT_SCHEDULER
+  m68k_set_event_callback(NULL);
+#endif
   
   /* update VCounter */
   v_counter = line;
@@ -578,6 +888,13 @@ void system_frame_gen(int do_skip)
   /* parse first line of sprites */
   if (reg[1] & 0x40)
   {
+#ifdef USE_RENDER_THREAD
+    if (render_thread_active)
+    {
+      render_thread_push(RENDER_SATB, -1, 0, 0);
+    }
+    else
+#endif
     parse_satb(-1);
   }
 
@@ -606,50 +923,29 @@ void system_frame_gen(int do_skip)
 
   /* reset line count */
   line = 0;
+
+#ifdef USE_EVENT_SCHEDULER
+  /* next Active Display lines can be processed from 68k execution loop */
+  sched.last = bitmap.viewport.h - 1;
+  sched.active = 1;
+  sched.do_skip = do_skip;
+  m68k_set_event_callback(gen_line_event);
+#endif
   
   /* Active Display */
   do
   {
-    /* update VCounter */
-    v_counter = line;
-
-    /* run VDP DMA */
-    if (dma_length)
-    {
-      vdp_dma_update(mcycles_vdp);
-    }
-
-    /* render scanline */
-    if (!do_skip)
-    {
-      render_line(line);
-    }
-
-    /* update 6-Buttons & Lightguns */
-    input_refresh();
-
-    /* H-Int counter */
-    if (h_counter == 0)
-    {
-      /* reload H-Int counter */
-      h_counter = reg[10];
-      
-      /* Horizontal Interrupt is pending */
-      hint_pending = 0x10;
-      if (reg[0] & 0x10)
-      {
-        /* level 4 interrupt */
-        m68k_update_irq(4);
-      }
-    }
-    else
-    {
-      /* decrement H-Int counter */
-      h_counter--;
-    }
+    /* line events */
+    gen_active_line(line, do_skip);
 
     /* run 68k & Z80 until end of line */
+#ifdef USE_EVENT_SCHEDULER
+    sched.line = line;
     m68k_run(mcycles_vdp + MCYCLES_PER_LINE);
+    line = sched.line;
+#else
+    m68k_run(mcycles_vdp + MCYCLES_PER_LINE);
+#endif
     if (zstate == 1)
     {
       z80_run(mcycles_vdp + MCYCLES_PER_LINE);
@@ -670,6 +966,10 @@ void system_frame_gen(int do_skip)
   }
   while (++line < bitmap.viewport.h);
 
+#ifdef USE_EVENT_SCHEDULER
+  m68k_set_event_callback(NULL);
+#endif
+
   /* check viewport changes */
   if (bitmap.viewport.w != bitmap.viewport.ow)
   {
@@ -677,10 +977,28 @@ void system_frame_gen(int do_skip)
     bitmap.viewport.changed |= 1;
   }
 
+#ifdef USE_RENDER_THREAD
+  /* wait for all lines to be rendered */
+  if (render_thread_active)
+  {
+    timing_begin(TIMING_RENDER);
+    render_thread_sync();
+    timing_end();
+  }
+#endif
+
   /* adjust timings for next frame */
   input_end_frame(mcycles_vdp);
   m68k.cycles -= mcycles_vdp;
   Z80.cycles -= mcycles_vdp;
+
+  /* run sound chips without audio output (see audio_set_skip) */
+  if (snd.skip)
+  {
+    audio_frame(NULL);
+  }
+
+  timing_end();
 }
 
 void system_frame_scd(int do_skip)
@@ -688,6 +1006,10 @@ void system_frame_scd(int do_skip)
   /* line counters */
   int start, end, line;
 
+  /* frame timing (CPU emulation unless timed by another subsystem) */
+  timing_frame();
+  timing_begin(TIMING_CPU);
+
   /* reset frame cycle counter */
   mcycles_vdp = 0;
   scd.cycles = 0;
@@ -929,6 +1251,13 @@ void system_frame_scd(int do_skip)
   /* parse first line of sprites */
   if (reg[1] & 0x40)
   {
+#ifdef USE_RENDER_THREAD
+    if (render_thread_active)
+    {
+      render_thread_push(RENDER_SATB, -1, 0, 0);
+    }
+    else
+#endif
     parse_satb(-1);
   }
 
@@ -1020,11 +1349,29 @@ void system_frame_scd(int do_skip)
     bitmap.viewport.changed |= 1;
   }
   
+#ifdef USE_RENDER_THREAD
+  /* wait for all lines to be rendered */
+  if (render_thread_active)
+  {
+    timing_begin(TIMING_RENDER);
+    render_thread_sync();
+    timing_end();
+  }
+#endif
+
   /* adjust timings for next frame */
   scd_end_frame(scd.cycles);
   input_end_frame(mcycles_vdp);
   m68k.cycles -= mcycles_vdp;
   Z80.cycles -= mcycles_vdp;
+
+  /* run sound chips without audio output (see audio_set_skip) */
+  if (snd.skip)
+  {
+    audio_frame(NULL);
+  }
+
+  timing_end();
 }
 
 void system_frame_sms(int do_skip)
@@ -1032,6 +1379,10 @@ void system_frame_sms(int do_skip)
   /* line counter */
   int start, end, line;
 
+  /* frame timing (CPU emulation unless timed by another subsystem) */
+  timing_frame();
+  timing_begin(TIMING_CPU);
+
   /* reset frame cycle count */
   mcycles_vdp = 0;
 
@@ -1429,4 +1780,12 @@ void system_frame_sms(int do_skip)
   /* adjust timings for next frame */
   input_end_frame(mcycles_vdp);
   Z80.cycles -= mcycles_vdp;
+
+  /* run sound chips without audio output (see audio_set_skip) */
+  if (snd.skip)
+  {
+    audio_frame(NULL);
+  }
+
+  timing_end();
 }
@@ -91,18 +91,19 @@ typedef struct
   int sample_rate;      /* Output Sample rate (8000-48000) */
   double frame_rate;    /* Output Frame rate (usually 50 or 60 frames per second) */
   int enabled;          /* 1= sound emulation is enabled */
+  int skip;             /* 1= sound chips are run without audio output */
   blip_t* blips[3];     /* Blip Buffer resampling (stereo) */
 } t_snd;
 
 
 /* Global variables */
-extern t_bitmap bitmap;
-extern t_snd snd;
-extern uint32 mcycles_vdp;
-extern int16 SVP_cycles; 
-extern uint8 system_hw;
-extern uint8 system_bios;
-extern uint32 system_clock;
+extern THREAD_LOCAL t_bitmap bitmap;
+extern THREAD_LOCAL t_snd snd;
+extern THREAD_LOCAL uint32 mcycles_vdp;
+extern THREAD_LOCAL int16 SVP_cycles; 
+extern THREAD_LOCAL uint8 system_hw;
+extern THREAD_LOCAL uint8 system_bios;
+extern THREAD_LOCAL uint32 system_clock;
 
 /* Function prototypes */
 extern int audio_init(int samplerate, double framerate);
@@ -110,7 +111,9 @@ extern void audio_set_rate(int samplerate, double framerate);
 extern void audio_reset(void);
 extern void audio_shutdown(void);
 extern int audio_update(int16 *buffer);
+extern void audio_filter(int16 *buffer, int samples, int filter, int mono);
 extern void audio_set_equalizer(void);
+extern void audio_set_skip(int skip);
 extern void system_init(void);
 extern void system_reset(void);
 extern void system_frame_gen(int do_skip);
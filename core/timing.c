@@ -0,0 +1,290 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Frame timing instrumentation
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#define TIMING_RDTSC
+#endif
+
+#include <time.h>
+
+#include "shared.h"
+
+/* maximal scopes nesting */
+#define TIMING_DEPTH 8
+
+typedef unsigned long long timing_ticks_t;
+
+/* Frame timing context */
+static THREAD_LOCAL struct
+{
+  timing_ticks_t frame[TIMING_COUNT];                 /* ticks spent in current frame */
+  timing_ticks_t window[TIMING_COUNT][TIMING_WINDOW]; /* ticks spent in most recent frames */
+  int count;                                          /* number of frames in window */
+  int pos;                                            /* next frame position in window */
+  int depth;                                          /* number of open scopes */
+  int id[TIMING_DEPTH];                               /* open scopes subsystem */
+  timing_ticks_t start[TIMING_DEPTH];                 /* open scopes start time */
+  timing_ticks_t nested[TIMING_DEPTH];                /* ticks spent in nested scopes */
+  timing_ticks_t base_ticks;                          /* ticks count when timing was enabled */
+  double base_time;                                   /* host time (seconds) when timing was enabled */
+} timing;
+
+THREAD_LOCAL int timing_enabled;
+
+static const char *timing_names[TIMING_COUNT] = {"cpu", "render", "sound", "fm", "cd", "audio", "frame"};
+
+/* monotonic host time, in seconds */
+static double get_time(void)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER count, freq;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  return (double)count.QuadPart / (double)freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* timing scopes use the cheapest available counter */
+static timing_ticks_t get_ticks(void)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER count;
+  QueryPerformanceCounter(&count);
+  return count.QuadPart;
+#elif defined(TIMING_RDTSC)
+  return __rdtsc();
+#else
+  return (timing_ticks_t)(get_time() * 1000000000.0);
+#endif
+}
+
+/* number of ticks per microsecond (measured since timing was enabled) */
+static double get_tick_rate(void)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER freq;
+  QueryPerformanceFrequency(&freq);
+  return (double)freq.QuadPart / 1000000.0;
+#elif defined(TIMING_RDTSC)
+  double elapsed = get_time() - timing.base_time;
+  if (elapsed <= 0.0) return 0.0;
+  return (double)(get_ticks() - timing.base_ticks) / (elapsed * 1000000.0);
+#else
+  return 1000.0;
+#endif
+}
+
+void timing_enable(int enable)
+{
+  if (enable && !timing_enabled)
+  {
+    timing_reset();
+  }
+
+  timing_enabled = enable;
+}
+
+void timing_reset(void)
+{
+  memset(&timing, 0, sizeof(timing));
+  timing.base_time = get_time();
+  timing.base_ticks = get_ticks();
+}
+
+void timing_frame(void)
+{
+  int i;
+
+  if (!timing_enabled)
+  {
+    return;
+  }
+
+  /* nothing was timed since previous frame */
+  if (!timing.frame[TIMING_CPU])
+  {
+    return;
+  }
+
+  /* whole frame */
+  timing.frame[TIMING_FRAME] = 0;
+  for (i=0; i<TIMING_FRAME; i++)
+  {
+    timing.frame[TIMING_FRAME] += timing.frame[i];
+  }
+
+  for (i=0; i<TIMING_COUNT; i++)
+  {
+    timing.window[i][timing.pos] = timing.frame[i];
+    timing.frame[i] = 0;
+  }
+
+  timing.pos = (timing.pos + 1) % TIMING_WINDOW;
+  if (timing.count < TIMING_WINDOW)
+  {
+    timing.count++;
+  }
+}
+
+void timing_push(int id)
+{
+  if (timing.depth < TIMING_DEPTH)
+  {
+    timing.id[timing.depth] = id;
+    timing.start[timing.depth] = get_ticks();
+    timing.nested[timing.depth] = 0;
+  }
+
+  timing.depth++;
+}
+
+void timing_pop(void)
+{
+  timing_ticks_t elapsed;
+  int depth;
+
+  /* scope was opened before timing was enabled */
+  if (!timing.depth)
+  {
+    return;
+  }
+
+  depth = --timing.depth;
+  if (depth >= TIMING_DEPTH)
+  {
+    return;
+  }
+
+  elapsed = get_ticks() - timing.start[depth];
+
+  /* time spent in nested scopes is accounted to their own subsystem */
+  timing.frame[timing.id[depth]] += elapsed - timing.nested[depth];
+
+  if (depth > 0)
+  {
+    timing.nested[depth - 1] += elapsed;
+  }
+}
+
+static int compare_ticks(const void *a, const void *b)
+{
+  timing_ticks_t p = *(const timing_ticks_t *)a;
+  timing_ticks_t q = *(const timing_ticks_t *)b;
+  return (p > q) - (p < q);
+}
+
+int timing_stats(int id, t_timing_stats *stats)
+{
+  timing_ticks_t sorted[TIMING_WINDOW];
+  double rate = get_tick_rate();
+  double total = 0.0;
+  int i;
+
+  memset(stats, 0, sizeof(t_timing_stats));
+
+  if ((id < 0) || (id >= TIMING_COUNT) || !timing.count || (rate <= 0.0))
+  {
+    return 0;
+  }
+
+  memcpy(sorted, timing.window[id], timing.count * sizeof(timing_ticks_t));
+  qsort(sorted, timing.count, sizeof(timing_ticks_t), compare_ticks);
+
+  for (i=0; i<timing.count; i++)
+  {
+    double us = (double)sorted[i] / rate;
+    int bucket = 0;
+
+    while ((bucket < (TIMING_BUCKETS - 1)) && (us >= (double)(1 << bucket)))
+    {
+      bucket++;
+    }
+
+    stats->histogram[bucket]++;
+    total += us;
+  }
+
+  stats->frames = timing.count;
+  stats->average = total / timing.count;
+  stats->median = (double)sorted[(timing.count * 50) / 100] / rate;
+  stats->p95 = (double)sorted[(timing.count * 95) / 100] / rate;
+  stats->p99 = (double)sorted[(timing.count * 99) / 100] / rate;
+  stats->maximum = (double)sorted[timing.count - 1] / rate;
+  return 1;
+}
+
+const char *timing_name(int id)
+{
+  if ((id < 0) || (id >= TIMING_COUNT))
+  {
+    return NULL;
+  }
+
+  return timing_names[id];
+}
+
+int timing_summary(char *buffer, int size)
+{
+  t_timing_stats stats;
+  int i, len = 0;
+
+  if (size > 0)
+  {
+    buffer[0] = 0;
+  }
+
+  /* average & 95th percentile per subsystem, in milliseconds (unused subsystems are skipped) */
+  for (i=0; i<TIMING_COUNT; i++)
+  {
+    if (timing_stats(i, &stats) && (stats.maximum > 0.0) && (len < size))
+    {
+      len += snprintf(buffer + len, size - len, "%s%s %.2f/%.2f ms", len ? ", " : "", timing_names[i], stats.average / 1000.0, stats.p95 / 1000.0);
+    }
+  }
+
+  return (len < size) ? len : size - 1;
+}
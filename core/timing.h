@@ -0,0 +1,103 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Frame timing instrumentation
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _TIMING_H_
+#define _TIMING_H_
+
+/* Host time spent by each emulated frame is split between subsystems, using timing      */
+/* scopes placed around line rendering and sound updates (see system.c, sound.c and      */
+/* vdp_render.c). Scopes can be nested: time spent in a nested scope is only accounted   */
+/* to the innermost subsystem, so that per-frame subsystem times add up to frame time.   */
+/*                                                                                       */
+/* Per-frame times of the most recent frames are kept in a rolling window, from which    */
+/* averages, percentiles and histograms are computed on request.                         */
+/*                                                                                       */
+/* Timing is always compiled but disabled by default: disabled scopes only cost a test.  */
+
+/* Timed subsystems */
+#define TIMING_CPU    0   /* CPU & hardware emulation (frame time not spent in other subsystems) */
+#define TIMING_RENDER 1   /* line rendering */
+#define TIMING_SOUND  2   /* PSG update & FM/PSG mixing */
+#define TIMING_FM     3   /* FM chip update */
+#define TIMING_CD     4   /* PCM chip & CD-DA update */
+#define TIMING_AUDIO  5   /* resampling & audio filters */
+#define TIMING_FRAME  6   /* whole frame */
+#define TIMING_COUNT  7
+
+/* number of frames in rolling window */
+#define TIMING_WINDOW 256
+
+/* histogram buckets: bucket 0 counts frames below 1 us, bucket n counts frames from 2^(n-1) to 2^n us */
+#define TIMING_BUCKETS 24
+
+typedef struct
+{
+  int frames;                             /* number of frames in rolling window */
+  double average;                         /* average time per frame (us) */
+  double median;                          /* 50th percentile (us) */
+  double p95;                             /* 95th percentile (us) */
+  double p99;                             /* 99th percentile (us) */
+  double maximum;                         /* maximal time per frame (us) */
+  unsigned int histogram[TIMING_BUCKETS]; /* number of frames per time range */
+} t_timing_stats;
+
+/* Global variables */
+extern THREAD_LOCAL int timing_enabled;
+
+/* Function prototypes */
+extern void timing_enable(int enable);
+extern void timing_reset(void);
+extern void timing_frame(void);
+extern void timing_push(int id);
+extern void timing_pop(void);
+extern int timing_stats(int id, t_timing_stats *stats);
+extern const char *timing_name(int id);
+extern int timing_summary(char *buffer, int size);
+
+/* Timing scopes */
+INLINE void timing_begin(int id)
+{
+  if (timing_enabled) timing_push(id);
+}
+
+INLINE void timing_end(void)
+{
+  if (timing_enabled) timing_pop();
+}
+
+#endif /* _TIMING_H_ */
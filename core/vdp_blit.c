@@ -0,0 +1,366 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Video line blitters
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+/* SSE2 is always available on x86-64 (AVX2 support is detected at runtime) */
+#if !defined(USE_8BPP_RENDERING)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAVE_SSE2_BLIT
+#include <emmintrin.h>
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))))
+#define HAVE_AVX2_BLIT
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON_BLIT
+#include <arm_neon.h>
+#endif
+#endif
+
+/* Output pixel color channels (see vdp_render.h) */
+#if defined(USE_15BPP_RENDERING)
+#define CH1_SHIFT 10
+#define CH1_MASK  0x1f
+#define CH2_SHIFT 5
+#define CH2_MASK  0x1f
+#define CH3_MASK  0x1f
+#define ALPHA     0x8000
+#elif defined(USE_16BPP_RENDERING)
+#define CH1_SHIFT 11
+#define CH1_MASK  0x1f
+#define CH2_SHIFT 5
+#define CH2_MASK  0x3f
+#define CH3_MASK  0x1f
+#define ALPHA     0x0000
+#elif defined(USE_32BPP_RENDERING)
+#define ALPHA     0xff000000
+#endif
+
+/* Function pointers */
+THREAD_LOCAL void (*blit_remap)(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width);
+THREAD_LOCAL void (*blit_remap_lcd)(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width, int rate);
+
+/*--------------------------------------------------------------------------*/
+/* Generic blitters                                                         */
+/*--------------------------------------------------------------------------*/
+
+static void remap_c(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width)
+{
+  /* four pixels per iteration */
+  while (width >= 4)
+  {
+    dst[0] = table[src[0]];
+    dst[1] = table[src[1]];
+    dst[2] = table[src[2]];
+    dst[3] = table[src[3]];
+    src += 4;
+    dst += 4;
+    width -= 4;
+  }
+
+  while (width-- > 0)
+  {
+    *dst++ = table[*src++];
+  }
+}
+
+static void remap_lcd_c(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width, int rate)
+{
+  while (width-- > 0)
+  {
+    RENDER_PIXEL_LCD(src,dst,table,rate);
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+/* SSE2 blitters                                                            */
+/*--------------------------------------------------------------------------*/
+
+#ifdef HAVE_SSE2_BLIT
+
+/* number of pixels per 128-bit vector */
+#define SSE2_PIXELS (16 / sizeof(PIXEL_OUT_T))
+
+#if defined(USE_32BPP_RENDERING)
+
+/* decay is applied to all 8-bit channels at once, alpha channel is restored afterwards */
+INLINE __m128i lcd_blend_sse2(__m128i in, __m128i old, __m128i rate)
+{
+  __m128i decay = _mm_subs_epu8(old, in);
+  __m128i lo = _mm_unpacklo_epi8(decay, _mm_setzero_si128());
+  __m128i hi = _mm_unpackhi_epi8(decay, _mm_setzero_si128());
+  lo = _mm_srli_epi16(_mm_mullo_epi16(lo, rate), 8);
+  hi = _mm_srli_epi16(_mm_mullo_epi16(hi, rate), 8);
+  return _mm_or_si128(_mm_add_epi8(in, _mm_packus_epi16(lo, hi)), _mm_set1_epi32((int)ALPHA));
+}
+
+#else
+
+/* channels are extracted to 16-bit lanes (rate * decay never exceeds 16 bits) */
+#define LCD_CHANNEL_SSE2(out,in,old,rate,shift,mask) \
+{ \
+  __m128i n = _mm_and_si128(_mm_srli_epi16(in, shift), _mm_set1_epi16(mask)); \
+  __m128i o = _mm_and_si128(_mm_srli_epi16(old, shift), _mm_set1_epi16(mask)); \
+  n = _mm_add_epi16(n, _mm_srli_epi16(_mm_mullo_epi16(_mm_subs_epu16(o, n), rate), 8)); \
+  out = _mm_or_si128(out, _mm_slli_epi16(n, shift)); \
+}
+
+INLINE __m128i lcd_blend_sse2(__m128i in, __m128i old, __m128i rate)
+{
+  __m128i out = _mm_set1_epi16((short)ALPHA);
+  LCD_CHANNEL_SSE2(out, in, old, rate, CH1_SHIFT, CH1_MASK);
+  LCD_CHANNEL_SSE2(out, in, old, rate, CH2_SHIFT, CH2_MASK);
+  LCD_CHANNEL_SSE2(out, in, old, rate, 0, CH3_MASK);
+  return out;
+}
+
+#endif
+
+static void remap_lcd_sse2(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width, int rate)
+{
+  PIXEL_OUT_T in[SSE2_PIXELS];
+  __m128i k = _mm_set1_epi16(rate);
+
+  while (width >= (int)SSE2_PIXELS)
+  {
+    /* no gather instruction: new pixels are fetched from color look-up table first */
+    remap_c(in, src, table, SSE2_PIXELS);
+    _mm_storeu_si128((__m128i *)dst, lcd_blend_sse2(_mm_loadu_si128((__m128i *)in), _mm_loadu_si128((__m128i *)dst), k));
+    src += SSE2_PIXELS;
+    dst += SSE2_PIXELS;
+    width -= SSE2_PIXELS;
+  }
+
+  remap_lcd_c(dst, src, table, width, rate);
+}
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+/* AVX2 blitters                                                            */
+/*--------------------------------------------------------------------------*/
+
+#ifdef HAVE_AVX2_BLIT
+
+/* number of pixels per 256-bit vector */
+#define AVX2_PIXELS (32 / sizeof(PIXEL_OUT_T))
+
+#if defined(USE_32BPP_RENDERING)
+
+__attribute__((target("avx2"))) INLINE __m256i gather_avx2(const uint8 *src, const PIXEL_OUT_T *table)
+{
+  __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+  return _mm256_i32gather_epi32((const int *)table, index, 4);
+}
+
+__attribute__((target("avx2"))) INLINE __m256i lcd_blend_avx2(__m256i in, __m256i old, __m256i rate)
+{
+  __m256i decay = _mm256_subs_epu8(old, in);
+  __m256i lo = _mm256_unpacklo_epi8(decay, _mm256_setzero_si256());
+  __m256i hi = _mm256_unpackhi_epi8(decay, _mm256_setzero_si256());
+  lo = _mm256_srli_epi16(_mm256_mullo_epi16(lo, rate), 8);
+  hi = _mm256_srli_epi16(_mm256_mullo_epi16(hi, rate), 8);
+  return _mm256_or_si256(_mm256_add_epi8(in, _mm256_packus_epi16(lo, hi)), _mm256_set1_epi32((int)ALPHA));
+}
+
+#else
+
+/* 16-bit pixels are fetched with 32-bit gathers (color look-up table is padded by one entry) */
+__attribute__((target("avx2"))) INLINE __m256i gather_avx2(const uint8 *src, const PIXEL_OUT_T *table)
+{
+  __m256i mask = _mm256_set1_epi32(0xffff);
+  __m256i lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+  __m256i hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + 8)));
+  lo = _mm256_and_si256(_mm256_i32gather_epi32((const int *)table, lo, 2), mask);
+  hi = _mm256_and_si256(_mm256_i32gather_epi32((const int *)table, hi, 2), mask);
+  return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8);
+}
+
+#define LCD_CHANNEL_AVX2(out,in,old,rate,shift,mask) \
+{ \
+  __m256i n = _mm256_and_si256(_mm256_srli_epi16(in, shift), _mm256_set1_epi16(mask)); \
+  __m256i o = _mm256_and_si256(_mm256_srli_epi16(old, shift), _mm256_set1_epi16(mask)); \
+  n = _mm256_add_epi16(n, _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_subs_epu16(o, n), rate), 8)); \
+  out = _mm256_or_si256(out, _mm256_slli_epi16(n, shift)); \
+}
+
+__attribute__((target("avx2"))) INLINE __m256i lcd_blend_avx2(__m256i in, __m256i old, __m256i rate)
+{
+  __m256i out = _mm256_set1_epi16((short)ALPHA);
+  LCD_CHANNEL_AVX2(out, in, old, rate, CH1_SHIFT, CH1_MASK);
+  LCD_CHANNEL_AVX2(out, in, old, rate, CH2_SHIFT, CH2_MASK);
+  LCD_CHANNEL_AVX2(out, in, old, rate, 0, CH3_MASK);
+  return out;
+}
+
+#endif
+
+__attribute__((target("avx2"))) static void remap_avx2(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width)
+{
+  while (width >= (int)AVX2_PIXELS)
+  {
+    _mm256_storeu_si256((__m256i *)dst, gather_avx2(src, table));
+    src += AVX2_PIXELS;
+    dst += AVX2_PIXELS;
+    width -= AVX2_PIXELS;
+  }
+
+  remap_c(dst, src, table, width);
+}
+
+__attribute__((target("avx2"))) static void remap_lcd_avx2(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width, int rate)
+{
+  __m256i k = _mm256_set1_epi16(rate);
+
+  while (width >= (int)AVX2_PIXELS)
+  {
+    _mm256_storeu_si256((__m256i *)dst, lcd_blend_avx2(gather_avx2(src, table), _mm256_loadu_si256((__m256i *)dst), k));
+    src += AVX2_PIXELS;
+    dst += AVX2_PIXELS;
+    width -= AVX2_PIXELS;
+  }
+
+  remap_lcd_c(dst, src, table, width, rate);
+}
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+/* NEON blitters                                                            */
+/*--------------------------------------------------------------------------*/
+
+#ifdef HAVE_NEON_BLIT
+
+/* number of pixels per 128-bit vector */
+#define NEON_PIXELS (16 / sizeof(PIXEL_OUT_T))
+
+#if defined(USE_32BPP_RENDERING)
+
+INLINE uint32x4_t lcd_blend_neon(uint32x4_t in, uint32x4_t old, uint8x8_t rate)
+{
+  uint8x16_t decay = vqsubq_u8(vreinterpretq_u8_u32(old), vreinterpretq_u8_u32(in));
+  uint8x8_t lo = vshrn_n_u16(vmull_u8(vget_low_u8(decay), rate), 8);
+  uint8x8_t hi = vshrn_n_u16(vmull_u8(vget_high_u8(decay), rate), 8);
+  uint8x16_t out = vaddq_u8(vreinterpretq_u8_u32(in), vcombine_u8(lo, hi));
+  return vorrq_u32(vreinterpretq_u32_u8(out), vdupq_n_u32(ALPHA));
+}
+
+static void remap_lcd_neon(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width, int rate)
+{
+  PIXEL_OUT_T in[NEON_PIXELS];
+  uint8x8_t k = vdup_n_u8(rate);
+
+  while (width >= (int)NEON_PIXELS)
+  {
+    remap_c(in, src, table, NEON_PIXELS);
+    vst1q_u32(dst, lcd_blend_neon(vld1q_u32(in), vld1q_u32(dst), k));
+    src += NEON_PIXELS;
+    dst += NEON_PIXELS;
+    width -= NEON_PIXELS;
+  }
+
+  remap_lcd_c(dst, src, table, width, rate);
+}
+
+#else
+
+/* register shifts are used since immediate right shifts by zero are not encodable */
+#define LCD_CHANNEL_NEON(out,in,old,rate,shift,mask) \
+{ \
+  uint16x8_t n = vandq_u16(vshlq_u16(in, vdupq_n_s16(-(shift))), vdupq_n_u16(mask)); \
+  uint16x8_t o = vandq_u16(vshlq_u16(old, vdupq_n_s16(-(shift))), vdupq_n_u16(mask)); \
+  n = vaddq_u16(n, vshrq_n_u16(vmulq_u16(vqsubq_u16(o, n), rate), 8)); \
+  out = vorrq_u16(out, vshlq_u16(n, vdupq_n_s16(shift))); \
+}
+
+INLINE uint16x8_t lcd_blend_neon(uint16x8_t in, uint16x8_t old, uint16x8_t rate)
+{
+  uint16x8_t out = vdupq_n_u16(ALPHA);
+  LCD_CHANNEL_NEON(out, in, old, rate, CH1_SHIFT, CH1_MASK);
+  LCD_CHANNEL_NEON(out, in, old, rate, CH2_SHIFT, CH2_MASK);
+  LCD_CHANNEL_NEON(out, in, old, rate, 0, CH3_MASK);
+  return out;
+}
+
+static void remap_lcd_neon(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *table, int width, int rate)
+{
+  PIXEL_OUT_T in[NEON_PIXELS];
+  uint16x8_t k = vdupq_n_u16(rate);
+
+  while (width >= (int)NEON_PIXELS)
+  {
+    remap_c(in, src, table, NEON_PIXELS);
+    vst1q_u16(dst, lcd_blend_neon(vld1q_u16(in), vld1q_u16(dst), k));
+    src += NEON_PIXELS;
+    dst += NEON_PIXELS;
+    width -= NEON_PIXELS;
+  }
+
+  remap_lcd_c(dst, src, table, width, rate);
+}
+
+#endif
+
+#endif
+
+/*--------------------------------------------------------------------------*/
+/* Blitters initialization                                                  */
+/*--------------------------------------------------------------------------*/
+
+void blit_init(void)
+{
+  /* generic C blitters */
+  blit_remap = remap_c;
+  blit_remap_lcd = remap_lcd_c;
+
+#if defined(HAVE_SSE2_BLIT)
+  /* color look-up table gathering is only accelerated with AVX2 */
+  blit_remap_lcd = remap_lcd_sse2;
+#if defined(HAVE_AVX2_BLIT)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    blit_remap = remap_avx2;
+    blit_remap_lcd = remap_lcd_avx2;
+  }
+#endif
+#elif defined(HAVE_NEON_BLIT)
+  blit_remap_lcd = remap_lcd_neon;
+#endif
+}
@@ -45,6 +45,7 @@
 /* Mark a pattern as modified */
 #define MARK_BG_DIRTY(addr)                         \
 {                                                   \
+  MARK_STATE_DIRTY(&vram[addr]);                    \
   name = (addr >> 5) & 0x7FF;                       \
   if (bg_name_dirty[name] == 0)                     \
   {                                                 \
@@ -54,49 +55,49 @@
 }
 
 /* VDP context */
-uint8 ALIGNED_(4) sat[0x400];    /* Internal copy of sprite attribute table */
-uint8 ALIGNED_(4) vram[0x10000]; /* Video RAM (64K x 8-bit) */
-uint8 ALIGNED_(4) cram[0x80];    /* On-chip color RAM (64 x 9-bit) */
-uint8 ALIGNED_(4) vsram[0x80];   /* On-chip vertical scroll RAM (40 x 11-bit) */
-uint8 reg[0x20];                 /* Internal VDP registers (23 x 8-bit) */
-uint8 hint_pending;              /* 0= Line interrupt is pending */
-uint8 vint_pending;              /* 1= Frame interrupt is pending */
-uint16 status;                   /* VDP status flags */
-uint32 dma_length;               /* DMA remaining length */
+THREAD_LOCAL uint8 ALIGNED_(4) sat[0x400];    /* Internal copy of sprite attribute table */
+THREAD_LOCAL uint8 ALIGNED_(4) vram[0x10000]; /* Video RAM (64K x 8-bit) */
+THREAD_LOCAL uint8 ALIGNED_(4) cram[0x80];    /* On-chip color RAM (64 x 9-bit) */
+THREAD_LOCAL uint8 ALIGNED_(4) vsram[0x80];   /* On-chip vertical scroll RAM (40 x 11-bit) */
+THREAD_LOCAL uint8 reg[0x20];                 /* Internal VDP registers (23 x 8-bit) */
+THREAD_LOCAL uint8 hint_pending;              /* 0= Line interrupt is pending */
+THREAD_LOCAL uint8 vint_pending;              /* 1= Frame interrupt is pending */
+THREAD_LOCAL uint16 status;                   /* VDP status flags */
+THREAD_LOCAL uint32 dma_length;               /* DMA remaining length */
 
 /* Global variables */
-uint16 ntab;                      /* Name table A base address */
-uint16 ntbb;                      /* Name table B base address */
-uint16 ntwb;                      /* Name table W base address */
-uint16 satb;                      /* Sprite attribute table base address */
-uint16 hscb;                      /* Horizontal scroll table base address */
-uint8 bg_name_dirty[0x800];       /* 1= This pattern is dirty */
-uint16 bg_name_list[0x800];       /* List of modified pattern indices */
-uint16 bg_list_index;             /* # of modified patterns in list */
-uint8 hscroll_mask;               /* Horizontal Scrolling line mask */
-uint8 playfield_shift;            /* Width of planes A, B (in bits) */
-uint8 playfield_col_mask;         /* Playfield column mask */
-uint16 playfield_row_mask;        /* Playfield row mask */
-uint16 vscroll;                   /* Latched vertical scroll value */
-uint8 odd_frame;                  /* 1: odd field, 0: even field */
-uint8 im2_flag;                   /* 1= Interlace mode 2 is being used */
-uint8 interlaced;                 /* 1: Interlaced mode 1 or 2 */
-uint8 vdp_pal;                    /* 1: PAL , 0: NTSC (default) */
-uint8 h_counter;                  /* Horizontal counter */
-uint16 v_counter;                 /* Vertical counter */
-uint16 vc_max;                    /* Vertical counter overflow value */
-uint16 lines_per_frame;           /* PAL: 313 lines, NTSC: 262 lines */
-uint16 max_sprite_pixels;         /* Max. sprites pixels per line (parsing & rendering) */
-int32 fifo_write_cnt;             /* VDP FIFO write count */
-uint32 fifo_slots;                /* VDP FIFO access slot count */
-uint32 hvc_latch;                 /* latched HV counter */
-const uint8 *hctab;               /* pointer to H Counter table */
+THREAD_LOCAL uint16 ntab;                      /* Name table A base address */
+THREAD_LOCAL uint16 ntbb;                      /* Name table B base address */
+THREAD_LOCAL uint16 ntwb;                      /* Name table W base address */
+THREAD_LOCAL uint16 satb;                      /* Sprite attribute table base address */
+THREAD_LOCAL uint16 hscb;                      /* Horizontal scroll table base address */
+THREAD_LOCAL uint8 bg_name_dirty[0x800];       /* 1= This pattern is dirty */
+THREAD_LOCAL uint16 bg_name_list[0x800];       /* List of modified pattern indices */
+THREAD_LOCAL uint16 bg_list_index;             /* # of modified patterns in list */
+THREAD_LOCAL uint8 hscroll_mask;               /* Horizontal Scrolling line mask */
+THREAD_LOCAL uint8 playfield_shift;            /* Width of planes A, B (in bits) */
+THREAD_LOCAL uint8 playfield_col_mask;         /* Playfield column mask */
+THREAD_LOCAL uint16 playfield_row_mask;        /* Playfield row mask */
+THREAD_LOCAL uint16 vscroll;                   /* Latched vertical scroll value */
+THREAD_LOCAL uint8 odd_frame;                  /* 1: odd field, 0: even field */
+THREAD_LOCAL uint8 im2_flag;                   /* 1= Interlace mode 2 is being used */
+THREAD_LOCAL uint8 interlaced;                 /* 1: Interlaced mode 1 or 2 */
+THREAD_LOCAL uint8 vdp_pal;                    /* 1: PAL , 0: NTSC (default) */
+THREAD_LOCAL uint8 h_counter;                  /* Horizontal counter */
+THREAD_LOCAL uint16 v_counter;                 /* Vertical counter */
+THREAD_LOCAL uint16 vc_max;                    /* Vertical counter overflow value */
+THREAD_LOCAL uint16 lines_per_frame;           /* PAL: 313 lines, NTSC: 262 lines */
+THREAD_LOCAL uint16 max_sprite_pixels;         /* Max. sprites pixels per line (parsing & rendering) */
+THREAD_LOCAL int32 fifo_write_cnt;             /* VDP FIFO write count */
+THREAD_LOCAL uint32 fifo_slots;                /* VDP FIFO access slot count */
+THREAD_LOCAL uint32 hvc_latch;                 /* latched HV counter */
+THREAD_LOCAL const uint8 *hctab;               /* pointer to H Counter table */
 
 /* Function pointers */
-void (*vdp_68k_data_w)(unsigned int data);
-void (*vdp_z80_data_w)(unsigned int data);
-unsigned int (*vdp_68k_data_r)(void);
-unsigned int (*vdp_z80_data_r)(void);
+THREAD_LOCAL void (*vdp_68k_data_w)(unsigned int data);
+THREAD_LOCAL void (*vdp_z80_data_w)(unsigned int data);
+THREAD_LOCAL unsigned int (*vdp_68k_data_r)(void);
+THREAD_LOCAL unsigned int (*vdp_z80_data_r)(void);
 
 /* Function prototypes */
 static void vdp_68k_data_w_m4(unsigned int data);
@@ -125,27 +126,27 @@ static const uint8 shift_table[]        = { 6, 7, 0, 8 };
 static const uint8 col_mask_table[]     = { 0x0F, 0x1F, 0x0F, 0x3F };
 static const uint16 row_mask_table[]    = { 0x0FF, 0x1FF, 0x2FF, 0x3FF };
 
-static uint8 border;          /* Border color index */
-static uint8 pending;         /* Pending write flag */
-static uint8 code;            /* Code register */
-static uint8 dma_type;        /* DMA mode */
-static uint16 addr;           /* Address register */
-static uint16 addr_latch;     /* Latched A15, A14 of address */
-static uint16 sat_base_mask;  /* Base bits of SAT */
-static uint16 sat_addr_mask;  /* Index bits of SAT */
-static uint16 dma_src;        /* DMA source address */
-static uint32 dma_endCycles;  /* 68k cycles to DMA end */
-static int dmafill;           /* DMA Fill pending flag */
-static int cached_write;      /* 2nd part of 32-bit CTRL port write (Genesis mode) or LSB of CRAM data (Game Gear mode) */
-static uint16 fifo[4];        /* FIFO ring-buffer */
-static int fifo_idx;          /* FIFO write index */
-static int fifo_byte_access;  /* FIFO byte access flag */
-static uint32 fifo_cycles;    /* FIFO next access cycle */
-static int *fifo_timing;      /* FIFO slots timing table */
+static THREAD_LOCAL uint8 border;          /* Border color index */
+static THREAD_LOCAL uint8 pending;         /* Pending write flag */
+static THREAD_LOCAL uint8 code;            /* Code register */
+static THREAD_LOCAL uint8 dma_type;        /* DMA mode */
+static THREAD_LOCAL uint16 addr;           /* Address register */
+static THREAD_LOCAL uint16 addr_latch;     /* Latched A15, A14 of address */
+static THREAD_LOCAL uint16 sat_base_mask;  /* Base bits of SAT */
+static THREAD_LOCAL uint16 sat_addr_mask;  /* Index bits of SAT */
+static THREAD_LOCAL uint16 dma_src;        /* DMA source address */
+static THREAD_LOCAL uint32 dma_endCycles;  /* 68k cycles to DMA end */
+static THREAD_LOCAL int dmafill;           /* DMA Fill pending flag */
+static THREAD_LOCAL int cached_write;      /* 2nd part of 32-bit CTRL port write (Genesis mode) or LSB of CRAM data (Game Gear mode) */
+static THREAD_LOCAL uint16 fifo[4];        /* FIFO ring-buffer */
+static THREAD_LOCAL int fifo_idx;          /* FIFO write index */
+static THREAD_LOCAL int fifo_byte_access;  /* FIFO byte access flag */
+static THREAD_LOCAL uint32 fifo_cycles;    /* FIFO next access cycle */
+static THREAD_LOCAL int *fifo_timing;      /* FIFO slots timing table */
 
  /* set Z80 or 68k interrupt lines */
-static void (*set_irq_line)(unsigned int level);
-static void (*set_irq_line_delay)(unsigned int level);
+static THREAD_LOCAL void (*set_irq_line)(unsigned int level);
+static THREAD_LOCAL void (*set_irq_line_delay)(unsigned int level);
 
 /* Vertical counter overflow values (see hvc.h) */
 static const uint16 vc_table[4][2] = 
@@ -237,6 +238,62 @@ void vdp_init(void)
     set_irq_line = z80_set_irq_line;
     set_irq_line_delay = z80_set_irq_line;
   }
+
+  /* snapshot areas (VRAM & pattern cache state are handled separately) */
+  snapshot_var(sat);
+  snapshot_var(cram);
+  snapshot_var(vsram);
+  snapshot_var(reg);
+  snapshot_var(hint_pending);
+  snapshot_var(vint_pending);
+  snapshot_var(status);
+  snapshot_var(dma_length);
+  snapshot_var(ntab);
+  snapshot_var(ntbb);
+  snapshot_var(ntwb);
+  snapshot_var(satb);
+  snapshot_var(hscb);
+  snapshot_var(hscroll_mask);
+  snapshot_var(playfield_shift);
+  snapshot_var(playfield_col_mask);
+  snapshot_var(playfield_row_mask);
+  snapshot_var(vscroll);
+  snapshot_var(odd_frame);
+  snapshot_var(im2_flag);
+  snapshot_var(interlaced);
+  snapshot_var(vdp_pal);
+  snapshot_var(h_counter);
+  snapshot_var(v_counter);
+  snapshot_var(vc_max);
+  snapshot_var(lines_per_frame);
+  snapshot_var(max_sprite_pixels);
+  snapshot_var(fifo_write_cnt);
+  snapshot_var(fifo_slots);
+  snapshot_var(hvc_latch);
+  snapshot_var(hctab);
+  snapshot_var(vdp_68k_data_w);
+  snapshot_var(vdp_z80_data_w);
+  snapshot_var(vdp_68k_data_r);
+  snapshot_var(vdp_z80_data_r);
+  snapshot_var(border);
+  snapshot_var(pending);
+  snapshot_var(code);
+  snapshot_var(dma_type);
+  snapshot_var(addr);
+  snapshot_var(addr_latch);
+  snapshot_var(sat_base_mask);
+  snapshot_var(sat_addr_mask);
+  snapshot_var(dma_src);
+  snapshot_var(dma_endCycles);
+  snapshot_var(dmafill);
+  snapshot_var(cached_write);
+  snapshot_var(fifo);
+  snapshot_var(fifo_idx);
+  snapshot_var(fifo_byte_access);
+  snapshot_var(fifo_cycles);
+  snapshot_var(fifo_timing);
+  snapshot_var(set_irq_line);
+  snapshot_var(set_irq_line_delay);
 }
 
 void vdp_reset(void)
@@ -441,7 +498,7 @@ int vdp_context_save(uint8 *state)
   int bufferptr = 0;
 
   save_param(sat, sizeof(sat));
-  save_param(vram, sizeof(vram));
+  save_ram(vram, sizeof(vram));
   save_param(cram, sizeof(cram));
   save_param(vsram, sizeof(vsram));
   save_param(reg, sizeof(reg));
@@ -1151,6 +1208,14 @@ unsigned int vdp_68k_ctrl_r(unsigned int cycles)
 {
   unsigned int temp;
 
+#ifdef USE_RENDER_THREAD
+  /* Sprite overflow & collision flags must be up to date */
+  if (render_thread_active)
+  {
+    render_thread_sync();
+  }
+#endif
+
   /* Cycle-accurate VDP status read (adjust CPU time with current instruction execution time) */
   cycles += m68k_cycles();
 
@@ -1204,6 +1269,27 @@ unsigned int vdp_68k_ctrl_r(unsigned int cycles)
     temp |= 0x04;
   }
 
+#ifdef USE_IDLE_SKIP
+  /* 68k busy-wait loops reading VDP status can be skipped until next HBLANK, VINT or DMA Busy flag change (see m68kcpu.h) */
+  if (!fifo_write_cnt && (!(status & 2) || !dma_length))
+  {
+    unsigned int horizon = cycles - (cycles % MCYCLES_PER_LINE) + (((cycles % MCYCLES_PER_LINE) < 588) ? 588 : MCYCLES_PER_LINE);
+
+    if ((status & 2) && (dma_endCycles < horizon))
+    {
+      horizon = dma_endCycles;
+    }
+
+    if ((v_counter == bitmap.viewport.h) && (cycles < (mcycles_vdp + 788)) && ((mcycles_vdp + 788) < horizon))
+    {
+      horizon = mcycles_vdp + 788;
+    }
+
+    /* adjust with current instruction execution time */
+    m68k.skip.io = horizon - (cycles - m68k.cycles);
+  }
+#endif
+
 #ifdef LOGVDP
   error("[%d(%d)][%d(%d)] VDP 68k status read -> 0x%x (0x%x) (%x)\n", v_counter, (v_counter + (cycles - mcycles_vdp)/MCYCLES_PER_LINE)%lines_per_frame, cycles, cycles%MCYCLES_PER_LINE, temp, status, m68k_get_reg(M68K_REG_PC));
 #endif
@@ -1214,6 +1300,14 @@ unsigned int vdp_z80_ctrl_r(unsigned int cycles)
 {
   unsigned int temp;
 
+#ifdef USE_RENDER_THREAD
+  /* Sprite overflow & collision flags must be up to date */
+  if (render_thread_active)
+  {
+    render_thread_sync();
+  }
+#endif
+
   /* Check if DMA busy flag is set (Mega Drive VDP specific) */
   if (status & 2)
   {
@@ -1576,6 +1670,8 @@ static void vdp_reg_w(unsigned int r, unsigned int d, unsigned int cycles)
               *(uint16 *)(vram + ((i & 0x203F) | ((i >> 6) & 0x40) | ((i << 1) & 0x1F80))) = *(uint16 *)(vram + 0x4000 + i);
             }
           }
+
+          state_mark_dirty(vram, 0x8000);
         }
       }
 
@@ -2925,6 +3021,7 @@ static void vdp_z80_data_w_sg(unsigned int data)
 
   /* VRAM write */
   vram[index] = data;
+  MARK_STATE_DIRTY(&vram[index]);
 
   /* Update address register */
   addr++;
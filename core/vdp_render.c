@@ -43,6 +43,12 @@
 #include "md_ntsc.h"
 #include "sms_ntsc.h"
 
+/* SSE2 is always available on x86-64 */
+#if defined(LSB_FIRST) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define HAVE_SSE2_PATTERN
+#include <emmintrin.h>
+#endif
+
 #ifndef HAVE_NO_SPRITE_LIMIT
 #define MAX_SPRITES_PER_LINE 20
 #define TMS_MAX_SPRITES_PER_LINE 4
@@ -52,18 +58,8 @@
 #endif
 
 /*** NTSC Filters ***/
-extern md_ntsc_t *md_ntsc;
-extern sms_ntsc_t *sms_ntsc;
-
-
-/* Output pixels type*/
-#if defined(USE_8BPP_RENDERING)
-#define PIXEL_OUT_T uint8
-#elif defined(USE_32BPP_RENDERING)
-#define PIXEL_OUT_T uint32
-#else
-#define PIXEL_OUT_T uint16
-#endif
+extern THREAD_LOCAL md_ntsc_t *md_ntsc;
+extern THREAD_LOCAL sms_ntsc_t *sms_ntsc;
 
 
 /* Pixel priority look-up tables information */
@@ -127,11 +123,22 @@ INLINE void WRITE_LONG(void *address, uint32 data)
       H = Horizontal Flip bit from pattern attribute
       V = Vertical Flip bit from pattern attribute
 */
+#ifdef USE_LAZY_PATTERN_FLIP
+/* Flipped patterns are only updated once referenced by a name table or sprite entry */
+#define UPDATE_FLIPPED_PATTERN(OFFSET) \
+  if (bg_flip_dirty[((OFFSET) >> 6) & 0x7FF] & (1 << ((OFFSET) >> 17))) \
+    update_bg_pattern_flip(((OFFSET) >> 6) & 0x7FF);
+#else
+#define UPDATE_FLIPPED_PATTERN(OFFSET)
+#endif
+
 #define GET_LSB_TILE(ATTR, LINE) \
   atex = atex_table[(ATTR >> 13) & 7]; \
+  UPDATE_FLIPPED_PATTERN((ATTR & 0x00001FFF) << 6) \
   src = (uint32 *)&bg_pattern_cache[(ATTR & 0x00001FFF) << 6 | (LINE)];
 #define GET_MSB_TILE(ATTR, LINE) \
   atex = atex_table[(ATTR >> 29) & 7]; \
+  UPDATE_FLIPPED_PATTERN((ATTR & 0x1FFF0000) >> 10) \
   src = (uint32 *)&bg_pattern_cache[(ATTR & 0x1FFF0000) >> 10 | (LINE)];
 
 /* Draw 2-cell column (16 pixels high) */
@@ -146,9 +153,11 @@ INLINE void WRITE_LONG(void *address, uint32 data)
 */
 #define GET_LSB_TILE_IM2(ATTR, LINE) \
   atex = atex_table[(ATTR >> 13) & 7]; \
+  UPDATE_FLIPPED_PATTERN(((ATTR & 0x000003FF) << 7 | (ATTR & 0x00001800) << 6 | (LINE)) ^ ((ATTR & 0x00001000) >> 6)) \
   src = (uint32 *)&bg_pattern_cache[((ATTR & 0x000003FF) << 7 | (ATTR & 0x00001800) << 6 | (LINE)) ^ ((ATTR & 0x00001000) >> 6)];
 #define GET_MSB_TILE_IM2(ATTR, LINE) \
   atex = atex_table[(ATTR >> 29) & 7]; \
+  UPDATE_FLIPPED_PATTERN(((ATTR & 0x03FF0000) >> 9 | (ATTR & 0x18000000) >> 10 | (LINE)) ^ ((ATTR & 0x10000000) >> 22)) \
   src = (uint32 *)&bg_pattern_cache[((ATTR & 0x03FF0000) >> 9 | (ATTR & 0x18000000) >> 10 | (LINE)) ^ ((ATTR & 0x10000000) >> 22)];
 
 /*
@@ -493,7 +502,7 @@ INLINE void WRITE_LONG(void *address, uint32 data)
 #endif
 
 /* Window & Plane A clipping */
-static struct clip_t
+static THREAD_LOCAL struct clip_t
 {
   uint8 left;
   uint8 right;
@@ -561,7 +570,18 @@ static const uint32 tms_palette[16] =
 #endif
 
 /* Cached and flipped patterns */
-static uint8 ALIGNED_(4) bg_pattern_cache[0x80000];
+#define BG_PATTERN_CACHE_SIZE 0x80000
+#ifdef USE_DYNAMIC_ALLOC
+static THREAD_LOCAL uint8 *bg_pattern_cache;
+#else
+static THREAD_LOCAL uint8 ALIGNED_(16) bg_pattern_cache[BG_PATTERN_CACHE_SIZE];
+#endif
+
+#ifdef USE_LAZY_PATTERN_FLIP
+/* Flipped patterns which need to be updated (bit n set = flip variant n) */
+static THREAD_LOCAL uint8 bg_flip_dirty[0x800];
+static void update_bg_pattern_flip(int name);
+#endif
 
 /* Sprite pattern name offset look-up table (Mode 5) */
 static uint8 name_lut[0x400];
@@ -572,16 +592,16 @@ static uint32 bp_lut[0x10000];
 /* Layer priority pixel look-up tables */
 static uint8 lut[LUT_MAX][LUT_SIZE];
 
-/* Output pixel data look-up tables*/
-static PIXEL_OUT_T pixel[0x100];
+/* Output pixel data look-up tables (one extra entry allows 32-bit reads of any 16-bit pixel, see vdp_blit.c) */
+static THREAD_LOCAL PIXEL_OUT_T pixel[0x100 + 1];
 static PIXEL_OUT_T pixel_lut[3][0x200];
 static PIXEL_OUT_T pixel_lut_m4[0x40];
 
 /* Background & Sprite line buffers */
-static uint8 linebuf[2][0x200];
+static THREAD_LOCAL uint8 linebuf[2][0x200];
 
 /* Sprite limit flag */
-static uint8 spr_ovr;
+static THREAD_LOCAL uint8 spr_ovr;
 
 /* Sprite parsing lists */
 typedef struct
@@ -592,19 +612,19 @@ typedef struct
   uint16 size;
 } object_info_t;
 
-static object_info_t obj_info[2][MAX_SPRITES_PER_LINE];
+static THREAD_LOCAL object_info_t obj_info[2][MAX_SPRITES_PER_LINE];
 
 /* Sprite Counter */
-static uint8 object_count[2];
+static THREAD_LOCAL uint8 object_count[2];
 
 /* Sprite Collision Info */
-uint16 spr_col;
+THREAD_LOCAL uint16 spr_col;
 
 /* Function pointers */
-void (*render_bg)(int line);
-void (*render_obj)(int line);
-void (*parse_satb)(int line);
-void (*update_bg_pattern_cache)(int index);
+THREAD_LOCAL void (*render_bg)(int line);
+THREAD_LOCAL void (*render_obj)(int line);
+THREAD_LOCAL void (*parse_satb)(int line);
+THREAD_LOCAL void (*update_bg_pattern_cache)(int index);
 
 
 /*--------------------------------------------------------------------------*/
@@ -3238,6 +3258,7 @@ void render_obj_m5(int line)
       for (column = 0; column < width; column++, lb+=8)
       {
         temp = attr | ((name + s[column]) & 0x07FF);
+        UPDATE_FLIPPED_PATTERN(temp << 6)
         src = &bg_pattern_cache[(temp << 6) | (v_line)];
         DRAW_SPRITE_TILE(8,atex,lut[1])
       }
@@ -3350,6 +3371,7 @@ void render_obj_m5_ste(int line)
       for (column = 0; column < width; column++, lb+=8)
       {
         temp = attr | ((name + s[column]) & 0x07FF);
+        UPDATE_FLIPPED_PATTERN(temp << 6)
         src = &bg_pattern_cache[(temp << 6) | (v_line)];
         DRAW_SPRITE_TILE(8,atex,lut[3])
       }
@@ -3466,6 +3488,7 @@ void render_obj_m5_im2(int line)
       for(column = 0; column < width; column ++, lb+=8)
       {
         temp = attr | (((name + s[column]) & 0x3ff) << 1);
+        UPDATE_FLIPPED_PATTERN(((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6))
         src = &bg_pattern_cache[((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6)];
         DRAW_SPRITE_TILE(8,atex,lut[1])
       }
@@ -3579,6 +3602,7 @@ void render_obj_m5_im2_ste(int line)
       for(column = 0; column < width; column ++, lb+=8)
       {
         temp = attr | (((name + s[column]) & 0x3ff) << 1);
+        UPDATE_FLIPPED_PATTERN(((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6))
         src = &bg_pattern_cache[((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6)];
         DRAW_SPRITE_TILE(8,atex,lut[3])
       }
@@ -3937,60 +3961,151 @@ void update_bg_pattern_cache_m4(int index)
   }
 }
 
+/* Convert one pattern line (byteplane data) to cached pixel data (8 pixels = 2 x 32-bit words) */
+#ifdef LSB_FIRST
+/* Byteplane data = (msb) p4p5 p6p7 p0p1 p2p3 (lsb), cached data = (msb) p3 p2 p1 p0 (lsb) */
+#define PATTERN_WORD(BP) \
+  ((((BP) >> 12) & 0x0000000F) | ((BP) & 0x00000F00) | (((BP) << 12) & 0x000F0000) | (((BP) << 24) & 0x0F000000))
+#define PATTERN_LINE(BP, DST) \
+  (DST)[0] = PATTERN_WORD(BP); \
+  (DST)[1] = PATTERN_WORD((BP) >> 16);
+#else
+/* Byteplane data = (msb) p0p1 p2p3 p4p5 p6p7 (lsb), cached data = (msb) p0 p1 p2 p3 (lsb) */
+#define PATTERN_WORD(BP) \
+  ((((BP) >> 4) & 0x0F000000) | (((BP) >> 8) & 0x000F0000) | (((BP) >> 12) & 0x00000F00) | (((BP) >> 16) & 0x0000000F))
+#define PATTERN_LINE(BP, DST) \
+  (DST)[0] = PATTERN_WORD(BP); \
+  (DST)[1] = PATTERN_WORD((BP) << 16);
+#endif
+
+/* Reverse byte order of a 32-bit word */
+#define SWAP_WORD(W) \
+  (((W) >> 24) | (((W) >> 8) & 0x0000FF00) | (((W) << 8) & 0x00FF0000) | ((W) << 24))
+
+/* Update flipped copies of pattern line Y from unflipped data (hflip = reversed byte order) */
+#define FLIP_PATTERN_LINE(DST, Y) \
+  (DST)[0x8000 | ((Y) << 1)] = SWAP_WORD((DST)[((Y) << 1) | 1]); \
+  (DST)[0x8001 | ((Y) << 1)] = SWAP_WORD((DST)[((Y) << 1)]); \
+  (DST)[0x10000 | (((Y) ^ 7) << 1)] = (DST)[((Y) << 1)]; \
+  (DST)[0x10001 | (((Y) ^ 7) << 1)] = (DST)[((Y) << 1) | 1]; \
+  (DST)[0x18000 | (((Y) ^ 7) << 1)] = (DST)[0x8000 | ((Y) << 1)]; \
+  (DST)[0x18001 | (((Y) ^ 7) << 1)] = (DST)[0x8001 | ((Y) << 1)];
+
+#ifdef HAVE_SSE2_PATTERN
+/* Update all lines of a pattern at once (fully modified patterns, i.e after DMA) */
+static void update_bg_pattern_sse2(int name)
+{
+  int i;
+  __m128i bp, lo, hi, line[4];
+  __m128i *dst = (__m128i *)&bg_pattern_cache[name << 6];
+  const __m128i mask = _mm_set1_epi8(0x0F);
+
+  for (i = 0; i < 2; i++)
+  {
+    /* Byteplane data (4 lines): byte0 = p2p3, byte1 = p0p1, byte2 = p6p7, byte3 = p4p5 */
+    bp = _mm_loadu_si128((__m128i *)&vram[(name << 5) | (i << 4)]);
+    lo = _mm_and_si128(bp, mask);
+    hi = _mm_and_si128(_mm_srli_epi16(bp, 4), mask);
+
+    /* p2 p3 p0 p1 p6 p7 p4 p5 -> p0 p1 p2 p3 p4 p5 p6 p7 (2 lines) */
+    line[i * 2] = _mm_unpacklo_epi8(hi, lo);
+    line[i * 2 + 1] = _mm_unpackhi_epi8(hi, lo);
+    line[i * 2] = _mm_shufflehi_epi16(_mm_shufflelo_epi16(line[i * 2], 0xB1), 0xB1);
+    line[i * 2 + 1] = _mm_shufflehi_epi16(_mm_shufflelo_epi16(line[i * 2 + 1], 0xB1), 0xB1);
+
+    /* vflip=0, hflip=0 */
+    _mm_store_si128(&dst[i * 2], line[i * 2]);
+    _mm_store_si128(&dst[i * 2 + 1], line[i * 2 + 1]);
+
+#ifndef USE_LAZY_PATTERN_FLIP
+    /* vflip=1, hflip=0 (reversed line order) */
+    _mm_store_si128(&dst[0x4000 + 3 - i * 2], _mm_shuffle_epi32(line[i * 2], 0x4E));
+    _mm_store_si128(&dst[0x4000 + 2 - i * 2], _mm_shuffle_epi32(line[i * 2 + 1], 0x4E));
+
+    /* p3 p2 p1 p0 p7 p6 p5 p4 -> p7 p6 p5 p4 p3 p2 p1 p0 (2 lines) */
+    line[i * 2] = _mm_unpacklo_epi8(lo, hi);
+    line[i * 2 + 1] = _mm_unpackhi_epi8(lo, hi);
+    line[i * 2] = _mm_shufflehi_epi16(_mm_shufflelo_epi16(line[i * 2], 0x4E), 0x4E);
+    line[i * 2 + 1] = _mm_shufflehi_epi16(_mm_shufflelo_epi16(line[i * 2 + 1], 0x4E), 0x4E);
+
+    /* vflip=0, hflip=1 */
+    _mm_store_si128(&dst[0x2000 + i * 2], line[i * 2]);
+    _mm_store_si128(&dst[0x2000 + i * 2 + 1], line[i * 2 + 1]);
+
+    /* vflip=1, hflip=1 (reversed line order) */
+    _mm_store_si128(&dst[0x6000 + 3 - i * 2], _mm_shuffle_epi32(line[i * 2], 0x4E));
+    _mm_store_si128(&dst[0x6000 + 2 - i * 2], _mm_shuffle_epi32(line[i * 2 + 1], 0x4E));
+#endif
+  }
+}
+#endif
+
+#ifdef USE_LAZY_PATTERN_FLIP
+static void update_bg_pattern_flip(int name)
+{
+  int y;
+  uint32 *dst = (uint32 *)&bg_pattern_cache[name << 6];
+
+  /* Update all flipped copies from unflipped pattern data */
+  for (y = 0; y < 8; y++)
+  {
+    FLIP_PATTERN_LINE(dst, y)
+  }
+
+  /* Clear modified flipped pattern flags */
+  bg_flip_dirty[name] = 0;
+}
+#endif
+
 void update_bg_pattern_cache_m5(int index)
 {
   int i;
-  uint8 x, y, c;
-  uint8 *dst;
+  uint8 y;
   uint16 name;
-  uint32 bp;
+  uint32 bp, *dst;
 
   for(i = 0; i < index; i++)
   {
     /* Get modified pattern name index */
     name = bg_name_list[i];
 
-    /* Pattern cache base address */
-    dst = &bg_pattern_cache[name << 6];
-
-    /* Check modified lines */
-    for(y = 0; y < 8; y ++)
+#ifdef HAVE_SSE2_PATTERN
+    /* Fully modified pattern */
+    if (bg_name_dirty[name] == 0xFF)
     {
-      if(bg_name_dirty[name] & (1 << y))
-      {
-        /* Byteplane data (one pattern = 4 bytes) */
-        /* LIT_ENDIAN: byte0 (lsb) p2p3 p0p1 p6p7 p4p5 (msb) byte3 */
-        /* BIG_ENDIAN: byte0 (msb) p0p1 p2p3 p4p5 p6p7 (lsb) byte3 */
-        bp = *(uint32 *)&vram[(name << 5) | (y << 2)];
+      update_bg_pattern_sse2(name);
+    }
+    else
+#endif
+    {
+      /* Pattern cache base address */
+      dst = (uint32 *)&bg_pattern_cache[name << 6];
 
-        /* Update cached line (8 pixels = 8 bytes) */
-        for(x = 0; x < 8; x ++)
+      /* Check modified lines */
+      for(y = 0; y < 8; y ++)
+      {
+        if(bg_name_dirty[name] & (1 << y))
         {
-          /* Extract pixel data */
-          c = bp & 0x0F;
+          /* Byteplane data (one pattern = 4 bytes) */
+          bp = *(uint32 *)&vram[(name << 5) | (y << 2)];
 
-          /* Pattern cache data (one pattern = 8 bytes) */
-          /* byte0 <-> p0 p1 p2 p3 p4 p5 p6 p7 <-> byte7 (hflip = 0) */
-          /* byte0 <-> p7 p6 p5 p4 p3 p2 p1 p0 <-> byte7 (hflip = 1) */
-#ifdef LSB_FIRST
-          /* Byteplane data = (msb) p4p5 p6p7 p0p1 p2p3 (lsb) */
-          dst[0x00000 | (y << 3) | (x ^ 3)] = (c);        /* vflip=0, hflip=0 */
-          dst[0x20000 | (y << 3) | (x ^ 4)] = (c);        /* vflip=0, hflip=1 */
-          dst[0x40000 | ((y ^ 7) << 3) | (x ^ 3)] = (c);  /* vflip=1, hflip=0 */
-          dst[0x60000 | ((y ^ 7) << 3) | (x ^ 4)] = (c);  /* vflip=1, hflip=1 */
-#else
-          /* Byteplane data = (msb) p0p1 p2p3 p4p5 p6p7 (lsb) */
-          dst[0x00000 | (y << 3) | (x ^ 7)] = (c);        /* vflip=0, hflip=0 */
-          dst[0x20000 | (y << 3) | (x)] = (c);            /* vflip=0, hflip=1 */
-          dst[0x40000 | ((y ^ 7) << 3) | (x ^ 7)] = (c);  /* vflip=1, hflip=0 */
-          dst[0x60000 | ((y ^ 7) << 3) | (x)] = (c);      /* vflip=1, hflip=1 */
+          /* Update cached line (8 pixels = 8 bytes) */
+          /* byte0 <-> p0 p1 p2 p3 p4 p5 p6 p7 <-> byte7 */
+          PATTERN_LINE(bp, &dst[y << 1])
+
+#ifndef USE_LAZY_PATTERN_FLIP
+          /* Update flipped lines */
+          FLIP_PATTERN_LINE(dst, y)
 #endif
-          /* Next pixel */
-          bp = bp >> 4;
         }
       }
     }
 
+#ifdef USE_LAZY_PATTERN_FLIP
+    /* Flipped patterns are updated on first use */
+    bg_flip_dirty[name] = 0x0E;
+#endif
+
     /* Clear modified pattern flag */
     bg_name_dirty[name] = 0;
   }
@@ -4079,8 +4194,43 @@ void render_init(void)
 
   /* Make bitplane to pixel look-up table (Mode 4) */
   make_bp_lut();
+
+  /* Select line blitters supported by host CPU */
+  blit_init();
+
+  /* snapshot areas (pattern cache is updated from VRAM on snapshot restore) */
+  snapshot_var(clip);
+  snapshot_var(pixel);
+  snapshot_var(linebuf);
+  snapshot_var(spr_ovr);
+  snapshot_var(obj_info);
+  snapshot_var(object_count);
+  snapshot_var(spr_col);
+  snapshot_var(render_bg);
+  snapshot_var(render_obj);
+  snapshot_var(parse_satb);
+  snapshot_var(update_bg_pattern_cache);
 }
 
+#ifdef USE_DYNAMIC_ALLOC
+int render_alloc(void)
+{
+  /* allocate pattern cache of current thread (emulation or render thread) if required */
+  if (!bg_pattern_cache)
+  {
+    bg_pattern_cache = (uint8 *)calloc(1, BG_PATTERN_CACHE_SIZE);
+  }
+
+  return (bg_pattern_cache != NULL);
+}
+
+void render_free(void)
+{
+  free(bg_pattern_cache);
+  bg_pattern_cache = NULL;
+}
+#endif
+
 void render_reset(void)
 {
   /* Clear display bitmap */
@@ -4093,10 +4243,18 @@ void render_reset(void)
   memset(pixel, 0, sizeof(pixel));
 
   /* Clear pattern cache */
-  memset ((char *) bg_pattern_cache, 0, sizeof (bg_pattern_cache));
+  memset ((char *) bg_pattern_cache, 0, BG_PATTERN_CACHE_SIZE);
+#ifdef USE_LAZY_PATTERN_FLIP
+  memset (bg_flip_dirty, 0, sizeof (bg_flip_dirty));
+#endif
 
   /* Reset Sprite infos */
   spr_ovr = spr_col = object_count[0] = object_count[1] = 0;
+
+#ifdef USE_RENDER_THREAD
+  /* Render thread VRAM must be updated */
+  render_thread_reset();
+#endif
 }
 
 
@@ -4106,6 +4264,17 @@ void render_reset(void)
 
 void render_line(int line)
 {
+#ifdef USE_RENDER_THREAD
+  /* line is rendered by render thread */
+  if (render_thread_active)
+  {
+    render_thread_push(RENDER_LINE, line, 0, 0);
+    return;
+  }
+#endif
+
+  timing_begin(TIMING_RENDER);
+
   /* Check display status */
   if (reg[1] & 0x40)
   {
@@ -4163,16 +4332,60 @@ void render_line(int line)
 
   /* Pixel color remapping */
   remap_line(line);
+
+  timing_end();
+}
+
+#ifdef USE_RENDER_THREAD
+int render_context_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  save_param(clip, sizeof(clip));
+  save_param(pixel, sizeof(pixel));
+
+  return bufferptr;
 }
 
+int render_context_load(uint8 *state)
+{
+  int bufferptr = 0;
+
+  load_param(clip, sizeof(clip));
+  load_param(pixel, sizeof(pixel));
+
+  return bufferptr;
+}
+#endif
+
 void blank_line(int line, int offset, int width)
 {
+#ifdef USE_RENDER_THREAD
+  /* line is rendered by render thread */
+  if (render_thread_active)
+  {
+    render_thread_push(RENDER_BLANK, line, offset, width);
+    return;
+  }
+#endif
+
+  timing_begin(TIMING_RENDER);
   memset(&linebuf[0][0x20 + offset], 0x40, width);
   remap_line(line);
+  timing_end();
 }
 
 void remap_line(int line)
 {
+#ifdef USE_RENDER_THREAD
+  /* line is rendered by render thread */
+  if (render_thread_active)
+  {
+    render_thread_push(RENDER_REMAP, line, 0, 0);
+    return;
+  }
+#endif
+
   /* Line width */
   int width = bitmap.viewport.w + 2*bitmap.viewport.x;
 
@@ -4214,19 +4427,11 @@ void remap_line(int line)
     PIXEL_OUT_T *dst = ((PIXEL_OUT_T *)&bitmap.data[(line * bitmap.pitch)]);
     if (config.lcd)
     {
-      do
-      {
-        RENDER_PIXEL_LCD(src,dst,pixel,config.lcd);
-      }
-      while (--width);
+      blit_remap_lcd(dst, src, pixel, width, config.lcd);
     }
     else
     {
-      do
-      {
-        *dst++ = pixel[*src++];
-      }
-      while (--width);
+      blit_remap(dst, src, pixel, width);
     }
  #endif
   }
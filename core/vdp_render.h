@@ -78,6 +78,15 @@
 #define GET_B(pixel) (((pixel) & 0x0000ff) >> 0)
 #endif
 
+/* Output pixels type */
+#if defined(USE_8BPP_RENDERING)
+#define PIXEL_OUT_T uint8
+#elif defined(USE_32BPP_RENDERING)
+#define PIXEL_OUT_T uint32
+#else
+#define PIXEL_OUT_T uint16
+#endif
+
 /* LCD image persistence (ghosting) filter */
 /* Simulates (roughly) the slow decay response time of passive-matrix LCD */
 /* Rate value is formatted as 0.8 fixed-point integer (between 0.0 and 0.99609375), a higher value meaning a slower decay */
@@ -99,11 +108,15 @@
 }
 
 /* Global variables */
-extern uint16 spr_col;
+extern THREAD_LOCAL uint16 spr_col;
 
 /* Function prototypes */
 extern void render_init(void);
 extern void render_reset(void);
+#ifdef USE_DYNAMIC_ALLOC
+extern int render_alloc(void);
+extern void render_free(void);
+#endif
 extern void render_line(int line);
 extern void blank_line(int line, int offset, int width);
 extern void remap_line(int line);
@@ -133,11 +146,15 @@ extern void update_bg_pattern_cache_m4(int index);
 extern void update_bg_pattern_cache_m5(int index);
 extern void color_update_m4(int index, unsigned int data);
 extern void color_update_m5(int index, unsigned int data);
+#ifdef USE_RENDER_THREAD
+extern int render_context_save(uint8 *state);
+extern int render_context_load(uint8 *state);
+#endif
 
 /* Function pointers */
-extern void (*render_bg)(int line);
-extern void (*render_obj)(int line);
-extern void (*parse_satb)(int line);
-extern void (*update_bg_pattern_cache)(int index);
+extern THREAD_LOCAL void (*render_bg)(int line);
+extern THREAD_LOCAL void (*render_obj)(int line);
+extern THREAD_LOCAL void (*parse_satb)(int line);
+extern THREAD_LOCAL void (*update_bg_pattern_cache)(int index);
 
 #endif /* _RENDER_H_ */
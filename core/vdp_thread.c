@@ -0,0 +1,577 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Render thread
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+#include "md_ntsc.h"
+#include "sms_ntsc.h"
+
+#ifdef USE_RENDER_THREAD
+
+#include <pthread.h>
+
+/* Record queue size (must be a power of two) */
+#define RENDER_QUEUE_SIZE 0x100000
+
+/* End of queue marker */
+#define RENDER_WRAP 0xFF
+
+/* Record data flags */
+#define RENDER_VRAM     0x01  /* full VRAM copy */
+#define RENDER_SAT      0x02  /* internal SAT copy */
+#define RENDER_CONTEXT  0x04  /* renderer context copy */
+
+/* Renderer context maximal size (see render_context_save) */
+#define RENDER_CONTEXT_SIZE 0x800
+
+/* Records are kept 64-bit aligned */
+#define RENDER_ALIGN(size) (((size) + 7) & ~7)
+
+/*** NTSC Filters ***/
+extern THREAD_LOCAL md_ntsc_t *md_ntsc;
+extern THREAD_LOCAL sms_ntsc_t *sms_ntsc;
+
+/* Rendering request (followed by VRAM, modified patterns, SAT & renderer context data) */
+typedef struct
+{
+  uint32 size;
+  uint8 type;
+  uint8 flags;
+  uint16 patterns;
+  int line;
+  int offset;
+  int width;
+  uint8 reg[0x20];
+  uint8 vsram[0x80];
+  uint16 status;
+  uint16 v_counter;
+  uint16 lines_per_frame;
+  uint16 ntab;
+  uint16 ntbb;
+  uint16 ntwb;
+  uint16 satb;
+  uint16 hscb;
+  uint16 playfield_row_mask;
+  uint16 vscroll;
+  uint16 max_sprite_pixels;
+  uint8 hscroll_mask;
+  uint8 playfield_shift;
+  uint8 playfield_col_mask;
+  uint8 odd_frame;
+  uint8 im2_flag;
+  uint8 interlaced;
+  uint8 system_hw;
+  uint8 gg_extra;
+  uint8 ntsc;
+  uint8 lcd;
+  uint8 render;
+  t_bitmap bitmap;
+  md_ntsc_t *md_ntsc;
+  sms_ntsc_t *sms_ntsc;
+  void (*render_bg)(int line);
+  void (*render_obj)(int line);
+  void (*parse_satb)(int line);
+  void (*update_bg_pattern_cache)(int index);
+} t_render_record;
+
+/* Modified pattern */
+typedef struct
+{
+  uint16 name;
+  uint8 dirty;
+  uint8 unused;
+  uint8 data[32];
+} t_render_pattern;
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t work;      /* signaled when records have been queued */
+  pthread_cond_t done;      /* signaled when records have been processed */
+  uint8 *queue;             /* record queue */
+  uint32 head;              /* total size of queued records */
+  uint32 tail;              /* total size of processed records */
+  int quit;                 /* render thread exit request */
+  int started;              /* 1 = render thread ready, -1 = render thread initialization failed */
+  uint16 flags;             /* VDP status flags set by render thread */
+  uint16 spr_col;           /* sprite collision position */
+  int resync;               /* 1= full VRAM copy needed */
+  int context_size;         /* last queued renderer context */
+  uint8 context[RENDER_CONTEXT_SIZE];
+  uint8 sat[0x400];         /* last queued internal SAT */
+} t_render_thread;
+
+/* set when lines are rendered by render thread */
+THREAD_LOCAL int render_thread_active;
+
+/* render thread bound to current instance */
+static THREAD_LOCAL t_render_thread *rt;
+
+static void invalidate_patterns(void)
+{
+  int i;
+
+  /* invalidate tile cache (see vdp_context_load) */
+  memset(bg_name_dirty, 0, sizeof(bg_name_dirty));
+  bg_list_index = (reg[1] & 0x04) ? 0x800 : 0x200;
+  for (i=0;i<bg_list_index;i++)
+  {
+    bg_name_list[i]=i;
+    bg_name_dirty[i]=0xFF;
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+/* Render thread                                                            */
+/*--------------------------------------------------------------------------*/
+
+static uint16 render_record(t_render_record *record, uint16 flags)
+{
+  int i;
+  uint8 *data = (uint8 *)(record + 1);
+
+  /* update VDP & renderer state */
+  memcpy(reg, record->reg, sizeof(reg));
+  memcpy(vsram, record->vsram, sizeof(vsram));
+  status = record->status | flags;
+  v_counter = record->v_counter;
+  lines_per_frame = record->lines_per_frame;
+  ntab = record->ntab;
+  ntbb = record->ntbb;
+  ntwb = record->ntwb;
+  satb = record->satb;
+  hscb = record->hscb;
+  playfield_row_mask = record->playfield_row_mask;
+  vscroll = record->vscroll;
+  max_sprite_pixels = record->max_sprite_pixels;
+  hscroll_mask = record->hscroll_mask;
+  playfield_shift = record->playfield_shift;
+  playfield_col_mask = record->playfield_col_mask;
+  odd_frame = record->odd_frame;
+  im2_flag = record->im2_flag;
+  interlaced = record->interlaced;
+  system_hw = record->system_hw;
+  config.gg_extra = record->gg_extra;
+  config.ntsc = record->ntsc;
+  config.lcd = record->lcd;
+  config.render = record->render;
+  bitmap = record->bitmap;
+  md_ntsc = record->md_ntsc;
+  sms_ntsc = record->sms_ntsc;
+  render_bg = record->render_bg;
+  render_obj = record->render_obj;
+  parse_satb = record->parse_satb;
+  update_bg_pattern_cache = record->update_bg_pattern_cache;
+
+  /* update VRAM */
+  if (record->flags & RENDER_VRAM)
+  {
+    memcpy(vram, data, sizeof(vram));
+    data += sizeof(vram);
+    invalidate_patterns();
+  }
+
+  /* update modified patterns */
+  for (i=0; i<record->patterns; i++)
+  {
+    t_render_pattern *pattern = (t_render_pattern *)data;
+    memcpy(&vram[pattern->name << 5], pattern->data, 32);
+    if (bg_name_dirty[pattern->name] == 0)
+    {
+      bg_name_list[bg_list_index++] = pattern->name;
+    }
+    bg_name_dirty[pattern->name] |= pattern->dirty;
+    data += sizeof(t_render_pattern);
+  }
+
+  /* update internal SAT */
+  if (record->flags & RENDER_SAT)
+  {
+    memcpy(sat, data, sizeof(sat));
+    data += sizeof(sat);
+  }
+
+  /* update color palette & window clipping */
+  if (record->flags & RENDER_CONTEXT)
+  {
+    render_context_load(data);
+  }
+
+  switch (record->type)
+  {
+    case RENDER_LINE:
+      render_line(record->line);
+      break;
+
+    case RENDER_BLANK:
+      blank_line(record->line, record->offset, record->width);
+      break;
+
+    case RENDER_REMAP:
+      remap_line(record->line);
+      break;
+
+    case RENDER_SATB:
+      parse_satb(record->line);
+      break;
+  }
+
+  /* sprite overflow & collision flags not yet reported */
+  return flags | (status & ~record->status & 0x60);
+}
+
+static void *render_thread_main(void *arg)
+{
+  t_render_thread *thread = (t_render_thread *)arg;
+  t_render_record *record;
+  uint32 head, tail;
+  uint16 flags;
+
+  /* renderer look-up tables are shared with emulation thread */
+  blit_init();
+
+  pthread_mutex_lock(&thread->lock);
+
+  /* pattern cache is not (see render_thread_init) */
+  thread->started = 1;
+#ifdef USE_DYNAMIC_ALLOC
+  if (!render_alloc())
+  {
+    thread->started = -1;
+    thread->quit = 1;
+  }
+#endif
+  pthread_cond_signal(&thread->done);
+
+  while (1)
+  {
+    /* wait for queued records */
+    while ((thread->tail == thread->head) && !thread->quit)
+    {
+      pthread_cond_wait(&thread->work, &thread->lock);
+    }
+
+    if (thread->tail == thread->head)
+    {
+      break;
+    }
+
+    head = thread->head;
+    tail = thread->tail;
+    flags = thread->flags;
+    pthread_mutex_unlock(&thread->lock);
+
+    /* process queued records */
+    while (tail != head)
+    {
+      record = (t_render_record *)&thread->queue[tail & (RENDER_QUEUE_SIZE - 1)];
+      if (record->type != RENDER_WRAP)
+      {
+        flags = render_record(record, flags);
+      }
+      tail += record->size;
+    }
+
+    pthread_mutex_lock(&thread->lock);
+    thread->tail = tail;
+    thread->flags = flags;
+    thread->spr_col = spr_col;
+    pthread_cond_signal(&thread->done);
+  }
+
+  pthread_mutex_unlock(&thread->lock);
+
+#ifdef USE_DYNAMIC_ALLOC
+  render_free();
+#endif
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Emulation thread                                                         */
+/*--------------------------------------------------------------------------*/
+
+int render_thread_init(void)
+{
+  if (rt)
+  {
+    return 1;
+  }
+
+  /* only supported with Mega Drive VDP (Master System & Game Gear modes are rendered by emulation thread) */
+  if ((system_hw & SYSTEM_PBC) != SYSTEM_MD)
+  {
+    return 0;
+  }
+
+  rt = (t_render_thread *)calloc(1, sizeof(t_render_thread));
+  if (!rt)
+  {
+    return 0;
+  }
+
+  rt->queue = (uint8 *)malloc(RENDER_QUEUE_SIZE);
+  if (rt->queue)
+  {
+    pthread_mutex_init(&rt->lock, NULL);
+    pthread_cond_init(&rt->work, NULL);
+    pthread_cond_init(&rt->done, NULL);
+
+    /* render thread VRAM is initially empty */
+    rt->resync = 1;
+
+    if (!pthread_create(&rt->thread, NULL, render_thread_main, rt))
+    {
+      /* wait until render thread has allocated its own pattern cache */
+      pthread_mutex_lock(&rt->lock);
+      while (!rt->started)
+      {
+        pthread_cond_wait(&rt->done, &rt->lock);
+      }
+      pthread_mutex_unlock(&rt->lock);
+
+      if (rt->started > 0)
+      {
+        render_thread_active = 1;
+        return 1;
+      }
+
+      pthread_join(rt->thread, NULL);
+    }
+
+    pthread_cond_destroy(&rt->done);
+    pthread_cond_destroy(&rt->work);
+    pthread_mutex_destroy(&rt->lock);
+    free(rt->queue);
+  }
+
+  free(rt);
+  rt = NULL;
+  return 0;
+}
+
+void render_thread_shutdown(void)
+{
+  if (!rt)
+  {
+    return;
+  }
+
+  /* render remaining lines */
+  render_thread_sync();
+
+  pthread_mutex_lock(&rt->lock);
+  rt->quit = 1;
+  pthread_cond_signal(&rt->work);
+  pthread_mutex_unlock(&rt->lock);
+  pthread_join(rt->thread, NULL);
+
+  pthread_cond_destroy(&rt->done);
+  pthread_cond_destroy(&rt->work);
+  pthread_mutex_destroy(&rt->lock);
+  free(rt->queue);
+  free(rt);
+  rt = NULL;
+  render_thread_active = 0;
+
+  /* pattern cache has only been updated by render thread */
+  invalidate_patterns();
+}
+
+void render_thread_reset(void)
+{
+  /* VRAM is not modified through VDP ports on reset */
+  if (rt)
+  {
+    rt->resync = 1;
+  }
+}
+
+void render_thread_sync(void)
+{
+  pthread_mutex_lock(&rt->lock);
+
+  /* wait until all queued lines have been rendered */
+  while (rt->tail != rt->head)
+  {
+    pthread_cond_wait(&rt->done, &rt->lock);
+  }
+
+  /* report sprite overflow & collision flags */
+  if (rt->flags & 0x20)
+  {
+    spr_col = rt->spr_col;
+  }
+  status |= rt->flags;
+  rt->flags = 0;
+
+  pthread_mutex_unlock(&rt->lock);
+}
+
+void render_thread_push(int type, int line, int offset, int width)
+{
+  t_render_record *record;
+  uint8 *data;
+  uint32 pos, wrap;
+  int i, size;
+
+  /* maximal record size */
+  size = sizeof(t_render_record) + bg_list_index * sizeof(t_render_pattern) + sizeof(sat) + RENDER_CONTEXT_SIZE;
+  if (rt->resync)
+  {
+    size += sizeof(vram);
+  }
+
+  /* records never wrap around end of queue */
+  pos = rt->head & (RENDER_QUEUE_SIZE - 1);
+  wrap = ((pos + size) > RENDER_QUEUE_SIZE) ? (RENDER_QUEUE_SIZE - pos) : 0;
+
+  /* wait for enough free space */
+  pthread_mutex_lock(&rt->lock);
+  while ((rt->head - rt->tail + wrap + size) > RENDER_QUEUE_SIZE)
+  {
+    pthread_cond_wait(&rt->done, &rt->lock);
+  }
+  pthread_mutex_unlock(&rt->lock);
+
+  if (wrap)
+  {
+    record = (t_render_record *)&rt->queue[pos];
+    record->size = wrap;
+    record->type = RENDER_WRAP;
+    pos = 0;
+  }
+
+  record = (t_render_record *)&rt->queue[pos];
+  data = (uint8 *)(record + 1);
+
+  /* rendering request */
+  record->type = type;
+  record->flags = 0;
+  record->line = line;
+  record->offset = offset;
+  record->width = width;
+
+  /* VDP & renderer state */
+  memcpy(record->reg, reg, sizeof(reg));
+  memcpy(record->vsram, vsram, sizeof(vsram));
+  record->status = status;
+  record->v_counter = v_counter;
+  record->lines_per_frame = lines_per_frame;
+  record->ntab = ntab;
+  record->ntbb = ntbb;
+  record->ntwb = ntwb;
+  record->satb = satb;
+  record->hscb = hscb;
+  record->playfield_row_mask = playfield_row_mask;
+  record->vscroll = vscroll;
+  record->max_sprite_pixels = max_sprite_pixels;
+  record->hscroll_mask = hscroll_mask;
+  record->playfield_shift = playfield_shift;
+  record->playfield_col_mask = playfield_col_mask;
+  record->odd_frame = odd_frame;
+  record->im2_flag = im2_flag;
+  record->interlaced = interlaced;
+  record->system_hw = system_hw;
+  record->gg_extra = config.gg_extra;
+  record->ntsc = config.ntsc;
+  record->lcd = config.lcd;
+  record->render = config.render;
+  record->bitmap = bitmap;
+  record->md_ntsc = md_ntsc;
+  record->sms_ntsc = sms_ntsc;
+  record->render_bg = render_bg;
+  record->render_obj = render_obj;
+  record->parse_satb = parse_satb;
+  record->update_bg_pattern_cache = update_bg_pattern_cache;
+
+  /* full VRAM copy */
+  if (rt->resync)
+  {
+    memcpy(data, vram, sizeof(vram));
+    data += sizeof(vram);
+    record->flags |= RENDER_VRAM;
+    rt->resync = 0;
+  }
+
+  /* VRAM patterns modified since last request */
+  for (i=0; i<bg_list_index; i++)
+  {
+    int name = bg_name_list[i];
+    if (!(record->flags & RENDER_VRAM))
+    {
+      t_render_pattern *pattern = (t_render_pattern *)data;
+      pattern->name = name;
+      pattern->dirty = bg_name_dirty[name];
+      memcpy(pattern->data, &vram[name << 5], 32);
+      data += sizeof(t_render_pattern);
+    }
+    bg_name_dirty[name] = 0;
+  }
+  record->patterns = (record->flags & RENDER_VRAM) ? 0 : bg_list_index;
+  bg_list_index = 0;
+
+  /* internal SAT (only when modified) */
+  if (memcmp(rt->sat, sat, sizeof(sat)))
+  {
+    memcpy(rt->sat, sat, sizeof(sat));
+    memcpy(data, sat, sizeof(sat));
+    data += sizeof(sat);
+    record->flags |= RENDER_SAT;
+  }
+
+  /* color palette & window clipping (only when modified) */
+  size = render_context_save(data);
+  if ((size != rt->context_size) || memcmp(rt->context, data, size))
+  {
+    memcpy(rt->context, data, size);
+    rt->context_size = size;
+    data += size;
+    record->flags |= RENDER_CONTEXT;
+  }
+
+  record->size = RENDER_ALIGN(data - (uint8 *)record);
+
+  /* wake up render thread */
+  pthread_mutex_lock(&rt->lock);
+  rt->head += wrap + record->size;
+  pthread_cond_signal(&rt->work);
+  pthread_mutex_unlock(&rt->lock);
+}
+
+#endif /* USE_RENDER_THREAD */
@@ -0,0 +1,74 @@
+/***************************************************************************************
+ *  Genesis Plus
+ *  Render thread
+ *
+ *  Copyright (C) 2007-2017  Eke-Eke (Genesis Plus GX)
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _VDP_THREAD_H_
+#define _VDP_THREAD_H_
+
+#ifdef USE_RENDER_THREAD
+
+#ifndef USE_MULTI_INSTANCE
+#error "USE_RENDER_THREAD requires USE_MULTI_INSTANCE"
+#endif
+
+/* Lines are rendered by a worker thread holding its own copy of VDP & renderer state  */
+/* (see context.h). On each rendering request, the emulation thread queues a record of */
+/* VDP registers, modified VRAM patterns, SAT cache and color palette, so that CPU     */
+/* emulation of a line can run while previous lines are being rendered.               */
+/*                                                                                     */
+/* Sprite overflow & collision flags set by the worker are reported to VDP status on   */
+/* next status read (which waits for queued lines to be rendered) or on frame end.     */
+
+/* Rendering requests */
+#define RENDER_LINE  0
+#define RENDER_BLANK 1
+#define RENDER_REMAP 2
+#define RENDER_SATB  3
+
+/* Global variables */
+extern THREAD_LOCAL int render_thread_active;
+
+/* Function prototypes */
+extern int render_thread_init(void);
+extern void render_thread_shutdown(void);
+extern void render_thread_reset(void);
+extern void render_thread_sync(void);
+extern void render_thread_push(int type, int line, int offset, int width);
+
+#endif /* USE_RENDER_THREAD */
+
+#endif /* _VDP_THREAD_H_ */
@@ -207,21 +207,100 @@
 #define USE_CYCLES(A) Z80.cycles += (A)
 #endif
 
-Z80_Regs Z80;
+THREAD_LOCAL Z80_Regs Z80;
 
 #ifdef Z80_ALLOW_OVERCLOCK
-UINT32 z80_cycle_ratio;
+THREAD_LOCAL UINT32 z80_cycle_ratio;
 #endif
 
-unsigned char *z80_readmap[64];
-unsigned char *z80_writemap[64];
+THREAD_LOCAL unsigned char *z80_readmap[64];
+THREAD_LOCAL unsigned char *z80_writemap[64];
 
-void (*z80_writemem)(unsigned int address, unsigned char data);
-unsigned char (*z80_readmem)(unsigned int address);
-void (*z80_writeport)(unsigned int port, unsigned char data);
-unsigned char (*z80_readport)(unsigned int port);
+THREAD_LOCAL void (*z80_writemem)(unsigned int address, unsigned char data);
+THREAD_LOCAL unsigned char (*z80_readmem)(unsigned int address);
+THREAD_LOCAL void (*z80_writeport)(unsigned int port, unsigned char data);
+THREAD_LOCAL unsigned char (*z80_readport)(unsigned int port);
 
-static UINT32 EA;
+static THREAD_LOCAL UINT32 EA;
+
+THREAD_LOCAL UINT8 z80_readmap_direct[64];
+THREAD_LOCAL UINT8 z80_writemap_direct[64];
+
+#ifdef USE_Z80_THREADED
+/* threaded code execution enabled */
+static THREAD_LOCAL int z80_threaded;
+#endif
+
+#ifdef USE_IDLE_SKIP
+THREAD_LOCAL UINT32 z80_read_horizon;
+THREAD_LOCAL unsigned long long z80_idle_cycles;
+
+/* busy-wait loop skipping */
+static THREAD_LOCAL struct
+{
+  UINT32 pc;          /* loop start address */
+  UINT32 cycle;       /* cycle count at previous loop iteration */
+  UINT32 cycle_end;   /* end of current execution frame */
+  UINT32 horizon;     /* memory is unchanged & reads return same values until this cycle count */
+  UINT8 armed;        /* CPU registers at previous loop iteration are valid */
+  UINT8 r;            /* refresh register at previous loop iteration */
+  PAIR regs[12];      /* SP, AF, BC, DE, HL, IX, IY, WZ & alternate registers at previous loop iteration */
+  UINT8 state[5];     /* IFF1, IFF2, HALT, IM & I at previous loop iteration */
+} z80_skip;
+
+/****************************************************************************
+ * Busy-wait loop skipping, called on backward jumps and HALT instruction.
+ * When a loop iteration ends with the same CPU registers as the previous one
+ * (except refresh register), without having written memory or I/O ports,
+ * next iterations would execute exactly the same way: their execution time
+ * is skipped, up to the last iteration completing before the end of current
+ * execution frame or until memory read handlers return different values.
+ ****************************************************************************/
+static void z80_idle_loop(void)
+{
+  if ((PCD != z80_skip.pc) || !z80_skip.horizon)
+  {
+    /* new loop or memory written during last iteration */
+    z80_skip.pc = PCD;
+    z80_skip.armed = 0;
+  }
+  else if (!z80_skip.armed || memcmp(z80_skip.regs, &Z80.sp, sizeof(z80_skip.regs)) || memcmp(z80_skip.state, &Z80.iff1, sizeof(z80_skip.state)))
+  {
+    /* CPU registers modified during last iteration */
+    memcpy(z80_skip.regs, &Z80.sp, sizeof(z80_skip.regs));
+    memcpy(z80_skip.state, &Z80.iff1, sizeof(z80_skip.state));
+    z80_skip.armed = 1;
+  }
+  else if (!Z80.irq_state || !IFF1)
+  {
+    /* idle loop: skip whole iterations ending before next event */
+    UINT32 period = Z80.cycles - z80_skip.cycle;
+    UINT32 end = (z80_skip.horizon < z80_skip.cycle_end) ? z80_skip.horizon : z80_skip.cycle_end;
+
+    if ((Z80.cycles < end) && ((end - Z80.cycles) > (2 * period)))
+    {
+      UINT32 count = ((end - Z80.cycles - 1) / period) - 1;
+
+      /* refresh register is incremented on each instruction fetch */
+      R += (UINT8)(count * (UINT8)(R - z80_skip.r));
+
+      Z80.cycles += count * period;
+      z80_idle_cycles += count * period;
+    }
+  }
+
+  z80_skip.r = R;
+  z80_skip.cycle = Z80.cycles;
+  z80_skip.horizon = 0xffffffff;
+}
+
+/* PC before a jump, only needed to detect backward jumps */
+#define IDLE_LOOP_PC UINT32 pc = PCD;
+#define IDLE_LOOP(cond) if (cond) z80_idle_loop();
+#else
+#define IDLE_LOOP_PC
+#define IDLE_LOOP(cond)
+#endif
 
 static UINT8 SZ[256];       /* zero and sign flags */
 static UINT8 SZ_BIT[256];   /* zero, sign and parity/overflow (=zero) flags for BIT opcode */
@@ -490,7 +569,11 @@ INLINE void BURNODD(int cycles, int opcodes, int cyclesum)
 /***************************************************************
  * define an opcode function
  ***************************************************************/
+#ifdef USE_Z80_THREADED
+#define OP(prefix,opcode)  static __inline__ __attribute__((always_inline)) void prefix##_##opcode(void)
+#else
 #define OP(prefix,opcode)  INLINE void prefix##_##opcode(void)
+#endif
 
 /***************************************************************
  * adjust cycle count by n T-states
@@ -591,6 +674,7 @@ INLINE void BURNODD(int cycles, int opcodes, int cyclesum)
 #define ENTER_HALT {                          \
   PC--;                                       \
   HALT = 1;                                   \
+  IDLE_LOOP(1)                                \
 }
 
 /***************************************************************
@@ -604,25 +688,135 @@ INLINE void BURNODD(int cycles, int opcodes, int cyclesum)
   }                                           \
 }
 
+/***************************************************************
+ * Check if given memory location is accessed directly through
+ * z80_readmap / z80_writemap, without memory handlers (see z80.h)
+ ***************************************************************/
+#define READ_DIRECT(addr)  z80_readmap_direct[(addr) >> 10]
+#define WRITE_DIRECT(addr) z80_writemap_direct[(addr) >> 10]
+
+/***************************************************************
+ * Write a byte to given memory location through z80_writemap
+ ***************************************************************/
+#define WRITEMAP(addr,value)                                  \
+{                                                             \
+  UINT8 *ptr = &z80_writemap[(addr) >> 10][(addr) & 0x03FF];  \
+  *ptr = (value);                                             \
+  MARK_STATE_DIRTY(ptr);                                      \
+}
+
+/***************************************************************
+ * Report memory handler or I/O port access to hotspot profiler
+ ***************************************************************/
+#ifdef USE_PROFILER
+#define PROFILE_IO(type,addr,handler) { if (profiler_active) profiler_io(PROFILER_Z80, type, addr, (profiler_handler_t)(handler)); }
+#else
+#define PROFILE_IO(type,addr,handler)
+#endif
+
+#ifdef USE_IDLE_SKIP
+/***************************************************************
+ * Input a byte from given I/O port
+ ***************************************************************/
+INLINE UINT8 IN(UINT32 port)
+{
+  z80_skip.horizon = 0;
+  PROFILE_IO(PROFILER_IN, port & 0xFF, z80_readport);
+  return z80_readport(port);
+}
+
+/***************************************************************
+ * Output a byte to given I/O port
+ ***************************************************************/
+INLINE void OUT(UINT32 port, UINT8 value)
+{
+  z80_skip.horizon = 0;
+  PROFILE_IO(PROFILER_OUT, port & 0xFF, z80_writeport);
+  z80_writeport(port,value);
+}
+
+/***************************************************************
+ * Read a byte from given memory location (handlers can set
+ * z80_read_horizon to the cycle count until which returned
+ * value cannot change, see z80.h)
+ ***************************************************************/
+INLINE UINT8 RM(UINT32 addr)
+{
+  UINT8 data;
+  if (READ_DIRECT(addr))
+  {
+    return z80_readmap[addr >> 10][addr & 0x03FF];
+  }
+  PROFILE_IO(PROFILER_READ8, addr, z80_readmem);
+  z80_read_horizon = 0;
+  data = z80_readmem(addr);
+  if (z80_read_horizon < z80_skip.horizon)
+  {
+    z80_skip.horizon = z80_read_horizon;
+  }
+  return data;
+}
+
+/***************************************************************
+ * Write a byte to given memory location
+ ***************************************************************/
+INLINE void WM(UINT32 addr, UINT8 value)
+{
+  z80_skip.horizon = 0;
+  if (WRITE_DIRECT(addr))
+  {
+    WRITEMAP(addr,value);
+    return;
+  }
+  PROFILE_IO(PROFILER_WRITE8, addr, z80_writemem);
+  z80_writemem(addr,value);
+}
+#else
 /***************************************************************
  * Input a byte from given I/O port
  ***************************************************************/
-#define IN(port) z80_readport(port)
+INLINE UINT8 IN(UINT32 port)
+{
+  PROFILE_IO(PROFILER_IN, port & 0xFF, z80_readport);
+  return z80_readport(port);
+}
 
 /***************************************************************
  * Output a byte to given I/O port
  ***************************************************************/
-#define OUT(port,value) z80_writeport(port,value)
+INLINE void OUT(UINT32 port, UINT8 value)
+{
+  PROFILE_IO(PROFILER_OUT, port & 0xFF, z80_writeport);
+  z80_writeport(port,value);
+}
 
 /***************************************************************
  * Read a byte from given memory location
  ***************************************************************/
-#define RM(addr) z80_readmem(addr)
+INLINE UINT8 RM(UINT32 addr)
+{
+  if (READ_DIRECT(addr))
+  {
+    return z80_readmap[addr >> 10][addr & 0x03FF];
+  }
+  PROFILE_IO(PROFILER_READ8, addr, z80_readmem);
+  return z80_readmem(addr);
+}
 
 /***************************************************************
  * Write a byte to given memory location
  ***************************************************************/
-#define WM(addr,value) z80_writemem(addr,value)
+INLINE void WM(UINT32 addr, UINT8 value)
+{
+  if (WRITE_DIRECT(addr))
+  {
+    WRITEMAP(addr,value);
+    return;
+  }
+  PROFILE_IO(PROFILER_WRITE8, addr, z80_writemem);
+  z80_writemem(addr,value);
+}
+#endif
 
 /***************************************************************
  * Read a word from given memory location
@@ -649,7 +843,7 @@ INLINE void WM16( UINT32 addr, PAIR *r )
  ***************************************************************/
 INLINE UINT8 ROP(void)
 {
-  unsigned pc = PCD;
+  unsigned pc = PC;
   PC++;
   return cpu_readop(pc);
 }
@@ -662,14 +856,14 @@ INLINE UINT8 ROP(void)
  ***************************************************************/
 INLINE UINT8 ARG(void)
 {
-  unsigned pc = PCD;
+  unsigned pc = PC;
   PC++;
   return cpu_readop_arg(pc);
 }
 
 INLINE UINT32 ARG16(void)
 {
-  unsigned pc = PCD;
+  unsigned pc = PC;
   PC += 2;
   return cpu_readop_arg(pc) | (cpu_readop_arg((pc+1)&0xffff) << 8);
 }
@@ -695,8 +889,10 @@ INLINE UINT32 ARG16(void)
  * JP
  ***************************************************************/
 #define JP {                                    \
+  IDLE_LOOP_PC                                  \
   PCD = ARG16();                                \
   WZ = PCD;                                     \
+  IDLE_LOOP(PCD < pc)                           \
 }
 
 /***************************************************************
@@ -705,8 +901,10 @@ INLINE UINT32 ARG16(void)
 #define JP_COND(cond) {                         \
   if (cond)                                     \
   {                                             \
+    IDLE_LOOP_PC                                \
     PCD = ARG16();                              \
     WZ = PCD;                                   \
+    IDLE_LOOP(PCD < pc)                         \
   }                                             \
   else                                          \
   {                                             \
@@ -721,6 +919,7 @@ INLINE UINT32 ARG16(void)
   INT8 arg = (INT8)ARG(); /* ARG() also increments PC */  \
   PC += arg;        /* so don't do PC += ARG() */         \
   WZ = PC;                                                \
+  IDLE_LOOP(arg < 0)                                      \
 }
 
 /***************************************************************
@@ -3383,6 +3582,31 @@ void z80_init(const void *config, int (*irqcallback)(int))
   cc[Z80_TABLE_xy] = cc_xy;
   cc[Z80_TABLE_xycb] = cc_xycb;
   cc[Z80_TABLE_ex] = cc_ex;
+
+#ifdef USE_IDLE_SKIP
+  /* reset skipped cycles counter */
+  z80_idle_cycles = 0;
+#endif
+
+  /* memory handlers are used until memory map is set up */
+  memset(z80_readmap_direct, 0, sizeof(z80_readmap_direct));
+  memset(z80_writemap_direct, 0, sizeof(z80_writemap_direct));
+
+#ifdef USE_Z80_THREADED
+  z80_threaded = 1;
+#endif
+
+  /* snapshot areas */
+  snapshot_var(Z80);
+  snapshot_var(EA);
+  snapshot_var(z80_readmap);
+  snapshot_var(z80_writemap);
+  snapshot_var(z80_readmem);
+  snapshot_var(z80_writemem);
+  snapshot_var(z80_readport);
+  snapshot_var(z80_writeport);
+  snapshot_var(z80_readmap_direct);
+  snapshot_var(z80_writemap_direct);
 }
 
 /****************************************************************************
@@ -3403,11 +3627,377 @@ void z80_reset(void)
   WZ=PCD;
 }
 
+#ifdef USE_Z80_THREADED
+/****************************************************************************
+ * Threaded code execution, using GCC "labels as values" extension: opcode
+ * handlers are expanded one after the other and each one is followed by its
+ * own copy of the dispatch code, jumping directly to next opcode handler.
+ * CB, ED, DD & FD prefixes (and DD CB / FD CB) jump to the handlers of the
+ * prefixed opcode instead of calling them through the EXEC() tables.
+ ****************************************************************************/
+#define THREADED(prefix,opcode) t_##prefix##_##opcode: prefix##_##opcode(); NEXT_OPCODE
+
+#define THREADED_LABELS(prefix) { \
+  &&t_##prefix##_00,&&t_##prefix##_01,&&t_##prefix##_02,&&t_##prefix##_03,&&t_##prefix##_04,&&t_##prefix##_05,&&t_##prefix##_06,&&t_##prefix##_07, \
+  &&t_##prefix##_08,&&t_##prefix##_09,&&t_##prefix##_0a,&&t_##prefix##_0b,&&t_##prefix##_0c,&&t_##prefix##_0d,&&t_##prefix##_0e,&&t_##prefix##_0f, \
+  &&t_##prefix##_10,&&t_##prefix##_11,&&t_##prefix##_12,&&t_##prefix##_13,&&t_##prefix##_14,&&t_##prefix##_15,&&t_##prefix##_16,&&t_##prefix##_17, \
+  &&t_##prefix##_18,&&t_##prefix##_19,&&t_##prefix##_1a,&&t_##prefix##_1b,&&t_##prefix##_1c,&&t_##prefix##_1d,&&t_##prefix##_1e,&&t_##prefix##_1f, \
+  &&t_##prefix##_20,&&t_##prefix##_21,&&t_##prefix##_22,&&t_##prefix##_23,&&t_##prefix##_24,&&t_##prefix##_25,&&t_##prefix##_26,&&t_##prefix##_27, \
+  &&t_##prefix##_28,&&t_##prefix##_29,&&t_##prefix##_2a,&&t_##prefix##_2b,&&t_##prefix##_2c,&&t_##prefix##_2d,&&t_##prefix##_2e,&&t_##prefix##_2f, \
+  &&t_##prefix##_30,&&t_##prefix##_31,&&t_##prefix##_32,&&t_##prefix##_33,&&t_##prefix##_34,&&t_##prefix##_35,&&t_##prefix##_36,&&t_##prefix##_37, \
+  &&t_##prefix##_38,&&t_##prefix##_39,&&t_##prefix##_3a,&&t_##prefix##_3b,&&t_##prefix##_3c,&&t_##prefix##_3d,&&t_##prefix##_3e,&&t_##prefix##_3f, \
+  &&t_##prefix##_40,&&t_##prefix##_41,&&t_##prefix##_42,&&t_##prefix##_43,&&t_##prefix##_44,&&t_##prefix##_45,&&t_##prefix##_46,&&t_##prefix##_47, \
+  &&t_##prefix##_48,&&t_##prefix##_49,&&t_##prefix##_4a,&&t_##prefix##_4b,&&t_##prefix##_4c,&&t_##prefix##_4d,&&t_##prefix##_4e,&&t_##prefix##_4f, \
+  &&t_##prefix##_50,&&t_##prefix##_51,&&t_##prefix##_52,&&t_##prefix##_53,&&t_##prefix##_54,&&t_##prefix##_55,&&t_##prefix##_56,&&t_##prefix##_57, \
+  &&t_##prefix##_58,&&t_##prefix##_59,&&t_##prefix##_5a,&&t_##prefix##_5b,&&t_##prefix##_5c,&&t_##prefix##_5d,&&t_##prefix##_5e,&&t_##prefix##_5f, \
+  &&t_##prefix##_60,&&t_##prefix##_61,&&t_##prefix##_62,&&t_##prefix##_63,&&t_##prefix##_64,&&t_##prefix##_65,&&t_##prefix##_66,&&t_##prefix##_67, \
+  &&t_##prefix##_68,&&t_##prefix##_69,&&t_##prefix##_6a,&&t_##prefix##_6b,&&t_##prefix##_6c,&&t_##prefix##_6d,&&t_##prefix##_6e,&&t_##prefix##_6f, \
+  &&t_##prefix##_70,&&t_##prefix##_71,&&t_##prefix##_72,&&t_##prefix##_73,&&t_##prefix##_74,&&t_##prefix##_75,&&t_##prefix##_76,&&t_##prefix##_77, \
+  &&t_##prefix##_78,&&t_##prefix##_79,&&t_##prefix##_7a,&&t_##prefix##_7b,&&t_##prefix##_7c,&&t_##prefix##_7d,&&t_##prefix##_7e,&&t_##prefix##_7f, \
+  &&t_##prefix##_80,&&t_##prefix##_81,&&t_##prefix##_82,&&t_##prefix##_83,&&t_##prefix##_84,&&t_##prefix##_85,&&t_##prefix##_86,&&t_##prefix##_87, \
+  &&t_##prefix##_88,&&t_##prefix##_89,&&t_##prefix##_8a,&&t_##prefix##_8b,&&t_##prefix##_8c,&&t_##prefix##_8d,&&t_##prefix##_8e,&&t_##prefix##_8f, \
+  &&t_##prefix##_90,&&t_##prefix##_91,&&t_##prefix##_92,&&t_##prefix##_93,&&t_##prefix##_94,&&t_##prefix##_95,&&t_##prefix##_96,&&t_##prefix##_97, \
+  &&t_##prefix##_98,&&t_##prefix##_99,&&t_##prefix##_9a,&&t_##prefix##_9b,&&t_##prefix##_9c,&&t_##prefix##_9d,&&t_##prefix##_9e,&&t_##prefix##_9f, \
+  &&t_##prefix##_a0,&&t_##prefix##_a1,&&t_##prefix##_a2,&&t_##prefix##_a3,&&t_##prefix##_a4,&&t_##prefix##_a5,&&t_##prefix##_a6,&&t_##prefix##_a7, \
+  &&t_##prefix##_a8,&&t_##prefix##_a9,&&t_##prefix##_aa,&&t_##prefix##_ab,&&t_##prefix##_ac,&&t_##prefix##_ad,&&t_##prefix##_ae,&&t_##prefix##_af, \
+  &&t_##prefix##_b0,&&t_##prefix##_b1,&&t_##prefix##_b2,&&t_##prefix##_b3,&&t_##prefix##_b4,&&t_##prefix##_b5,&&t_##prefix##_b6,&&t_##prefix##_b7, \
+  &&t_##prefix##_b8,&&t_##prefix##_b9,&&t_##prefix##_ba,&&t_##prefix##_bb,&&t_##prefix##_bc,&&t_##prefix##_bd,&&t_##prefix##_be,&&t_##prefix##_bf, \
+  &&t_##prefix##_c0,&&t_##prefix##_c1,&&t_##prefix##_c2,&&t_##prefix##_c3,&&t_##prefix##_c4,&&t_##prefix##_c5,&&t_##prefix##_c6,&&t_##prefix##_c7, \
+  &&t_##prefix##_c8,&&t_##prefix##_c9,&&t_##prefix##_ca,&&t_##prefix##_cb,&&t_##prefix##_cc,&&t_##prefix##_cd,&&t_##prefix##_ce,&&t_##prefix##_cf, \
+  &&t_##prefix##_d0,&&t_##prefix##_d1,&&t_##prefix##_d2,&&t_##prefix##_d3,&&t_##prefix##_d4,&&t_##prefix##_d5,&&t_##prefix##_d6,&&t_##prefix##_d7, \
+  &&t_##prefix##_d8,&&t_##prefix##_d9,&&t_##prefix##_da,&&t_##prefix##_db,&&t_##prefix##_dc,&&t_##prefix##_dd,&&t_##prefix##_de,&&t_##prefix##_df, \
+  &&t_##prefix##_e0,&&t_##prefix##_e1,&&t_##prefix##_e2,&&t_##prefix##_e3,&&t_##prefix##_e4,&&t_##prefix##_e5,&&t_##prefix##_e6,&&t_##prefix##_e7, \
+  &&t_##prefix##_e8,&&t_##prefix##_e9,&&t_##prefix##_ea,&&t_##prefix##_eb,&&t_##prefix##_ec,&&t_##prefix##_ed,&&t_##prefix##_ee,&&t_##prefix##_ef, \
+  &&t_##prefix##_f0,&&t_##prefix##_f1,&&t_##prefix##_f2,&&t_##prefix##_f3,&&t_##prefix##_f4,&&t_##prefix##_f5,&&t_##prefix##_f6,&&t_##prefix##_f7, \
+  &&t_##prefix##_f8,&&t_##prefix##_f9,&&t_##prefix##_fa,&&t_##prefix##_fb,&&t_##prefix##_fc,&&t_##prefix##_fd,&&t_##prefix##_fe,&&t_##prefix##_ff  \
+}
+
+#define NEXT_OPCODE                             \
+{                                               \
+  if (Z80.cycles >= cycles) return;             \
+                                                \
+  /* check for IRQs before each instruction */  \
+  if (Z80.irq_state && IFF1 && !Z80.after_ei)   \
+  {                                             \
+    take_interrupt();                           \
+    if (Z80.cycles >= cycles) return;           \
+  }                                             \
+                                                \
+  Z80.after_ei = FALSE;                         \
+  R++;                                          \
+  opcode = ROP();                               \
+  USE_CYCLES(cc_op[opcode]);                    \
+  goto *op_labels[opcode];                      \
+}
+
+static void z80_run_threaded(unsigned int cycles)
+{
+  static const void *const op_labels[0x100] = THREADED_LABELS(op);
+  static const void *const cb_labels[0x100] = THREADED_LABELS(cb);
+  static const void *const ed_labels[0x100] = THREADED_LABELS(ed);
+  static const void *const dd_labels[0x100] = THREADED_LABELS(dd);
+  static const void *const fd_labels[0x100] = THREADED_LABELS(fd);
+  static const void *const xycb_labels[0x100] = THREADED_LABELS(xycb);
+  unsigned opcode;
+
+  NEXT_OPCODE
+
+  /* prefixes */
+  t_op_cb: R++; opcode = ROP(); USE_CYCLES(cc_cb[opcode]); goto *cb_labels[opcode];
+  t_op_ed: R++; opcode = ROP(); USE_CYCLES(cc_ed[opcode]); goto *ed_labels[opcode];
+  t_op_dd: R++; opcode = ROP(); USE_CYCLES(cc_xy[opcode]); goto *dd_labels[opcode];
+  t_op_fd: R++; opcode = ROP(); USE_CYCLES(cc_xy[opcode]); goto *fd_labels[opcode];
+  t_dd_cb: EAX; opcode = ARG(); USE_CYCLES(cc_xycb[opcode]); goto *xycb_labels[opcode];
+  t_fd_cb: EAY; opcode = ARG(); USE_CYCLES(cc_xycb[opcode]); goto *xycb_labels[opcode];
+
+  /* main opcodes */
+  THREADED(op,00) THREADED(op,01) THREADED(op,02) THREADED(op,03) THREADED(op,04) THREADED(op,05) THREADED(op,06) THREADED(op,07)
+  THREADED(op,08) THREADED(op,09) THREADED(op,0a) THREADED(op,0b) THREADED(op,0c) THREADED(op,0d) THREADED(op,0e) THREADED(op,0f)
+  THREADED(op,10) THREADED(op,11) THREADED(op,12) THREADED(op,13) THREADED(op,14) THREADED(op,15) THREADED(op,16) THREADED(op,17)
+  THREADED(op,18) THREADED(op,19) THREADED(op,1a) THREADED(op,1b) THREADED(op,1c) THREADED(op,1d) THREADED(op,1e) THREADED(op,1f)
+  THREADED(op,20) THREADED(op,21) THREADED(op,22) THREADED(op,23) THREADED(op,24) THREADED(op,25) THREADED(op,26) THREADED(op,27)
+  THREADED(op,28) THREADED(op,29) THREADED(op,2a) THREADED(op,2b) THREADED(op,2c) THREADED(op,2d) THREADED(op,2e) THREADED(op,2f)
+  THREADED(op,30) THREADED(op,31) THREADED(op,32) THREADED(op,33) THREADED(op,34) THREADED(op,35) THREADED(op,36) THREADED(op,37)
+  THREADED(op,38) THREADED(op,39) THREADED(op,3a) THREADED(op,3b) THREADED(op,3c) THREADED(op,3d) THREADED(op,3e) THREADED(op,3f)
+  THREADED(op,40) THREADED(op,41) THREADED(op,42) THREADED(op,43) THREADED(op,44) THREADED(op,45) THREADED(op,46) THREADED(op,47)
+  THREADED(op,48) THREADED(op,49) THREADED(op,4a) THREADED(op,4b) THREADED(op,4c) THREADED(op,4d) THREADED(op,4e) THREADED(op,4f)
+  THREADED(op,50) THREADED(op,51) THREADED(op,52) THREADED(op,53) THREADED(op,54) THREADED(op,55) THREADED(op,56) THREADED(op,57)
+  THREADED(op,58) THREADED(op,59) THREADED(op,5a) THREADED(op,5b) THREADED(op,5c) THREADED(op,5d) THREADED(op,5e) THREADED(op,5f)
+  THREADED(op,60) THREADED(op,61) THREADED(op,62) THREADED(op,63) THREADED(op,64) THREADED(op,65) THREADED(op,66) THREADED(op,67)
+  THREADED(op,68) THREADED(op,69) THREADED(op,6a) THREADED(op,6b) THREADED(op,6c) THREADED(op,6d) THREADED(op,6e) THREADED(op,6f)
+  THREADED(op,70) THREADED(op,71) THREADED(op,72) THREADED(op,73) THREADED(op,74) THREADED(op,75) THREADED(op,76) THREADED(op,77)
+  THREADED(op,78) THREADED(op,79) THREADED(op,7a) THREADED(op,7b) THREADED(op,7c) THREADED(op,7d) THREADED(op,7e) THREADED(op,7f)
+  THREADED(op,80) THREADED(op,81) THREADED(op,82) THREADED(op,83) THREADED(op,84) THREADED(op,85) THREADED(op,86) THREADED(op,87)
+  THREADED(op,88) THREADED(op,89) THREADED(op,8a) THREADED(op,8b) THREADED(op,8c) THREADED(op,8d) THREADED(op,8e) THREADED(op,8f)
+  THREADED(op,90) THREADED(op,91) THREADED(op,92) THREADED(op,93) THREADED(op,94) THREADED(op,95) THREADED(op,96) THREADED(op,97)
+  THREADED(op,98) THREADED(op,99) THREADED(op,9a) THREADED(op,9b) THREADED(op,9c) THREADED(op,9d) THREADED(op,9e) THREADED(op,9f)
+  THREADED(op,a0) THREADED(op,a1) THREADED(op,a2) THREADED(op,a3) THREADED(op,a4) THREADED(op,a5) THREADED(op,a6) THREADED(op,a7)
+  THREADED(op,a8) THREADED(op,a9) THREADED(op,aa) THREADED(op,ab) THREADED(op,ac) THREADED(op,ad) THREADED(op,ae) THREADED(op,af)
+  THREADED(op,b0) THREADED(op,b1) THREADED(op,b2) THREADED(op,b3) THREADED(op,b4) THREADED(op,b5) THREADED(op,b6) THREADED(op,b7)
+  THREADED(op,b8) THREADED(op,b9) THREADED(op,ba) THREADED(op,bb) THREADED(op,bc) THREADED(op,bd) THREADED(op,be) THREADED(op,bf)
+  THREADED(op,c0) THREADED(op,c1) THREADED(op,c2) THREADED(op,c3) THREADED(op,c4) THREADED(op,c5) THREADED(op,c6) THREADED(op,c7)
+  THREADED(op,c8) THREADED(op,c9) THREADED(op,ca) THREADED(op,cc) THREADED(op,cd) THREADED(op,ce) THREADED(op,cf)
+  THREADED(op,d0) THREADED(op,d1) THREADED(op,d2) THREADED(op,d3) THREADED(op,d4) THREADED(op,d5) THREADED(op,d6) THREADED(op,d7)
+  THREADED(op,d8) THREADED(op,d9) THREADED(op,da) THREADED(op,db) THREADED(op,dc) THREADED(op,de) THREADED(op,df)
+  THREADED(op,e0) THREADED(op,e1) THREADED(op,e2) THREADED(op,e3) THREADED(op,e4) THREADED(op,e5) THREADED(op,e6) THREADED(op,e7)
+  THREADED(op,e8) THREADED(op,e9) THREADED(op,ea) THREADED(op,eb) THREADED(op,ec) THREADED(op,ee) THREADED(op,ef)
+  THREADED(op,f0) THREADED(op,f1) THREADED(op,f2) THREADED(op,f3) THREADED(op,f4) THREADED(op,f5) THREADED(op,f6) THREADED(op,f7)
+  THREADED(op,f8) THREADED(op,f9) THREADED(op,fa) THREADED(op,fb) THREADED(op,fc) THREADED(op,fe) THREADED(op,ff)
+
+  /* CB xx opcodes */
+  THREADED(cb,00) THREADED(cb,01) THREADED(cb,02) THREADED(cb,03) THREADED(cb,04) THREADED(cb,05) THREADED(cb,06) THREADED(cb,07)
+  THREADED(cb,08) THREADED(cb,09) THREADED(cb,0a) THREADED(cb,0b) THREADED(cb,0c) THREADED(cb,0d) THREADED(cb,0e) THREADED(cb,0f)
+  THREADED(cb,10) THREADED(cb,11) THREADED(cb,12) THREADED(cb,13) THREADED(cb,14) THREADED(cb,15) THREADED(cb,16) THREADED(cb,17)
+  THREADED(cb,18) THREADED(cb,19) THREADED(cb,1a) THREADED(cb,1b) THREADED(cb,1c) THREADED(cb,1d) THREADED(cb,1e) THREADED(cb,1f)
+  THREADED(cb,20) THREADED(cb,21) THREADED(cb,22) THREADED(cb,23) THREADED(cb,24) THREADED(cb,25) THREADED(cb,26) THREADED(cb,27)
+  THREADED(cb,28) THREADED(cb,29) THREADED(cb,2a) THREADED(cb,2b) THREADED(cb,2c) THREADED(cb,2d) THREADED(cb,2e) THREADED(cb,2f)
+  THREADED(cb,30) THREADED(cb,31) THREADED(cb,32) THREADED(cb,33) THREADED(cb,34) THREADED(cb,35) THREADED(cb,36) THREADED(cb,37)
+  THREADED(cb,38) THREADED(cb,39) THREADED(cb,3a) THREADED(cb,3b) THREADED(cb,3c) THREADED(cb,3d) THREADED(cb,3e) THREADED(cb,3f)
+  THREADED(cb,40) THREADED(cb,41) THREADED(cb,42) THREADED(cb,43) THREADED(cb,44) THREADED(cb,45) THREADED(cb,46) THREADED(cb,47)
+  THREADED(cb,48) THREADED(cb,49) THREADED(cb,4a) THREADED(cb,4b) THREADED(cb,4c) THREADED(cb,4d) THREADED(cb,4e) THREADED(cb,4f)
+  THREADED(cb,50) THREADED(cb,51) THREADED(cb,52) THREADED(cb,53) THREADED(cb,54) THREADED(cb,55) THREADED(cb,56) THREADED(cb,57)
+  THREADED(cb,58) THREADED(cb,59) THREADED(cb,5a) THREADED(cb,5b) THREADED(cb,5c) THREADED(cb,5d) THREADED(cb,5e) THREADED(cb,5f)
+  THREADED(cb,60) THREADED(cb,61) THREADED(cb,62) THREADED(cb,63) THREADED(cb,64) THREADED(cb,65) THREADED(cb,66) THREADED(cb,67)
+  THREADED(cb,68) THREADED(cb,69) THREADED(cb,6a) THREADED(cb,6b) THREADED(cb,6c) THREADED(cb,6d) THREADED(cb,6e) THREADED(cb,6f)
+  THREADED(cb,70) THREADED(cb,71) THREADED(cb,72) THREADED(cb,73) THREADED(cb,74) THREADED(cb,75) THREADED(cb,76) THREADED(cb,77)
+  THREADED(cb,78) THREADED(cb,79) THREADED(cb,7a) THREADED(cb,7b) THREADED(cb,7c) THREADED(cb,7d) THREADED(cb,7e) THREADED(cb,7f)
+  THREADED(cb,80) THREADED(cb,81) THREADED(cb,82) THREADED(cb,83) THREADED(cb,84) THREADED(cb,85) THREADED(cb,86) THREADED(cb,87)
+  THREADED(cb,88) THREADED(cb,89) THREADED(cb,8a) THREADED(cb,8b) THREADED(cb,8c) THREADED(cb,8d) THREADED(cb,8e) THREADED(cb,8f)
+  THREADED(cb,90) THREADED(cb,91) THREADED(cb,92) THREADED(cb,93) THREADED(cb,94) THREADED(cb,95) THREADED(cb,96) THREADED(cb,97)
+  THREADED(cb,98) THREADED(cb,99) THREADED(cb,9a) THREADED(cb,9b) THREADED(cb,9c) THREADED(cb,9d) THREADED(cb,9e) THREADED(cb,9f)
+  THREADED(cb,a0) THREADED(cb,a1) THREADED(cb,a2) THREADED(cb,a3) THREADED(cb,a4) THREADED(cb,a5) THREADED(cb,a6) THREADED(cb,a7)
+  THREADED(cb,a8) THREADED(cb,a9) THREADED(cb,aa) THREADED(cb,ab) THREADED(cb,ac) THREADED(cb,ad) THREADED(cb,ae) THREADED(cb,af)
+  THREADED(cb,b0) THREADED(cb,b1) THREADED(cb,b2) THREADED(cb,b3) THREADED(cb,b4) THREADED(cb,b5) THREADED(cb,b6) THREADED(cb,b7)
+  THREADED(cb,b8) THREADED(cb,b9) THREADED(cb,ba) THREADED(cb,bb) THREADED(cb,bc) THREADED(cb,bd) THREADED(cb,be) THREADED(cb,bf)
+  THREADED(cb,c0) THREADED(cb,c1) THREADED(cb,c2) THREADED(cb,c3) THREADED(cb,c4) THREADED(cb,c5) THREADED(cb,c6) THREADED(cb,c7)
+  THREADED(cb,c8) THREADED(cb,c9) THREADED(cb,ca) THREADED(cb,cb) THREADED(cb,cc) THREADED(cb,cd) THREADED(cb,ce) THREADED(cb,cf)
+  THREADED(cb,d0) THREADED(cb,d1) THREADED(cb,d2) THREADED(cb,d3) THREADED(cb,d4) THREADED(cb,d5) THREADED(cb,d6) THREADED(cb,d7)
+  THREADED(cb,d8) THREADED(cb,d9) THREADED(cb,da) THREADED(cb,db) THREADED(cb,dc) THREADED(cb,dd) THREADED(cb,de) THREADED(cb,df)
+  THREADED(cb,e0) THREADED(cb,e1) THREADED(cb,e2) THREADED(cb,e3) THREADED(cb,e4) THREADED(cb,e5) THREADED(cb,e6) THREADED(cb,e7)
+  THREADED(cb,e8) THREADED(cb,e9) THREADED(cb,ea) THREADED(cb,eb) THREADED(cb,ec) THREADED(cb,ed) THREADED(cb,ee) THREADED(cb,ef)
+  THREADED(cb,f0) THREADED(cb,f1) THREADED(cb,f2) THREADED(cb,f3) THREADED(cb,f4) THREADED(cb,f5) THREADED(cb,f6) THREADED(cb,f7)
+  THREADED(cb,f8) THREADED(cb,f9) THREADED(cb,fa) THREADED(cb,fb) THREADED(cb,fc) THREADED(cb,fd) THREADED(cb,fe) THREADED(cb,ff)
+
+  /* ED xx opcodes */
+  THREADED(ed,00) THREADED(ed,01) THREADED(ed,02) THREADED(ed,03) THREADED(ed,04) THREADED(ed,05) THREADED(ed,06) THREADED(ed,07)
+  THREADED(ed,08) THREADED(ed,09) THREADED(ed,0a) THREADED(ed,0b) THREADED(ed,0c) THREADED(ed,0d) THREADED(ed,0e) THREADED(ed,0f)
+  THREADED(ed,10) THREADED(ed,11) THREADED(ed,12) THREADED(ed,13) THREADED(ed,14) THREADED(ed,15) THREADED(ed,16) THREADED(ed,17)
+  THREADED(ed,18) THREADED(ed,19) THREADED(ed,1a) THREADED(ed,1b) THREADED(ed,1c) THREADED(ed,1d) THREADED(ed,1e) THREADED(ed,1f)
+  THREADED(ed,20) THREADED(ed,21) THREADED(ed,22) THREADED(ed,23) THREADED(ed,24) THREADED(ed,25) THREADED(ed,26) THREADED(ed,27)
+  THREADED(ed,28) THREADED(ed,29) THREADED(ed,2a) THREADED(ed,2b) THREADED(ed,2c) THREADED(ed,2d) THREADED(ed,2e) THREADED(ed,2f)
+  THREADED(ed,30) THREADED(ed,31) THREADED(ed,32) THREADED(ed,33) THREADED(ed,34) THREADED(ed,35) THREADED(ed,36) THREADED(ed,37)
+  THREADED(ed,38) THREADED(ed,39) THREADED(ed,3a) THREADED(ed,3b) THREADED(ed,3c) THREADED(ed,3d) THREADED(ed,3e) THREADED(ed,3f)
+  THREADED(ed,40) THREADED(ed,41) THREADED(ed,42) THREADED(ed,43) THREADED(ed,44) THREADED(ed,45) THREADED(ed,46) THREADED(ed,47)
+  THREADED(ed,48) THREADED(ed,49) THREADED(ed,4a) THREADED(ed,4b) THREADED(ed,4c) THREADED(ed,4d) THREADED(ed,4e) THREADED(ed,4f)
+  THREADED(ed,50) THREADED(ed,51) THREADED(ed,52) THREADED(ed,53) THREADED(ed,54) THREADED(ed,55) THREADED(ed,56) THREADED(ed,57)
+  THREADED(ed,58) THREADED(ed,59) THREADED(ed,5a) THREADED(ed,5b) THREADED(ed,5c) THREADED(ed,5d) THREADED(ed,5e) THREADED(ed,5f)
+  THREADED(ed,60) THREADED(ed,61) THREADED(ed,62) THREADED(ed,63) THREADED(ed,64) THREADED(ed,65) THREADED(ed,66) THREADED(ed,67)
+  THREADED(ed,68) THREADED(ed,69) THREADED(ed,6a) THREADED(ed,6b) THREADED(ed,6c) THREADED(ed,6d) THREADED(ed,6e) THREADED(ed,6f)
+  THREADED(ed,70) THREADED(ed,71) THREADED(ed,72) THREADED(ed,73) THREADED(ed,74) THREADED(ed,75) THREADED(ed,76) THREADED(ed,77)
+  THREADED(ed,78) THREADED(ed,79) THREADED(ed,7a) THREADED(ed,7b) THREADED(ed,7c) THREADED(ed,7d) THREADED(ed,7e) THREADED(ed,7f)
+  THREADED(ed,80) THREADED(ed,81) THREADED(ed,82) THREADED(ed,83) THREADED(ed,84) THREADED(ed,85) THREADED(ed,86) THREADED(ed,87)
+  THREADED(ed,88) THREADED(ed,89) THREADED(ed,8a) THREADED(ed,8b) THREADED(ed,8c) THREADED(ed,8d) THREADED(ed,8e) THREADED(ed,8f)
+  THREADED(ed,90) THREADED(ed,91) THREADED(ed,92) THREADED(ed,93) THREADED(ed,94) THREADED(ed,95) THREADED(ed,96) THREADED(ed,97)
+  THREADED(ed,98) THREADED(ed,99) THREADED(ed,9a) THREADED(ed,9b) THREADED(ed,9c) THREADED(ed,9d) THREADED(ed,9e) THREADED(ed,9f)
+  THREADED(ed,a0) THREADED(ed,a1) THREADED(ed,a2) THREADED(ed,a3) THREADED(ed,a4) THREADED(ed,a5) THREADED(ed,a6) THREADED(ed,a7)
+  THREADED(ed,a8) THREADED(ed,a9) THREADED(ed,aa) THREADED(ed,ab) THREADED(ed,ac) THREADED(ed,ad) THREADED(ed,ae) THREADED(ed,af)
+  THREADED(ed,b0) THREADED(ed,b1) THREADED(ed,b2) THREADED(ed,b3) THREADED(ed,b4) THREADED(ed,b5) THREADED(ed,b6) THREADED(ed,b7)
+  THREADED(ed,b8) THREADED(ed,b9) THREADED(ed,ba) THREADED(ed,bb) THREADED(ed,bc) THREADED(ed,bd) THREADED(ed,be) THREADED(ed,bf)
+  THREADED(ed,c0) THREADED(ed,c1) THREADED(ed,c2) THREADED(ed,c3) THREADED(ed,c4) THREADED(ed,c5) THREADED(ed,c6) THREADED(ed,c7)
+  THREADED(ed,c8) THREADED(ed,c9) THREADED(ed,ca) THREADED(ed,cb) THREADED(ed,cc) THREADED(ed,cd) THREADED(ed,ce) THREADED(ed,cf)
+  THREADED(ed,d0) THREADED(ed,d1) THREADED(ed,d2) THREADED(ed,d3) THREADED(ed,d4) THREADED(ed,d5) THREADED(ed,d6) THREADED(ed,d7)
+  THREADED(ed,d8) THREADED(ed,d9) THREADED(ed,da) THREADED(ed,db) THREADED(ed,dc) THREADED(ed,dd) THREADED(ed,de) THREADED(ed,df)
+  THREADED(ed,e0) THREADED(ed,e1) THREADED(ed,e2) THREADED(ed,e3) THREADED(ed,e4) THREADED(ed,e5) THREADED(ed,e6) THREADED(ed,e7)
+  THREADED(ed,e8) THREADED(ed,e9) THREADED(ed,ea) THREADED(ed,eb) THREADED(ed,ec) THREADED(ed,ed) THREADED(ed,ee) THREADED(ed,ef)
+  THREADED(ed,f0) THREADED(ed,f1) THREADED(ed,f2) THREADED(ed,f3) THREADED(ed,f4) THREADED(ed,f5) THREADED(ed,f6) THREADED(ed,f7)
+  THREADED(ed,f8) THREADED(ed,f9) THREADED(ed,fa) THREADED(ed,fb) THREADED(ed,fc) THREADED(ed,fd) THREADED(ed,fe) THREADED(ed,ff)
+
+  /* DD xx opcodes */
+  THREADED(dd,00) THREADED(dd,01) THREADED(dd,02) THREADED(dd,03) THREADED(dd,04) THREADED(dd,05) THREADED(dd,06) THREADED(dd,07)
+  THREADED(dd,08) THREADED(dd,09) THREADED(dd,0a) THREADED(dd,0b) THREADED(dd,0c) THREADED(dd,0d) THREADED(dd,0e) THREADED(dd,0f)
+  THREADED(dd,10) THREADED(dd,11) THREADED(dd,12) THREADED(dd,13) THREADED(dd,14) THREADED(dd,15) THREADED(dd,16) THREADED(dd,17)
+  THREADED(dd,18) THREADED(dd,19) THREADED(dd,1a) THREADED(dd,1b) THREADED(dd,1c) THREADED(dd,1d) THREADED(dd,1e) THREADED(dd,1f)
+  THREADED(dd,20) THREADED(dd,21) THREADED(dd,22) THREADED(dd,23) THREADED(dd,24) THREADED(dd,25) THREADED(dd,26) THREADED(dd,27)
+  THREADED(dd,28) THREADED(dd,29) THREADED(dd,2a) THREADED(dd,2b) THREADED(dd,2c) THREADED(dd,2d) THREADED(dd,2e) THREADED(dd,2f)
+  THREADED(dd,30) THREADED(dd,31) THREADED(dd,32) THREADED(dd,33) THREADED(dd,34) THREADED(dd,35) THREADED(dd,36) THREADED(dd,37)
+  THREADED(dd,38) THREADED(dd,39) THREADED(dd,3a) THREADED(dd,3b) THREADED(dd,3c) THREADED(dd,3d) THREADED(dd,3e) THREADED(dd,3f)
+  THREADED(dd,40) THREADED(dd,41) THREADED(dd,42) THREADED(dd,43) THREADED(dd,44) THREADED(dd,45) THREADED(dd,46) THREADED(dd,47)
+  THREADED(dd,48) THREADED(dd,49) THREADED(dd,4a) THREADED(dd,4b) THREADED(dd,4c) THREADED(dd,4d) THREADED(dd,4e) THREADED(dd,4f)
+  THREADED(dd,50) THREADED(dd,51) THREADED(dd,52) THREADED(dd,53) THREADED(dd,54) THREADED(dd,55) THREADED(dd,56) THREADED(dd,57)
+  THREADED(dd,58) THREADED(dd,59) THREADED(dd,5a) THREADED(dd,5b) THREADED(dd,5c) THREADED(dd,5d) THREADED(dd,5e) THREADED(dd,5f)
+  THREADED(dd,60) THREADED(dd,61) THREADED(dd,62) THREADED(dd,63) THREADED(dd,64) THREADED(dd,65) THREADED(dd,66) THREADED(dd,67)
+  THREADED(dd,68) THREADED(dd,69) THREADED(dd,6a) THREADED(dd,6b) THREADED(dd,6c) THREADED(dd,6d) THREADED(dd,6e) THREADED(dd,6f)
+  THREADED(dd,70) THREADED(dd,71) THREADED(dd,72) THREADED(dd,73) THREADED(dd,74) THREADED(dd,75) THREADED(dd,76) THREADED(dd,77)
+  THREADED(dd,78) THREADED(dd,79) THREADED(dd,7a) THREADED(dd,7b) THREADED(dd,7c) THREADED(dd,7d) THREADED(dd,7e) THREADED(dd,7f)
+  THREADED(dd,80) THREADED(dd,81) THREADED(dd,82) THREADED(dd,83) THREADED(dd,84) THREADED(dd,85) THREADED(dd,86) THREADED(dd,87)
+  THREADED(dd,88) THREADED(dd,89) THREADED(dd,8a) THREADED(dd,8b) THREADED(dd,8c) THREADED(dd,8d) THREADED(dd,8e) THREADED(dd,8f)
+  THREADED(dd,90) THREADED(dd,91) THREADED(dd,92) THREADED(dd,93) THREADED(dd,94) THREADED(dd,95) THREADED(dd,96) THREADED(dd,97)
+  THREADED(dd,98) THREADED(dd,99) THREADED(dd,9a) THREADED(dd,9b) THREADED(dd,9c) THREADED(dd,9d) THREADED(dd,9e) THREADED(dd,9f)
+  THREADED(dd,a0) THREADED(dd,a1) THREADED(dd,a2) THREADED(dd,a3) THREADED(dd,a4) THREADED(dd,a5) THREADED(dd,a6) THREADED(dd,a7)
+  THREADED(dd,a8) THREADED(dd,a9) THREADED(dd,aa) THREADED(dd,ab) THREADED(dd,ac) THREADED(dd,ad) THREADED(dd,ae) THREADED(dd,af)
+  THREADED(dd,b0) THREADED(dd,b1) THREADED(dd,b2) THREADED(dd,b3) THREADED(dd,b4) THREADED(dd,b5) THREADED(dd,b6) THREADED(dd,b7)
+  THREADED(dd,b8) THREADED(dd,b9) THREADED(dd,ba) THREADED(dd,bb) THREADED(dd,bc) THREADED(dd,bd) THREADED(dd,be) THREADED(dd,bf)
+  THREADED(dd,c0) THREADED(dd,c1) THREADED(dd,c2) THREADED(dd,c3) THREADED(dd,c4) THREADED(dd,c5) THREADED(dd,c6) THREADED(dd,c7)
+  THREADED(dd,c8) THREADED(dd,c9) THREADED(dd,ca) THREADED(dd,cc) THREADED(dd,cd) THREADED(dd,ce) THREADED(dd,cf)
+  THREADED(dd,d0) THREADED(dd,d1) THREADED(dd,d2) THREADED(dd,d3) THREADED(dd,d4) THREADED(dd,d5) THREADED(dd,d6) THREADED(dd,d7)
+  THREADED(dd,d8) THREADED(dd,d9) THREADED(dd,da) THREADED(dd,db) THREADED(dd,dc) THREADED(dd,dd) THREADED(dd,de) THREADED(dd,df)
+  THREADED(dd,e0) THREADED(dd,e1) THREADED(dd,e2) THREADED(dd,e3) THREADED(dd,e4) THREADED(dd,e5) THREADED(dd,e6) THREADED(dd,e7)
+  THREADED(dd,e8) THREADED(dd,e9) THREADED(dd,ea) THREADED(dd,eb) THREADED(dd,ec) THREADED(dd,ed) THREADED(dd,ee) THREADED(dd,ef)
+  THREADED(dd,f0) THREADED(dd,f1) THREADED(dd,f2) THREADED(dd,f3) THREADED(dd,f4) THREADED(dd,f5) THREADED(dd,f6) THREADED(dd,f7)
+  THREADED(dd,f8) THREADED(dd,f9) THREADED(dd,fa) THREADED(dd,fb) THREADED(dd,fc) THREADED(dd,fd) THREADED(dd,fe) THREADED(dd,ff)
+
+  /* FD xx opcodes */
+  THREADED(fd,00) THREADED(fd,01) THREADED(fd,02) THREADED(fd,03) THREADED(fd,04) THREADED(fd,05) THREADED(fd,06) THREADED(fd,07)
+  THREADED(fd,08) THREADED(fd,09) THREADED(fd,0a) THREADED(fd,0b) THREADED(fd,0c) THREADED(fd,0d) THREADED(fd,0e) THREADED(fd,0f)
+  THREADED(fd,10) THREADED(fd,11) THREADED(fd,12) THREADED(fd,13) THREADED(fd,14) THREADED(fd,15) THREADED(fd,16) THREADED(fd,17)
+  THREADED(fd,18) THREADED(fd,19) THREADED(fd,1a) THREADED(fd,1b) THREADED(fd,1c) THREADED(fd,1d) THREADED(fd,1e) THREADED(fd,1f)
+  THREADED(fd,20) THREADED(fd,21) THREADED(fd,22) THREADED(fd,23) THREADED(fd,24) THREADED(fd,25) THREADED(fd,26) THREADED(fd,27)
+  THREADED(fd,28) THREADED(fd,29) THREADED(fd,2a) THREADED(fd,2b) THREADED(fd,2c) THREADED(fd,2d) THREADED(fd,2e) THREADED(fd,2f)
+  THREADED(fd,30) THREADED(fd,31) THREADED(fd,32) THREADED(fd,33) THREADED(fd,34) THREADED(fd,35) THREADED(fd,36) THREADED(fd,37)
+  THREADED(fd,38) THREADED(fd,39) THREADED(fd,3a) THREADED(fd,3b) THREADED(fd,3c) THREADED(fd,3d) THREADED(fd,3e) THREADED(fd,3f)
+  THREADED(fd,40) THREADED(fd,41) THREADED(fd,42) THREADED(fd,43) THREADED(fd,44) THREADED(fd,45) THREADED(fd,46) THREADED(fd,47)
+  THREADED(fd,48) THREADED(fd,49) THREADED(fd,4a) THREADED(fd,4b) THREADED(fd,4c) THREADED(fd,4d) THREADED(fd,4e) THREADED(fd,4f)
+  THREADED(fd,50) THREADED(fd,51) THREADED(fd,52) THREADED(fd,53) THREADED(fd,54) THREADED(fd,55) THREADED(fd,56) THREADED(fd,57)
+  THREADED(fd,58) THREADED(fd,59) THREADED(fd,5a) THREADED(fd,5b) THREADED(fd,5c) THREADED(fd,5d) THREADED(fd,5e) THREADED(fd,5f)
+  THREADED(fd,60) THREADED(fd,61) THREADED(fd,62) THREADED(fd,63) THREADED(fd,64) THREADED(fd,65) THREADED(fd,66) THREADED(fd,67)
+  THREADED(fd,68) THREADED(fd,69) THREADED(fd,6a) THREADED(fd,6b) THREADED(fd,6c) THREADED(fd,6d) THREADED(fd,6e) THREADED(fd,6f)
+  THREADED(fd,70) THREADED(fd,71) THREADED(fd,72) THREADED(fd,73) THREADED(fd,74) THREADED(fd,75) THREADED(fd,76) THREADED(fd,77)
+  THREADED(fd,78) THREADED(fd,79) THREADED(fd,7a) THREADED(fd,7b) THREADED(fd,7c) THREADED(fd,7d) THREADED(fd,7e) THREADED(fd,7f)
+  THREADED(fd,80) THREADED(fd,81) THREADED(fd,82) THREADED(fd,83) THREADED(fd,84) THREADED(fd,85) THREADED(fd,86) THREADED(fd,87)
+  THREADED(fd,88) THREADED(fd,89) THREADED(fd,8a) THREADED(fd,8b) THREADED(fd,8c) THREADED(fd,8d) THREADED(fd,8e) THREADED(fd,8f)
+  THREADED(fd,90) THREADED(fd,91) THREADED(fd,92) THREADED(fd,93) THREADED(fd,94) THREADED(fd,95) THREADED(fd,96) THREADED(fd,97)
+  THREADED(fd,98) THREADED(fd,99) THREADED(fd,9a) THREADED(fd,9b) THREADED(fd,9c) THREADED(fd,9d) THREADED(fd,9e) THREADED(fd,9f)
+  THREADED(fd,a0) THREADED(fd,a1) THREADED(fd,a2) THREADED(fd,a3) THREADED(fd,a4) THREADED(fd,a5) THREADED(fd,a6) THREADED(fd,a7)
+  THREADED(fd,a8) THREADED(fd,a9) THREADED(fd,aa) THREADED(fd,ab) THREADED(fd,ac) THREADED(fd,ad) THREADED(fd,ae) THREADED(fd,af)
+  THREADED(fd,b0) THREADED(fd,b1) THREADED(fd,b2) THREADED(fd,b3) THREADED(fd,b4) THREADED(fd,b5) THREADED(fd,b6) THREADED(fd,b7)
+  THREADED(fd,b8) THREADED(fd,b9) THREADED(fd,ba) THREADED(fd,bb) THREADED(fd,bc) THREADED(fd,bd) THREADED(fd,be) THREADED(fd,bf)
+  THREADED(fd,c0) THREADED(fd,c1) THREADED(fd,c2) THREADED(fd,c3) THREADED(fd,c4) THREADED(fd,c5) THREADED(fd,c6) THREADED(fd,c7)
+  THREADED(fd,c8) THREADED(fd,c9) THREADED(fd,ca) THREADED(fd,cc) THREADED(fd,cd) THREADED(fd,ce) THREADED(fd,cf)
+  THREADED(fd,d0) THREADED(fd,d1) THREADED(fd,d2) THREADED(fd,d3) THREADED(fd,d4) THREADED(fd,d5) THREADED(fd,d6) THREADED(fd,d7)
+  THREADED(fd,d8) THREADED(fd,d9) THREADED(fd,da) THREADED(fd,db) THREADED(fd,dc) THREADED(fd,dd) THREADED(fd,de) THREADED(fd,df)
+  THREADED(fd,e0) THREADED(fd,e1) THREADED(fd,e2) THREADED(fd,e3) THREADED(fd,e4) THREADED(fd,e5) THREADED(fd,e6) THREADED(fd,e7)
+  THREADED(fd,e8) THREADED(fd,e9) THREADED(fd,ea) THREADED(fd,eb) THREADED(fd,ec) THREADED(fd,ed) THREADED(fd,ee) THREADED(fd,ef)
+  THREADED(fd,f0) THREADED(fd,f1) THREADED(fd,f2) THREADED(fd,f3) THREADED(fd,f4) THREADED(fd,f5) THREADED(fd,f6) THREADED(fd,f7)
+  THREADED(fd,f8) THREADED(fd,f9) THREADED(fd,fa) THREADED(fd,fb) THREADED(fd,fc) THREADED(fd,fd) THREADED(fd,fe) THREADED(fd,ff)
+
+  /* DD CB xx / FD CB xx opcodes */
+  THREADED(xycb,00) THREADED(xycb,01) THREADED(xycb,02) THREADED(xycb,03) THREADED(xycb,04) THREADED(xycb,05) THREADED(xycb,06) THREADED(xycb,07)
+  THREADED(xycb,08) THREADED(xycb,09) THREADED(xycb,0a) THREADED(xycb,0b) THREADED(xycb,0c) THREADED(xycb,0d) THREADED(xycb,0e) THREADED(xycb,0f)
+  THREADED(xycb,10) THREADED(xycb,11) THREADED(xycb,12) THREADED(xycb,13) THREADED(xycb,14) THREADED(xycb,15) THREADED(xycb,16) THREADED(xycb,17)
+  THREADED(xycb,18) THREADED(xycb,19) THREADED(xycb,1a) THREADED(xycb,1b) THREADED(xycb,1c) THREADED(xycb,1d) THREADED(xycb,1e) THREADED(xycb,1f)
+  THREADED(xycb,20) THREADED(xycb,21) THREADED(xycb,22) THREADED(xycb,23) THREADED(xycb,24) THREADED(xycb,25) THREADED(xycb,26) THREADED(xycb,27)
+  THREADED(xycb,28) THREADED(xycb,29) THREADED(xycb,2a) THREADED(xycb,2b) THREADED(xycb,2c) THREADED(xycb,2d) THREADED(xycb,2e) THREADED(xycb,2f)
+  THREADED(xycb,30) THREADED(xycb,31) THREADED(xycb,32) THREADED(xycb,33) THREADED(xycb,34) THREADED(xycb,35) THREADED(xycb,36) THREADED(xycb,37)
+  THREADED(xycb,38) THREADED(xycb,39) THREADED(xycb,3a) THREADED(xycb,3b) THREADED(xycb,3c) THREADED(xycb,3d) THREADED(xycb,3e) THREADED(xycb,3f)
+  THREADED(xycb,40) THREADED(xycb,41) THREADED(xycb,42) THREADED(xycb,43) THREADED(xycb,44) THREADED(xycb,45) THREADED(xycb,46) THREADED(xycb,47)
+  THREADED(xycb,48) THREADED(xycb,49) THREADED(xycb,4a) THREADED(xycb,4b) THREADED(xycb,4c) THREADED(xycb,4d) THREADED(xycb,4e) THREADED(xycb,4f)
+  THREADED(xycb,50) THREADED(xycb,51) THREADED(xycb,52) THREADED(xycb,53) THREADED(xycb,54) THREADED(xycb,55) THREADED(xycb,56) THREADED(xycb,57)
+  THREADED(xycb,58) THREADED(xycb,59) THREADED(xycb,5a) THREADED(xycb,5b) THREADED(xycb,5c) THREADED(xycb,5d) THREADED(xycb,5e) THREADED(xycb,5f)
+  THREADED(xycb,60) THREADED(xycb,61) THREADED(xycb,62) THREADED(xycb,63) THREADED(xycb,64) THREADED(xycb,65) THREADED(xycb,66) THREADED(xycb,67)
+  THREADED(xycb,68) THREADED(xycb,69) THREADED(xycb,6a) THREADED(xycb,6b) THREADED(xycb,6c) THREADED(xycb,6d) THREADED(xycb,6e) THREADED(xycb,6f)
+  THREADED(xycb,70) THREADED(xycb,71) THREADED(xycb,72) THREADED(xycb,73) THREADED(xycb,74) THREADED(xycb,75) THREADED(xycb,76) THREADED(xycb,77)
+  THREADED(xycb,78) THREADED(xycb,79) THREADED(xycb,7a) THREADED(xycb,7b) THREADED(xycb,7c) THREADED(xycb,7d) THREADED(xycb,7e) THREADED(xycb,7f)
+  THREADED(xycb,80) THREADED(xycb,81) THREADED(xycb,82) THREADED(xycb,83) THREADED(xycb,84) THREADED(xycb,85) THREADED(xycb,86) THREADED(xycb,87)
+  THREADED(xycb,88) THREADED(xycb,89) THREADED(xycb,8a) THREADED(xycb,8b) THREADED(xycb,8c) THREADED(xycb,8d) THREADED(xycb,8e) THREADED(xycb,8f)
+  THREADED(xycb,90) THREADED(xycb,91) THREADED(xycb,92) THREADED(xycb,93) THREADED(xycb,94) THREADED(xycb,95) THREADED(xycb,96) THREADED(xycb,97)
+  THREADED(xycb,98) THREADED(xycb,99) THREADED(xycb,9a) THREADED(xycb,9b) THREADED(xycb,9c) THREADED(xycb,9d) THREADED(xycb,9e) THREADED(xycb,9f)
+  THREADED(xycb,a0) THREADED(xycb,a1) THREADED(xycb,a2) THREADED(xycb,a3) THREADED(xycb,a4) THREADED(xycb,a5) THREADED(xycb,a6) THREADED(xycb,a7)
+  THREADED(xycb,a8) THREADED(xycb,a9) THREADED(xycb,aa) THREADED(xycb,ab) THREADED(xycb,ac) THREADED(xycb,ad) THREADED(xycb,ae) THREADED(xycb,af)
+  THREADED(xycb,b0) THREADED(xycb,b1) THREADED(xycb,b2) THREADED(xycb,b3) THREADED(xycb,b4) THREADED(xycb,b5) THREADED(xycb,b6) THREADED(xycb,b7)
+  THREADED(xycb,b8) THREADED(xycb,b9) THREADED(xycb,ba) THREADED(xycb,bb) THREADED(xycb,bc) THREADED(xycb,bd) THREADED(xycb,be) THREADED(xycb,bf)
+  THREADED(xycb,c0) THREADED(xycb,c1) THREADED(xycb,c2) THREADED(xycb,c3) THREADED(xycb,c4) THREADED(xycb,c5) THREADED(xycb,c6) THREADED(xycb,c7)
+  THREADED(xycb,c8) THREADED(xycb,c9) THREADED(xycb,ca) THREADED(xycb,cb) THREADED(xycb,cc) THREADED(xycb,cd) THREADED(xycb,ce) THREADED(xycb,cf)
+  THREADED(xycb,d0) THREADED(xycb,d1) THREADED(xycb,d2) THREADED(xycb,d3) THREADED(xycb,d4) THREADED(xycb,d5) THREADED(xycb,d6) THREADED(xycb,d7)
+  THREADED(xycb,d8) THREADED(xycb,d9) THREADED(xycb,da) THREADED(xycb,db) THREADED(xycb,dc) THREADED(xycb,dd) THREADED(xycb,de) THREADED(xycb,df)
+  THREADED(xycb,e0) THREADED(xycb,e1) THREADED(xycb,e2) THREADED(xycb,e3) THREADED(xycb,e4) THREADED(xycb,e5) THREADED(xycb,e6) THREADED(xycb,e7)
+  THREADED(xycb,e8) THREADED(xycb,e9) THREADED(xycb,ea) THREADED(xycb,eb) THREADED(xycb,ec) THREADED(xycb,ed) THREADED(xycb,ee) THREADED(xycb,ef)
+  THREADED(xycb,f0) THREADED(xycb,f1) THREADED(xycb,f2) THREADED(xycb,f3) THREADED(xycb,f4) THREADED(xycb,f5) THREADED(xycb,f6) THREADED(xycb,f7)
+  THREADED(xycb,f8) THREADED(xycb,f9) THREADED(xycb,fa) THREADED(xycb,fb) THREADED(xycb,fc) THREADED(xycb,fd) THREADED(xycb,fe) THREADED(xycb,ff)
+}
+#endif
+
+#ifdef USE_PROFILER
+/****************************************************************************
+ * Run until given cycle count, reporting instructions to hotspot profiler
+ * (see profiler.h). Calls and returns are tracked from CALL, RST, RET, RETI
+ * and RETN instructions (conditional ones being detected from stack pointer
+ * update) and from interrupts.
+ ****************************************************************************/
+static void z80_run_profiled(unsigned int cycles)
+{
+  /* NMI taken before execution */
+  profiler_sync(PROFILER_Z80);
+
+  while( Z80.cycles < cycles )
+  {
+    unsigned int pc = PCD;
+    unsigned int sp = SPD;
+    unsigned int start = Z80.cycles;
+    int flow = PROFILER_NEXT;
+    UINT8 opcode;
+
+    /* check for IRQs before each instruction */
+    if (Z80.irq_state && IFF1 && !Z80.after_ei)
+    {
+      take_interrupt();
+      profiler_exec(PROFILER_Z80, pc, Z80.cycles - start, PROFILER_CALL, PCD);
+      continue;
+    }
+
+    Z80.after_ei = FALSE;
+    R++;
+    opcode = ROP();
+    EXEC_INLINE(op,opcode);
+
+    if (SPD == ((sp - 2) & 0xffff))
+    {
+      /* CALL, CALL cc, RST */
+      if ((opcode == 0xcd) || ((opcode & 0xc7) == 0xc4) || ((opcode & 0xc7) == 0xc7))
+      {
+        flow = PROFILER_CALL;
+      }
+    }
+    else if (SPD == ((sp + 2) & 0xffff))
+    {
+      /* RET, RET cc, RETI, RETN */
+      if ((opcode == 0xc9) || ((opcode & 0xc7) == 0xc0) || (opcode == 0xed))
+      {
+        flow = PROFILER_RETURN;
+      }
+    }
+
+    profiler_exec(PROFILER_Z80, pc, Z80.cycles - start, flow, PCD);
+  }
+}
+#endif
+
 /****************************************************************************
  * Run until given cycle count 
  ****************************************************************************/
 void z80_run(unsigned int cycles)
 {
+#ifdef USE_IDLE_SKIP
+  /* busy-wait loops are not skipped across execution frames */
+  z80_skip.cycle_end = cycles;
+  z80_skip.horizon = 0;
+#endif
+
+#ifdef USE_PROFILER
+  if (profiler_active)
+  {
+    z80_run_profiled(cycles);
+    return;
+  }
+#endif
+
+#ifdef USE_Z80_THREADED
+  if (z80_threaded)
+  {
+    z80_run_threaded(cycles);
+    return;
+  }
+#endif
+
   while( Z80.cycles < cycles )
   {
     /* check for IRQs before each instruction */
@@ -3463,8 +4053,22 @@ void z80_set_nmi_line(unsigned int state)
     WZ=PCD;
 
     USE_CYCLES(11*15);
+
+#ifdef USE_PROFILER
+    if (profiler_active) profiler_interrupt(PROFILER_Z80, PCD);
+#endif
   }
 
   Z80.nmi_state = state;
 }
 
+#ifdef USE_Z80_THREADED
+/****************************************************************************
+ * Enable or disable threaded code execution (benchmarking)
+ ****************************************************************************/
+void z80_set_threaded(int enable)
+{
+  z80_threaded = enable;
+}
+#endif
+
@@ -49,19 +49,30 @@ typedef struct
 }  Z80_Regs;
 
 
-extern Z80_Regs Z80;
+extern THREAD_LOCAL Z80_Regs Z80;
 
 #ifdef Z80_ALLOW_OVERCLOCK
-extern UINT32 z80_cycle_ratio;
+extern THREAD_LOCAL UINT32 z80_cycle_ratio;
 #endif
 
-extern unsigned char *z80_readmap[64];
-extern unsigned char *z80_writemap[64];
+extern THREAD_LOCAL unsigned char *z80_readmap[64];
+extern THREAD_LOCAL unsigned char *z80_writemap[64];
 
-extern void (*z80_writemem)(unsigned int address, unsigned char data);
-extern unsigned char (*z80_readmem)(unsigned int address);
-extern void (*z80_writeport)(unsigned int port, unsigned char data);
-extern unsigned char (*z80_readport)(unsigned int port);
+extern THREAD_LOCAL void (*z80_writemem)(unsigned int address, unsigned char data);
+extern THREAD_LOCAL unsigned char (*z80_readmem)(unsigned int address);
+extern THREAD_LOCAL void (*z80_writeport)(unsigned int port, unsigned char data);
+extern THREAD_LOCAL unsigned char (*z80_readport)(unsigned int port);
+
+/* 1KB pages read or written directly through z80_readmap / z80_writemap, without calling */
+/* memory handlers (must be updated by memory map setup code when handlers are modified)  */
+extern THREAD_LOCAL UINT8 z80_readmap_direct[64];
+extern THREAD_LOCAL UINT8 z80_writemap_direct[64];
+
+#ifdef USE_IDLE_SKIP
+/* memory read handlers set this to the cycle count until which returned value cannot change */
+extern THREAD_LOCAL UINT32 z80_read_horizon;
+extern THREAD_LOCAL unsigned long long z80_idle_cycles;
+#endif
 
 extern void z80_init(const void *config, int (*irqcallback)(int));
 extern void z80_reset (void);
@@ -70,6 +81,9 @@ extern void z80_get_context (void *dst);
 extern void z80_set_context (void *src);
 extern void z80_set_irq_line(unsigned int state);
 extern void z80_set_nmi_line(unsigned int state);
+#ifdef USE_Z80_THREADED
+extern void z80_set_threaded(int enable);
+#endif
 
 #endif
 
@@ -496,6 +496,9 @@ static void apply_cheats(void)
       }
     }
   }
+
+  /* discard 68k instructions cached from patched ROM */
+  m68k_block_flush();
 }
 
 static void clear_cheats(void)
@@ -531,6 +534,9 @@ static void clear_cheats(void)
 
     i--;
   }
+
+  /* discard 68k instructions cached from patched ROM */
+  m68k_block_flush();
 }
 
 static void switch_chars(void)
@@ -122,6 +122,12 @@ static uint16_t bitmap_data_[720 * 576];
 
 static bool restart_eq = false;
 
+static int rewind_budget = 0;
+
+/* frame timing report interval (frames) */
+#define TIMING_REPORT_FRAMES 600
+static unsigned timing_frames = 0;
+
 static char g_rom_dir[256];
 static char g_rom_name[256];
 static char *save_dir;
@@ -1281,6 +1287,52 @@ static void check_variables(void)
       config.no_sprite_limit = 1;
   }
 
+  var.key = "genesis_plus_gx_rewind";
+  environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var);
+  {
+    int budget = 0;
+    if (var.value && strcmp(var.value, "disabled"))
+      budget = atoi(var.value) << 20;
+    if (budget != rewind_budget)
+    {
+      rewind_budget = budget;
+      if (!rewind_budget)
+        rewind_shutdown();
+      else if (!rewind_init(rewind_budget))
+        rewind_budget = 0;
+    }
+  }
+
+  var.key = "genesis_plus_gx_frame_timing";
+  environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var);
+  {
+    int enable = var.value && !strcmp(var.value, "enabled");
+    if (enable != timing_enabled)
+    {
+      timing_enable(enable);
+      timing_frames = 0;
+    }
+  }
+
+  var.key = "genesis_plus_gx_scd_sync";
+  environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var);
+  scd_set_sync_lines(var.value ? atoi(var.value) : 1);
+
+#ifdef USE_SCD_THREAD
+  var.key = "genesis_plus_gx_scd_thread";
+  environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var);
+  {
+    int enable = var.value && !strcmp(var.value, "enabled");
+    if (enable != scd_thread_active)
+    {
+      if (!enable)
+        scd_thread_shutdown();
+      else if (!scd_thread_init() && log_cb)
+        log_cb(RETRO_LOG_ERROR, "Could not start CD System SUB-CPU thread.\n");
+    }
+  }
+#endif
+
   if (reinit)
   {
 #ifdef HAVE_OVERCLOCK
@@ -1581,6 +1633,9 @@ static void apply_cheats(void)
          }
       }
    }
+
+   /* discard 68k instructions cached from patched ROM */
+   m68k_block_flush();
 }
 
 static void clear_cheats(void)
@@ -1613,6 +1668,9 @@ static void clear_cheats(void)
       }
       i--;
    }
+
+   /* discard 68k instructions cached from patched ROM */
+   m68k_block_flush();
 }
 
 /****************************************************************************
@@ -1633,11 +1691,13 @@ static void RAMCheatUpdate(void)
       {
          /* 16-bit patch */
          *(uint16_t *)(work_ram + (cheatlist[index].address & 0xFFFE)) = cheatlist[index].data;
+         MARK_STATE_DIRTY(work_ram + (cheatlist[index].address & 0xFFFE));
       }
       else
       {
          /* 8-bit patch */
          work_ram[cheatlist[index].address & 0xFFFF] = cheatlist[index].data;
+         MARK_STATE_DIRTY(&work_ram[cheatlist[index].address & 0xFFFF]);
       }
    }
 }
@@ -1729,6 +1789,12 @@ void retro_set_environment(retro_environment_t cb)
       { "genesis_plus_gx_overclock", "CPU speed; 100%|125%|150%|175%|200%" },
 #endif
       { "genesis_plus_gx_no_sprite_limit", "Remove per-line sprite limit; disabled|enabled" },
+      { "genesis_plus_gx_rewind", "Rewind buffer (hold R3); disabled|16MB|32MB|64MB|128MB" },
+      { "genesis_plus_gx_frame_timing", "Log frame timing per subsystem; disabled|enabled" },
+      { "genesis_plus_gx_scd_sync", "CD System CPU sync interval (lines); 1|2|4|8|16" },
+#ifdef USE_SCD_THREAD
+      { "genesis_plus_gx_scd_thread", "CD System SUB-CPU thread; disabled|enabled" },
+#endif
       { NULL, NULL },
    };
 
@@ -1791,6 +1857,7 @@ void retro_set_environment(retro_environment_t cb)
       { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R,     "Z" },
       { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_SELECT,    "Mode" },
       { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_START,    "Start" },
+      { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R3,    "Rewind" },
 
       { 1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT,  "D-Pad Left" },
       { 1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP,    "D-Pad Up" },
@@ -2269,6 +2336,13 @@ void retro_unload_game(void)
    if (system_hw == SYSTEM_MCD)
       bram_save();
 
+   rewind_shutdown();
+   rewind_budget = 0;
+
+#ifdef USE_SCD_THREAD
+   scd_thread_shutdown();
+#endif
+
    audio_shutdown();
    if (md_ntsc)
       free(md_ntsc);
@@ -2367,8 +2441,13 @@ void retro_reset(void)
 void retro_run(void) 
 {
    bool updated = false;
+   bool rewinding = false;
    is_running = true;
 
+   /* step back to previous frame while rewind button is held */
+   if (rewind_budget && input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R3))
+      rewinding = rewind_step();
+
 #ifdef HAVE_OVERCLOCK
   /* update overclock delay */
   if (overclock_delay)
@@ -2406,6 +2485,10 @@ void retro_run(void)
       system_frame_sms(0);
    }
 
+   /* save rewind history */
+   if (rewind_budget && !rewinding)
+      rewind_push();
+
    if (bitmap.viewport.changed & 9)
    {
       bool geometry_updated = update_viewport();
@@ -2449,6 +2532,15 @@ void retro_run(void)
    video_cb(bitmap.data, vwidth, vheight, 720 * 2);
    audio_cb(soundbuffer, audio_update(soundbuffer));
 
+   /* periodic frame timing report (average/95th percentile per subsystem) */
+   if (timing_enabled && (++timing_frames >= TIMING_REPORT_FRAMES))
+   {
+      char summary[256];
+      timing_frames = 0;
+      if (log_cb && timing_summary(summary, sizeof(summary)))
+         log_cb(RETRO_LOG_INFO, "Frame timing: %s\n", summary);
+   }
+
    environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated);
    if (updated)
    {
@@ -1,7 +1,7 @@
 
 #include "osd.h"
 
-t_config config;
+THREAD_LOCAL t_config config;
 
 
 void set_config_defaults(void)
@@ -22,6 +22,9 @@ void set_config_defaults(void)
   config.lp_range       = 0x9999; /* 0.6 in 16.16 fixed point */
   config.dac_bits       = 14;
   config.ym2413         = 2; /* = AUTO (0 = always OFF, 1 = always ON) */
+#ifdef HAVE_YM3438_CORE
+  config.ym3438         = 0;
+#endif
   config.mono           = 0;
 
   /* system options */
@@ -2,6 +2,8 @@
 #ifndef _CONFIG_H_
 #define _CONFIG_H_
 
+#include "macros.h"
+
 /****************************************************************************
  * Config Option 
  *
@@ -18,6 +20,9 @@ typedef struct
   uint8 hq_psg;
   uint8 dac_bits;
   uint8 ym2413;
+#ifdef HAVE_YM3438_CORE
+  uint8 ym3438;
+#endif
   int16 psg_preamp;
   int16 fm_preamp;
   uint32 lp_range;
@@ -46,8 +51,8 @@ typedef struct
   t_input_config input[MAX_INPUTS];
 } t_config;
 
-/* Global variables */
-extern t_config config;
+/* Global variables (one configuration per emulator instance, see core/context.h) */
+extern THREAD_LOCAL t_config config;
 extern void set_config_defaults(void);
 
 #endif /* _CONFIG_H_ */
@@ -0,0 +1,610 @@
+#include "shared.h"
+#include "instance.h"
+
+#define SNAPSHOT_LOOPS 1000
+#define CPU_BENCH_FRAMES 600
+#define AUDIO_BENCH_FRAMES 60
+#define AUDIO_BENCH_LOOPS 50
+#define AUDIO_SKIP_FRAMES 600
+#define NATIVE_STREAM_SIZE (1 << 16)
+
+static const char *game;
+static int snapshot_bench = 0;
+static int cpu_bench = 0;
+static int audio_bench = 0;
+static int audio_skip_bench = 0;
+static int native_streams = 0;
+static int frame_timing = 0;
+#ifdef USE_PROFILER
+static int profile = 0;
+#endif
+
+/* 68k-only frame: VDP, Z80 & sound hardware are not emulated, only VBLANK flag & vertical interrupt are updated */
+static unsigned int cpu_bench_frame(int count)
+{
+  unsigned int instructions = 0;
+  int line;
+
+  status &= ~0x08;
+  fifo_write_cnt = 0;
+  fifo_slots = 0;
+
+  for (line=0; line<lines_per_frame; line++)
+  {
+    v_counter = line;
+
+    if (line == bitmap.viewport.h)
+    {
+      status |= 0x88;
+      vint_pending = 0x20;
+      if (reg[1] & 0x20)
+      {
+        m68k_set_irq(6);
+      }
+    }
+
+    if (count)
+    {
+      /* execute instructions one by one */
+      while (m68k.cycles < (mcycles_vdp + MCYCLES_PER_LINE))
+      {
+        if (!m68k.stopped) instructions++;
+        m68k_run(m68k.cycles + 1);
+      }
+    }
+    else
+    {
+      m68k_run(mcycles_vdp + MCYCLES_PER_LINE);
+    }
+
+    mcycles_vdp += MCYCLES_PER_LINE;
+  }
+
+  m68k.cycles -= mcycles_vdp;
+  mcycles_vdp = 0;
+  return instructions;
+}
+
+/* Z80-only frame: VDP & sound hardware are not emulated, only VINT flag & interrupt are updated */
+static unsigned int z80_bench_frame(int count)
+{
+  unsigned int instructions = 0;
+  int line;
+
+  for (line=0; line<lines_per_frame; line++)
+  {
+    v_counter = line;
+
+    if (line == bitmap.viewport.h)
+    {
+      status |= 0x80;
+      vint_pending = 0x20;
+      if (reg[1] & 0x20)
+      {
+        Z80.irq_state = ASSERT_LINE;
+      }
+    }
+
+    if (count)
+    {
+      /* execute instructions one by one */
+      while (Z80.cycles < (mcycles_vdp + MCYCLES_PER_LINE))
+      {
+        if (!Z80.halt) instructions++;
+        z80_run(Z80.cycles + 1);
+      }
+    }
+    else
+    {
+      z80_run(mcycles_vdp + MCYCLES_PER_LINE);
+    }
+
+    mcycles_vdp += MCYCLES_PER_LINE;
+  }
+
+  Z80.cycles -= mcycles_vdp;
+  mcycles_vdp = 0;
+  return instructions;
+}
+
+/* emulation loop, with optional frame timing, native-rate streams & hotspot profile */
+static void run_frames(gpgx_context_t *ctx, int16 *soundbuffer)
+{
+  static const char *names[AUDIO_STREAM_COUNT] = {"FM", "PSG", "PCM", "CD-DA"};
+  double stream_rate[AUDIO_STREAM_COUNT];
+  double stream_samples[AUDIO_STREAM_COUNT];
+  double seconds, cycles, scd_syncs = 0.0;
+  unsigned int i, frames;
+  int k;
+
+#ifdef USE_PROFILER
+  /* profile emulation loop */
+  if (profile && !profiler_start())
+  {
+    fprintf(stderr, "Error starting hotspot profiler.\n");
+  }
+#endif
+
+  /* measure frame timing per subsystem */
+  timing_enable(frame_timing);
+
+  /* capture native-rate output of each sound chip, without resampling */
+  if (native_streams)
+  {
+    for (k=0; k<AUDIO_STREAM_COUNT; k++)
+    {
+      audio_stream_enable(k, NATIVE_STREAM_SIZE);
+      stream_rate[k] = audio_stream_rate(k);
+      stream_samples[k] = 0.0;
+    }
+    audio_stream_exclusive(1);
+  }
+
+  seconds = get_time();
+  for (i=0; i<instance_options.frames; i++)
+  {
+    gpgx_context_frame(ctx, !instance_options.render);
+
+    if (system_hw == SYSTEM_MCD)
+    {
+      scd_syncs += scd_sync_saved();
+    }
+
+    /* sound samples are discarded but sound buffers must be flushed each frame */
+    audio_update(soundbuffer);
+
+    /* native-rate samples are read in place, then discarded as well */
+    if (native_streams)
+    {
+      for (k=0; k<AUDIO_STREAM_COUNT; k++)
+      {
+        const int16 *samples;
+        int count;
+        while ((count = audio_stream_read(k, &samples)) > 0)
+        {
+          stream_samples[k] += count;
+          audio_stream_skip(k, count);
+        }
+      }
+    }
+  }
+  seconds = get_time() - seconds;
+
+  frames = gpgx_context_frame_count(ctx);
+  cycles = (double)frames * lines_per_frame * MCYCLES_PER_LINE;
+  printf("%s: %u frames in %.3f s (%.1f fps)\n", game, frames, seconds, seconds > 0.0 ? frames / seconds : 0.0);
+
+#ifdef USE_IDLE_SKIP
+  if (cycles > 0.0)
+  {
+    printf("%s: idle loops skipped, 68k %.1f%%, Z80 %.1f%%\n", game, m68k_idle_cycles * 100.0 / cycles, z80_idle_cycles * 100.0 / cycles);
+  }
+#endif
+
+  if (scd_syncs > 0.0)
+  {
+    printf("%s: Mega-CD CPU synchronizations saved, %.1f per frame\n", game, scd_syncs / frames);
+  }
+
+  if (native_streams)
+  {
+    audio_stream_shutdown();
+    printf("%s: native-rate streams, samples per frame", game);
+    for (k=0; k<AUDIO_STREAM_COUNT; k++)
+    {
+      if (stream_rate[k] > 0.0)
+      {
+        printf("%s %s %.1f (%.0f Hz)", k ? "," : "", names[k], stream_samples[k] / frames, stream_rate[k]);
+      }
+    }
+    printf("\n");
+  }
+
+  if (frame_timing)
+  {
+    char timing[256];
+    timing_summary(timing, sizeof(timing));
+    timing_enable(0);
+    printf("%s: frame timing (average/95th percentile) %s\n", game, timing);
+  }
+
+#ifdef USE_PROFILER
+  /* profile is written next to game file */
+  if (profiler_active)
+  {
+    char *flat = malloc(strlen(game) + 16);
+    char *folded = malloc(strlen(game) + 16);
+    profiler_stop();
+    if (flat && folded)
+    {
+      sprintf(flat, "%s.profile.txt", game);
+      sprintf(folded, "%s.folded", game);
+      if (profiler_write(flat, folded))
+      {
+        printf("%s: hotspot profile written to %s & %s\n", game, flat, folded);
+      }
+    }
+    free(flat);
+    free(folded);
+  }
+#endif
+}
+
+/* snapshot benchmark: one frame is emulated between snapshot save & restore */
+static void snapshot_benchmark(gpgx_context_t *ctx, int16 *soundbuffer)
+{
+  int i, size = snapshot_size();
+  double start, save = 0.0, load = 0.0;
+  uint8 *arena = malloc(size);
+  if (!arena) return;
+
+  for (i=0; i<SNAPSHOT_LOOPS; i++)
+  {
+    start = get_time();
+    snapshot_save(arena);
+    save += get_time() - start;
+
+    gpgx_context_frame(ctx, !instance_options.render);
+    audio_update(soundbuffer);
+
+    start = get_time();
+    snapshot_load(arena);
+    load += get_time() - start;
+  }
+
+  printf("%s: snapshot %d bytes, save %.1f us, restore %.1f us\n", game, size, save * 1000000.0 / SNAPSHOT_LOOPS, load * 1000000.0 / SNAPSHOT_LOOPS);
+  free(arena);
+}
+
+/* CPU benchmark: same 68k frames are executed by the interpreter, then with instruction cache */
+static void m68k_benchmark(void)
+{
+  int i;
+  unsigned int instructions = 0;
+  double start, interpreter;
+  uint8 *arena = malloc(snapshot_size());
+  if (!arena) return;
+
+  snapshot_save(arena);
+
+#ifdef USE_M68K_BLOCK_CACHE
+  m68k_set_block_cache(0);
+#endif
+  for (i=0; i<CPU_BENCH_FRAMES; i++)
+  {
+    instructions += cpu_bench_frame(1);
+  }
+
+  snapshot_load(arena);
+  start = get_time();
+  for (i=0; i<CPU_BENCH_FRAMES; i++)
+  {
+    cpu_bench_frame(0);
+  }
+  interpreter = get_time() - start;
+  printf("%s: 68k %u instructions, interpreter %.1f MIPS", game, instructions, instructions / interpreter / 1000000.0);
+
+#ifdef USE_M68K_BLOCK_CACHE
+  snapshot_load(arena);
+  m68k_set_block_cache(1);
+  start = get_time();
+  for (i=0; i<CPU_BENCH_FRAMES; i++)
+  {
+    cpu_bench_frame(0);
+  }
+  printf(", instruction cache %.1f MIPS", instructions / (get_time() - start) / 1000000.0);
+#endif
+  printf("\n");
+  free(arena);
+}
+
+/* Z80 CPU benchmark: same Z80 frames are executed by the interpreter, then with threaded code */
+static void z80_benchmark(void)
+{
+  int i;
+  unsigned int instructions = 0;
+  double start, interpreter;
+  uint8 *arena = malloc(snapshot_size());
+  if (!arena) return;
+
+  snapshot_save(arena);
+
+#ifdef USE_Z80_THREADED
+  z80_set_threaded(0);
+#endif
+  for (i=0; i<CPU_BENCH_FRAMES; i++)
+  {
+    instructions += z80_bench_frame(1);
+  }
+
+  snapshot_load(arena);
+  start = get_time();
+  for (i=0; i<CPU_BENCH_FRAMES; i++)
+  {
+    z80_bench_frame(0);
+  }
+  interpreter = get_time() - start;
+  printf("%s: Z80 %u instructions, interpreter %.1f MIPS", game, instructions, instructions / interpreter / 1000000.0);
+
+#ifdef USE_Z80_THREADED
+  snapshot_load(arena);
+  z80_set_threaded(1);
+  start = get_time();
+  for (i=0; i<CPU_BENCH_FRAMES; i++)
+  {
+    z80_bench_frame(0);
+  }
+  printf(", threaded code %.1f MIPS", instructions / (get_time() - start) / 1000000.0);
+#endif
+  printf("\n");
+  free(arena);
+}
+
+/* SVP benchmark: same frames are emulated with SSP1601 interpreter, then with block translator */
+static void svp_benchmark(gpgx_context_t *ctx, int16 *soundbuffer)
+{
+  int i;
+  double start, frame;
+  double budget = vdp_pal ? (1.0 / 50.0) : (1.0 / 60.0);
+  uint8 *arena = malloc(snapshot_size());
+  svp_t *svp_state = malloc(sizeof(svp_t));
+
+  if (arena && svp_state)
+  {
+    /* SVP memory & registers are not part of snapshots */
+    snapshot_save(arena);
+    memcpy(svp_state, svp, sizeof(svp_t));
+
+#ifdef USE_SVP_BLOCK_CACHE
+    ssp1601_set_block_cache(0);
+#endif
+    start = get_time();
+    for (i=0; i<CPU_BENCH_FRAMES; i++)
+    {
+      gpgx_context_frame(ctx, 1);
+      audio_update(soundbuffer);
+    }
+
+    /* emulation time per frame, relative to emulated frame duration */
+    frame = (get_time() - start) / CPU_BENCH_FRAMES;
+    printf("%s: SVP frame %.3f ms (%.1f%% of budget) with interpreter", game, frame * 1000.0, frame * 100.0 / budget);
+
+#ifdef USE_SVP_BLOCK_CACHE
+    snapshot_load(arena);
+    memcpy(svp, svp_state, sizeof(svp_t));
+    ssp1601_set_block_cache(1);
+    start = get_time();
+    for (i=0; i<CPU_BENCH_FRAMES; i++)
+    {
+      gpgx_context_frame(ctx, 1);
+      audio_update(soundbuffer);
+    }
+    frame = (get_time() - start) / CPU_BENCH_FRAMES;
+    printf(", %.3f ms (%.1f%% of budget) with block translator", frame * 1000.0, frame * 100.0 / budget);
+#endif
+    printf("\n");
+  }
+
+  free(arena);
+  free(svp_state);
+}
+
+/* audio benchmark: post-mix filters are applied to the same frames resampled at 48 kHz, then 96 kHz */
+static void audio_filter_benchmark(gpgx_context_t *ctx, int16 *soundbuffer)
+{
+  static const int rates[2] = {48000, 96000};
+  static const int filters[4][2] = {{1, 0}, {1, 1}, {2, 0}, {2, 1}};
+  int16 *frames = malloc(AUDIO_BENCH_FRAMES * SOUND_SAMPLES_SIZE * sizeof(int16));
+  int sizes[AUDIO_BENCH_FRAMES];
+  uint8 *arena = malloc(snapshot_size());
+
+  if (frames && arena)
+  {
+    int i, k, mode, loop;
+    double start, time[4];
+    snapshot_save(arena);
+
+    for (k=0; k<2; k++)
+    {
+      snapshot_load(arena);
+      audio_init(rates[k], 0);
+      for (i=0; i<AUDIO_BENCH_FRAMES; i++)
+      {
+        gpgx_context_frame(ctx, 1);
+        sizes[i] = audio_update(frames + i * SOUND_SAMPLES_SIZE);
+      }
+
+      for (mode=0; mode<4; mode++)
+      {
+        start = get_time();
+        for (loop=0; loop<AUDIO_BENCH_LOOPS; loop++)
+        {
+          for (i=0; i<AUDIO_BENCH_FRAMES; i++)
+          {
+            memcpy(soundbuffer, frames + i * SOUND_SAMPLES_SIZE, sizes[i] * 2 * sizeof(int16));
+            audio_filter(soundbuffer, sizes[i], filters[mode][0], filters[mode][1]);
+          }
+        }
+        time[mode] = (get_time() - start) / (AUDIO_BENCH_LOOPS * AUDIO_BENCH_FRAMES);
+      }
+
+      printf("%s: audio filters per frame at %d kHz, low-pass %.1f us (%.1f us with mono), EQ %.1f us (%.1f us with mono)\n", game, 48 << k,
+             time[0] * 1000000.0, time[1] * 1000000.0, time[2] * 1000000.0, time[3] * 1000000.0);
+    }
+
+    audio_init(SOUND_FREQUENCY, 0);
+  }
+
+  free(frames);
+  free(arena);
+}
+
+/* audio skip benchmark: same frames are emulated with audio output, then with sound chips running without output */
+static void audio_skip_benchmark(gpgx_context_t *ctx, int16 *soundbuffer)
+{
+  int i;
+  double start, with, without;
+  uint8 *arena = malloc(snapshot_size());
+  if (!arena) return;
+
+  snapshot_save(arena);
+
+  start = get_time();
+  for (i=0; i<AUDIO_SKIP_FRAMES; i++)
+  {
+    gpgx_context_frame(ctx, !instance_options.render);
+    audio_update(soundbuffer);
+  }
+  with = AUDIO_SKIP_FRAMES / (get_time() - start);
+
+  snapshot_load(arena);
+  audio_set_skip(1);
+  start = get_time();
+  for (i=0; i<AUDIO_SKIP_FRAMES; i++)
+  {
+    gpgx_context_frame(ctx, !instance_options.render);
+  }
+  without = AUDIO_SKIP_FRAMES / (get_time() - start);
+  audio_set_skip(0);
+
+  printf("%s: %.1f fps with audio output, %.1f fps without (%+.1f%%)\n", game, with, without, (without - with) * 100.0 / with);
+  free(arena);
+}
+
+static void usage(const char *name)
+{
+  printf("Genesis Plus GX\\headless benchmarks\n");
+  printf("usage: %s [options] [-m] [-w] [-p] [-s] [-c] [-a] [-k] gamename [movie]\n", name);
+  instance_usage();
+  printf("  -m         : measure frame timing per subsystem (CPU, rendering, sound chips, resampling)\n");
+  printf("  -w         : read native-rate output of each sound chip instead of resampled output\n");
+#ifdef USE_PROFILER
+  printf("  -p         : write hotspot profile of emulation loop next to game file\n");
+#endif
+  printf("  -s         : benchmark snapshot save & restore once emulation is finished\n");
+  printf("  -c         : benchmark 68k or Z80 instructions per second (and SVP frame time) once emulation is finished\n");
+  printf("  -a         : benchmark post-mix audio filters (low-pass, EQ, mono) at 48 and 96 kHz once emulation is finished\n");
+  printf("  -k         : benchmark emulation speed with and without audio output once emulation is finished\n");
+}
+
+int main (int argc, char **argv)
+{
+  int i;
+  const char *movie = NULL;
+  void *framebuffer;
+  int16 *soundbuffer;
+  gpgx_context_t *ctx;
+
+  /* parse command line */
+  for (i=1; i<argc; i++)
+  {
+    if (!strcmp(argv[i], "-m"))
+    {
+      frame_timing = 1;
+    }
+    else if (!strcmp(argv[i], "-w"))
+    {
+      native_streams = 1;
+    }
+#ifdef USE_PROFILER
+    else if (!strcmp(argv[i], "-p"))
+    {
+      profile = 1;
+    }
+#endif
+    else if (!strcmp(argv[i], "-s"))
+    {
+      snapshot_bench = 1;
+    }
+    else if (!strcmp(argv[i], "-c"))
+    {
+      cpu_bench = 1;
+    }
+    else if (!strcmp(argv[i], "-a"))
+    {
+      audio_bench = 1;
+    }
+    else if (!strcmp(argv[i], "-k"))
+    {
+      audio_skip_bench = 1;
+    }
+    else if (instance_parse_option(argc, argv, &i))
+    {
+      continue;
+    }
+    else if ((argv[i][0] == '-') || movie)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    else if (!game)
+    {
+      game = argv[i];
+    }
+    else
+    {
+      movie = argv[i];
+    }
+  }
+
+  /* Print help if no game specified */
+  if (!game)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  error_init();
+
+  framebuffer = malloc(VIDEO_WIDTH * VIDEO_HEIGHT * 4);
+  soundbuffer = malloc(SOUND_SAMPLES_SIZE * sizeof(int16));
+  ctx = (framebuffer && soundbuffer) ? instance_open(game, movie, framebuffer) : NULL;
+  if (!ctx)
+  {
+    printf("%s: error loading file\n", game);
+    free(framebuffer);
+    free(soundbuffer);
+    error_shutdown();
+    return 1;
+  }
+
+  run_frames(ctx, soundbuffer);
+
+  if (snapshot_bench)
+  {
+    snapshot_benchmark(ctx, soundbuffer);
+  }
+
+  if (cpu_bench)
+  {
+    if ((system_hw & SYSTEM_PBC) != SYSTEM_MD)
+    {
+      z80_benchmark();
+    }
+    else if (system_hw != SYSTEM_MCD)
+    {
+      m68k_benchmark();
+    }
+
+    if (svp)
+    {
+      svp_benchmark(ctx, soundbuffer);
+    }
+  }
+
+  if (audio_bench)
+  {
+    audio_filter_benchmark(ctx, soundbuffer);
+  }
+
+  if (audio_skip_bench)
+  {
+    audio_skip_benchmark(ctx, soundbuffer);
+  }
+
+  instance_close(ctx);
+  free(framebuffer);
+  free(soundbuffer);
+  error_shutdown();
+  return 0;
+}
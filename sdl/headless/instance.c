@@ -0,0 +1,238 @@
+#include "shared.h"
+#include "sms_ntsc.h"
+#include "md_ntsc.h"
+#include "instance.h"
+
+int log_error   = 0;
+int debug_on    = 0;
+
+/* NTSC filters are not used but must exist for each instance */
+THREAD_LOCAL md_ntsc_t *md_ntsc;
+THREAD_LOCAL sms_ntsc_t *sms_ntsc;
+
+t_instance_options instance_options = {3600, 0, 0, 0, 0, 1, 0};
+
+/* input movie being played by current thread */
+static THREAD_LOCAL uint8 *movie_data;
+static THREAD_LOCAL int movie_size;
+static THREAD_LOCAL int movie_pos;
+
+double get_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+static int load_movie(const char *filename)
+{
+  FILE *fp = fopen(filename, "rb");
+  if (!fp) return 0;
+
+  fseek(fp, 0, SEEK_END);
+  movie_size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  movie_data = malloc(movie_size);
+  if (!movie_data || (fread(movie_data, 1, movie_size, fp) != (size_t)movie_size))
+  {
+    free(movie_data);
+    movie_data = NULL;
+    movie_size = 0;
+    fclose(fp);
+    return 0;
+  }
+
+  movie_pos = 0;
+  fclose(fp);
+  return 1;
+}
+
+static void close_movie(void)
+{
+  free(movie_data);
+  movie_data = NULL;
+  movie_size = 0;
+  movie_pos = 0;
+}
+
+int sdl_input_update(void)
+{
+  int i, player = 0;
+
+  for (i=0; i<MAX_INPUTS; i++)
+  {
+    if (input.dev[i] == NO_DEVICE) continue;
+
+    /* reset input */
+    input.pad[i] = 0;
+
+    /* next player buttons from input movie */
+    if ((player < MOVIE_PLAYERS) && ((movie_pos + MOVIE_PLAYERS * 2) <= movie_size))
+    {
+      input.pad[i] = movie_data[movie_pos + player*2] | (movie_data[movie_pos + player*2 + 1] << 8);
+    }
+
+    player++;
+  }
+
+  /* advance to next frame record */
+  if ((movie_pos + MOVIE_PLAYERS * 2) <= movie_size)
+  {
+    movie_pos += MOVIE_PLAYERS * 2;
+  }
+
+  return 1;
+}
+
+/* return 1 if argv[*i] is an emulation option (its argument is then skipped as well) */
+int instance_parse_option(int argc, char **argv, int *i)
+{
+  if (!strcmp(argv[*i], "-n") && (*i+1 < argc))
+  {
+    instance_options.frames = strtoul(argv[++*i], NULL, 0);
+  }
+  else if (!strcmp(argv[*i], "-r"))
+  {
+    instance_options.render = 1;
+  }
+  else if (!strcmp(argv[*i], "-t"))
+  {
+    instance_options.render_thread = 1;
+  }
+#ifdef HAVE_YM3438_CORE
+  else if (!strcmp(argv[*i], "-y"))
+  {
+    instance_options.ym3438 = 1;
+  }
+#endif
+#ifdef USE_YM3438_THREAD
+  else if (!strcmp(argv[*i], "-f"))
+  {
+    instance_options.ym3438_thread = 1;
+  }
+#endif
+  else if (!strcmp(argv[*i], "-q") && (*i+1 < argc))
+  {
+    instance_options.scd_sync_lines = atoi(argv[++*i]);
+  }
+#ifdef USE_SCD_THREAD
+  else if (!strcmp(argv[*i], "-x"))
+  {
+    instance_options.scd_thread = 1;
+  }
+#endif
+  else
+  {
+    return 0;
+  }
+
+  return 1;
+}
+
+void instance_usage(void)
+{
+  printf("  -n frames  : number of frames emulated by each instance (default: %u)\n", instance_options.frames);
+  printf("  -r         : enable video rendering (disabled by default)\n");
+  printf("  -t         : render video on a second thread (with -r)\n");
+#ifdef HAVE_YM3438_CORE
+  printf("  -y         : use Nuked OPN2 (YM3438) core instead of MAME YM2612 core\n");
+#endif
+#ifdef USE_YM3438_THREAD
+  printf("  -f         : run Nuked OPN2 core on a second thread (with -y)\n");
+#endif
+  printf("  -q lines   : let Mega-CD MAIN-CPU run up to <lines> lines ahead of SUB-CPU until they communicate (default: 1)\n");
+#ifdef USE_SCD_THREAD
+  printf("  -x         : run Mega-CD SUB-CPU on a second thread (with -q)\n");
+#endif
+}
+
+/* create new instance bound to current thread, then load game & input movie (optional) */
+gpgx_context_t *instance_open(const char *rom, const char *movie, void *framebuffer)
+{
+  gpgx_context_t *ctx = gpgx_context_new();
+  if (!ctx) return NULL;
+
+  /* set default config (each instance has its own) */
+  set_config_defaults();
+#ifdef HAVE_YM3438_CORE
+  config.ym3438 = instance_options.ym3438;
+#endif
+
+  /* mark all BIOS as unloaded */
+  system_bios = 0;
+  memset(boot_rom, 0xFF, 0x800);
+
+  /* default controllers */
+  input.system[0] = SYSTEM_GAMEPAD;
+  input.system[1] = SYSTEM_GAMEPAD;
+
+  /* instance framebuffer (only written when rendering is enabled) */
+  memset(&bitmap, 0, sizeof(t_bitmap));
+  bitmap.width        = VIDEO_WIDTH;
+  bitmap.height       = VIDEO_HEIGHT;
+#if defined(USE_8BPP_RENDERING)
+  bitmap.pitch        = (bitmap.width * 1);
+#elif defined(USE_15BPP_RENDERING)
+  bitmap.pitch        = (bitmap.width * 2);
+#elif defined(USE_16BPP_RENDERING)
+  bitmap.pitch        = (bitmap.width * 2);
+#elif defined(USE_32BPP_RENDERING)
+  bitmap.pitch        = (bitmap.width * 4);
+#endif
+  bitmap.data         = framebuffer;
+  bitmap.viewport.changed = 3;
+
+  /* load game file */
+  if (!load_rom((char *)rom))
+  {
+    gpgx_context_delete(ctx);
+    return NULL;
+  }
+
+  /* initialize system hardware */
+  audio_init(SOUND_FREQUENCY, 0);
+  system_init();
+  system_reset();
+
+#ifdef USE_RENDER_THREAD
+  /* render lines on a second thread */
+  if (instance_options.render && instance_options.render_thread && !render_thread_init())
+  {
+    fprintf(stderr, "Error starting render thread.\n");
+  }
+#endif
+
+#ifdef USE_YM3438_THREAD
+  /* run Nuked OPN2 core on a second thread */
+  if (instance_options.ym3438 && instance_options.ym3438_thread && ((system_hw & SYSTEM_PBC) == SYSTEM_MD) && !ym3438_thread_init())
+  {
+    fprintf(stderr, "Error starting YM3438 thread.\n");
+  }
+#endif
+
+#ifdef USE_SCD_THREAD
+  /* run Mega-CD SUB-CPU on a second thread */
+  if (instance_options.scd_thread && (system_hw == SYSTEM_MCD) && !scd_thread_init())
+  {
+    fprintf(stderr, "Error starting SUB-CPU thread.\n");
+  }
+#endif
+
+  /* Mega-CD CPUs synchronization interval */
+  scd_set_sync_lines(instance_options.scd_sync_lines);
+
+  /* load input movie */
+  if (movie && !load_movie(movie))
+  {
+    fprintf(stderr, "Error loading movie `%s'.\n", movie);
+  }
+
+  return ctx;
+}
+
+void instance_close(gpgx_context_t *ctx)
+{
+  close_movie();
+  gpgx_context_delete(ctx);
+}
@@ -0,0 +1,31 @@
+#ifndef _INSTANCE_H_
+#define _INSTANCE_H_
+
+#define SOUND_FREQUENCY 48000
+#define SOUND_SAMPLES_SIZE  4096
+
+#define VIDEO_WIDTH  720
+#define VIDEO_HEIGHT 576
+
+/* Emulation options shared by all instances (set from command line before any instance is created) */
+typedef struct
+{
+  unsigned int frames;  /* number of frames emulated by each instance */
+  int render;           /* 1= video rendering enabled */
+  int render_thread;    /* 1= render video on a second thread */
+  int ym3438;           /* 1= Nuked OPN2 (YM3438) core instead of MAME YM2612 core */
+  int ym3438_thread;    /* 1= run Nuked OPN2 core on a second thread */
+  int scd_sync_lines;   /* Mega-CD MAIN-CPU lines run ahead of SUB-CPU */
+  int scd_thread;       /* 1= run Mega-CD SUB-CPU on a second thread */
+} t_instance_options;
+
+extern t_instance_options instance_options;
+
+/* Function prototypes */
+extern double get_time(void);
+extern int instance_parse_option(int argc, char **argv, int *i);
+extern void instance_usage(void);
+extern gpgx_context_t *instance_open(const char *rom, const char *movie, void *framebuffer);
+extern void instance_close(gpgx_context_t *ctx);
+
+#endif /* _INSTANCE_H_ */
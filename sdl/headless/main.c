@@ -0,0 +1,259 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "shared.h"
+#include "instance.h"
+
+typedef struct
+{
+  char *rom;              /* ROM (or CD image) file */
+  char *movie;            /* input movie file (optional) */
+  int loaded;             /* set once ROM has been successfully loaded */
+  unsigned int frames;    /* number of emulated frames */
+  double seconds;         /* emulation time (excluding ROM loading) */
+} t_job;
+
+static t_job *jobs;
+static int job_count;
+static int next_job;
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* each job runs on a new thread, as a thread can only host one instance (see context.h) */
+static void *job_thread(void *arg)
+{
+  t_job *job = (t_job *)arg;
+  unsigned int i;
+  double start;
+  gpgx_context_t *ctx;
+  void *framebuffer = malloc(VIDEO_WIDTH * VIDEO_HEIGHT * 4);
+  int16 *soundbuffer = malloc(SOUND_SAMPLES_SIZE * sizeof(int16));
+
+  if (framebuffer && soundbuffer)
+  {
+    ctx = instance_open(job->rom, job->movie, framebuffer);
+    if (ctx)
+    {
+      job->loaded = 1;
+
+      /* emulation loop */
+      start = get_time();
+      for (i=0; i<instance_options.frames; i++)
+      {
+        gpgx_context_frame(ctx, !instance_options.render);
+
+        /* sound samples are discarded but sound buffers must be flushed each frame */
+        audio_update(soundbuffer);
+      }
+      job->seconds = get_time() - start;
+      job->frames = gpgx_context_frame_count(ctx);
+
+      instance_close(ctx);
+    }
+  }
+
+  free(framebuffer);
+  free(soundbuffer);
+  return NULL;
+}
+
+static void *worker(void *arg)
+{
+  int index;
+  t_job *job;
+  pthread_t thread;
+
+  while (1)
+  {
+    /* fetch next job */
+    pthread_mutex_lock(&job_lock);
+    index = next_job++;
+    pthread_mutex_unlock(&job_lock);
+
+    if (index >= job_count) break;
+
+    job = &jobs[index];
+    if (!pthread_create(&thread, NULL, job_thread, job))
+    {
+      pthread_join(thread, NULL);
+    }
+
+    /* report instance speed */
+    pthread_mutex_lock(&job_lock);
+    if (job->loaded)
+    {
+      printf("[%d] %s: %u frames in %.3f s (%.1f fps)\n", index, job->rom, job->frames, job->seconds, job->seconds > 0.0 ? job->frames / job->seconds : 0.0);
+    }
+    else
+    {
+      printf("[%d] %s: error loading file\n", index, job->rom);
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&job_lock);
+  }
+
+  return NULL;
+}
+
+static int add_job(const char *rom, const char *movie)
+{
+  t_job *temp = realloc(jobs, (job_count + 1) * sizeof(t_job));
+  if (!temp) return 0;
+
+  jobs = temp;
+  memset(&jobs[job_count], 0, sizeof(t_job));
+  jobs[job_count].rom = strdup(rom);
+  jobs[job_count].movie = movie ? strdup(movie) : NULL;
+  job_count++;
+  return 1;
+}
+
+/* each line of job list holds a ROM file name, optionally followed by whitespace and an input movie file name */
+static int load_job_list(const char *filename)
+{
+  char line[1024];
+  FILE *fp = fopen(filename, "r");
+  if (!fp) return 0;
+
+  while (fgets(line, sizeof(line), fp))
+  {
+    char *rom = line;
+    char *movie = NULL;
+    char *end;
+
+    /* strip leading & trailing whitespaces */
+    while ((*rom == ' ') || (*rom == '\t')) rom++;
+    end = rom + strlen(rom);
+    while ((end > rom) && ((end[-1] == '\n') || (end[-1] == '\r') || (end[-1] == ' ') || (end[-1] == '\t'))) *--end = 0;
+
+    /* skip empty lines & comments */
+    if (!*rom || (*rom == '#')) continue;
+
+    /* optional input movie */
+    end = strpbrk(rom, " \t");
+    if (end)
+    {
+      *end++ = 0;
+      while ((*end == ' ') || (*end == '\t')) end++;
+      movie = end;
+    }
+
+    if (!add_job(rom, movie))
+    {
+      fclose(fp);
+      return 0;
+    }
+  }
+
+  fclose(fp);
+  return 1;
+}
+
+static void usage(const char *name)
+{
+  printf("Genesis Plus GX\\headless\n");
+  printf("usage: %s [-j threads] [options] [-l joblist] [gamename ...]\n", name);
+  printf("  -j threads : number of instances running concurrently (default: number of CPU cores)\n");
+  instance_usage();
+  printf("  -l joblist : text file listing one game per line, optionally followed by an input movie file\n");
+}
+
+int main (int argc, char **argv)
+{
+  int i, threads = 0;
+  unsigned int total_frames = 0;
+  double start, elapsed;
+  pthread_t *pool;
+
+  /* parse command line */
+  for (i=1; i<argc; i++)
+  {
+    if (!strcmp(argv[i], "-j") && (i+1 < argc))
+    {
+      threads = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-l") && (i+1 < argc))
+    {
+      if (!load_job_list(argv[++i]))
+      {
+        fprintf(stderr, "Error loading job list `%s'.\n", argv[i]);
+        return 1;
+      }
+    }
+    else if (instance_parse_option(argc, argv, &i))
+    {
+      continue;
+    }
+    else if (argv[i][0] == '-')
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    else if (!add_job(argv[i], NULL))
+    {
+      return 1;
+    }
+  }
+
+  /* Print help if no game specified */
+  if (!job_count)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  /* default to one instance per CPU core */
+  if (threads <= 0)
+  {
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+  }
+  if (threads > job_count)
+  {
+    threads = job_count;
+  }
+
+#ifndef USE_MULTI_INSTANCE
+  /* only one instance can exist per process */
+  if (job_count > 1)
+  {
+    fprintf(stderr, "Only one game can be run per process without USE_MULTI_INSTANCE.\n");
+    return 1;
+  }
+  threads = 1;
+#endif
+
+  error_init();
+
+  pool = malloc(threads * sizeof(pthread_t));
+  if (!pool) return 1;
+
+  /* run all jobs */
+  start = get_time();
+  for (i=0; i<threads; i++)
+  {
+    if (pthread_create(&pool[i], NULL, worker, NULL))
+    {
+      threads = i;
+      break;
+    }
+  }
+  for (i=0; i<threads; i++)
+  {
+    pthread_join(pool[i], NULL);
+  }
+  elapsed = get_time() - start;
+
+  /* report aggregate speed */
+  for (i=0; i<job_count; i++)
+  {
+    total_frames += jobs[i].frames;
+    free(jobs[i].rom);
+    free(jobs[i].movie);
+  }
+  printf("%d instances on %d threads: %u frames in %.3f s (%.1f fps)\n", job_count, threads, total_frames, elapsed, elapsed > 0.0 ? total_frames / elapsed : 0.0);
+
+  free(jobs);
+  free(pool);
+  error_shutdown();
+  return 0;
+}
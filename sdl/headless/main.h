@@ -0,0 +1,17 @@
+
+#ifndef _MAIN_H_
+#define _MAIN_H_
+
+#define MAX_INPUTS 8
+
+/* Input movie file format:                                                   */
+/* one record per emulated frame, each record holding MOVIE_PLAYERS 16-bit    */
+/* little-endian words (INPUT_* button masks), one per connected controller.  */
+/* Once the end of movie is reached, all buttons are released.                */
+#define MOVIE_PLAYERS 2
+
+extern int debug_on;
+extern int log_error;
+extern int sdl_input_update(void);
+
+#endif /* _MAIN_H_ */
@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ym3438.h"
+
+#define OPN2_CLOCK_CHUNK 4096
+
+static double get_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+/* YM3438 golden output test: each line of the register log holds a number of chip clocks to run,   */
+/* then a port (0-3) and data to write, or port 4 to read status. Golden output holds one record per */
+/* clock (left & right output) and per status read (status, 0xffff), each record being made of two   */
+/* 16-bit little-endian words.                                                                        */
+/*                                                                                                    */
+/* Register logs & golden output in headless/ym3438 were recorded with the Nuked OPN2 core as it was  */
+/* before its clock pipeline was rewritten for speed. Golden output must only be recorded (-g) with   */
+/* a known-good core, never with the version being tested.                                           */
+static unsigned int opn2_seed = 1;
+
+static unsigned int opn2_rand(void)
+{
+  opn2_seed = opn2_seed * 1103515245 + 12345;
+  return (opn2_seed >> 16) & 0x7fff;
+}
+
+static void opn2_log_write(FILE *fp, unsigned int port, unsigned int address, unsigned int data)
+{
+  /* data is written a few clocks after address, next register a few dozen clocks later */
+  fprintf(fp, "%u %u %02x\n", 6 + (opn2_rand() % 8), port, address);
+  fprintf(fp, "%u %u %02x\n", 24 + (opn2_rand() % 40), port | 1, data);
+}
+
+/* random register log, covering channel, timer, CSM, DAC and test registers */
+static int opn2_log_create(const char *filename, unsigned int seed, int events)
+{
+  int i;
+  FILE *fp = fopen(filename, "w");
+  if (!fp) return 0;
+
+  opn2_seed = seed;
+  for (i=0; i<events; i++)
+  {
+    unsigned int r = opn2_rand() % 100;
+    unsigned int port = (opn2_rand() & 1) << 1;
+    unsigned int address;
+
+    if (r < 50)
+    {
+      /* operator registers */
+      address = 0x30 + (opn2_rand() % 0x70);
+      if ((address & 3) == 3) address--;
+      opn2_log_write(fp, port, address, opn2_rand() & 0xff);
+    }
+    else if (r < 70)
+    {
+      /* channel registers */
+      address = 0xa0 + (opn2_rand() % 0x18);
+      if ((address & 3) == 3) address--;
+      opn2_log_write(fp, port, address, opn2_rand() & 0xff);
+    }
+    else if (r < 85) opn2_log_write(fp, 0, 0x28, (opn2_rand() & 0xf0) | (opn2_rand() % 8));
+    else if (r < 88) opn2_log_write(fp, 0, 0x22, opn2_rand() & 0x0f);
+    else if (r < 90) opn2_log_write(fp, 0, 0x27, opn2_rand() & 0xff);
+    else if (r < 92) opn2_log_write(fp, 0, 0x24 + (opn2_rand() % 3), opn2_rand() & 0xff);
+    else if (r < 94) opn2_log_write(fp, 0, 0x2b, opn2_rand() & 0x80);
+    else if (r < 97) opn2_log_write(fp, 0, 0x2a, opn2_rand() & 0xff);
+    else if (r < 98) opn2_log_write(fp, 0, 0x21, opn2_rand() & 0xff);
+    else if (r < 99) opn2_log_write(fp, 0, 0x2c, opn2_rand() & 0xf8);
+    else fprintf(fp, "%u 4 00\n", opn2_rand() % 4000);
+
+    /* status is read after each register update */
+    fprintf(fp, "0 4 00\n");
+  }
+
+  fclose(fp);
+  return 1;
+}
+
+/* record output to, or compare output with, golden output */
+static int opn2_golden_output(FILE *fp, int record, unsigned int a, unsigned int b, unsigned int clock, int status)
+{
+  Bit8u data[4], golden[4];
+
+  data[0] = a & 0xff;
+  data[1] = (a >> 8) & 0xff;
+  data[2] = b & 0xff;
+  data[3] = (b >> 8) & 0xff;
+
+  if (record)
+  {
+    return fwrite(data, 4, 1, fp) == 1;
+  }
+
+  if (fread(golden, 4, 1, fp) != 1)
+  {
+    printf("YM3438 golden output ends at clock %u\n", clock);
+    return 0;
+  }
+
+  if (memcmp(golden, data, 4))
+  {
+    printf("YM3438 %s differs at clock %u: %04x %04x (expected %04x %04x)\n", status ? "status" : "output", clock,
+           a & 0xffff, b & 0xffff, golden[0] | (golden[1] << 8), golden[2] | (golden[3] << 8));
+    return 0;
+  }
+
+  return 1;
+}
+
+static int opn2_golden_test(const char *filename, int record)
+{
+  char line[256];
+  char *golden_name;
+  unsigned int clocks = 0, reads = 0;
+  unsigned int count, port, data;
+  int result = 1;
+  double seconds = 0.0;
+  ym3438_t *chip;
+  FILE *log, *golden;
+
+  log = fopen(filename, "r");
+  if (!log)
+  {
+    fprintf(stderr, "Error opening register log `%s'.\n", filename);
+    return 0;
+  }
+
+  golden_name = malloc(strlen(filename) + 8);
+  chip = malloc(sizeof(ym3438_t));
+  if (!golden_name || !chip)
+  {
+    free(golden_name);
+    free(chip);
+    fclose(log);
+    return 0;
+  }
+
+  /* golden output is required, unless it is being recorded */
+  sprintf(golden_name, "%s.golden", filename);
+  golden = fopen(golden_name, record ? "wb" : "rb");
+  if (!golden)
+  {
+    fprintf(stderr, "Error %s golden output `%s'.\n", record ? "creating" : "opening", golden_name);
+    free(golden_name);
+    free(chip);
+    fclose(log);
+    return 0;
+  }
+
+  OPN2_Reset(chip);
+
+  while (result && fgets(line, sizeof(line), log))
+  {
+    if (sscanf(line, "%u %u %x", &count, &port, &data) != 3) continue;
+
+    /* run chip clocks, then record or compare their output */
+    while (result && count)
+    {
+      Bit32u output[OPN2_CLOCK_CHUNK][2];
+      unsigned int i, n = (count < OPN2_CLOCK_CHUNK) ? count : OPN2_CLOCK_CHUNK;
+      double start = get_time();
+      for (i=0; i<n; i++)
+      {
+        OPN2_Clock(chip, output[i]);
+      }
+      seconds += get_time() - start;
+      for (i=0; result && (i<n); i++)
+      {
+        result = opn2_golden_output(golden, record, output[i][0], output[i][1], clocks++, 0);
+      }
+      count -= n;
+    }
+
+    if (port < 4)
+    {
+      OPN2_Write(chip, port, data);
+    }
+    else if (result)
+    {
+      result = opn2_golden_output(golden, record, OPN2_Read(chip, 0), 0xffff, clocks, 1);
+      reads++;
+    }
+  }
+
+  /* golden output must not hold more records */
+  if (result && !record && (fgetc(golden) != EOF))
+  {
+    printf("YM3438 golden output continues after clock %u\n", clocks);
+    result = 0;
+  }
+
+  if (result)
+  {
+    printf("%s: YM3438 %u clocks, %u status reads %s (%.1f ns per clock)\n", filename, clocks, reads, record ? "recorded" : "match golden output", clocks ? seconds * 1000000000.0 / clocks : 0.0);
+  }
+  else
+  {
+    printf("%s: YM3438 golden output test failed\n", filename);
+  }
+
+  fclose(golden);
+  fclose(log);
+  free(golden_name);
+  free(chip);
+  return result;
+}
+
+static void usage(const char *name)
+{
+  printf("Genesis Plus GX\\YM3438 golden output test\n");
+  printf("usage: %s reglog ...\n", name);
+  printf("       %s -g reglog ...\n", name);
+  printf("       %s -c seed events reglog\n", name);
+  printf("  reglog ...            : replay register logs, comparing output with <reglog>.golden\n");
+  printf("  -g reglog ...         : record <reglog>.golden (known-good core only)\n");
+  printf("  -c seed events reglog : create random register log\n");
+}
+
+int main (int argc, char **argv)
+{
+  int i, record = 0, result = 1;
+
+  if ((argc == 5) && !strcmp(argv[1], "-c"))
+  {
+    if (!opn2_log_create(argv[4], strtoul(argv[2], NULL, 0), atoi(argv[3])))
+    {
+      fprintf(stderr, "Error creating register log `%s'.\n", argv[4]);
+      return 1;
+    }
+    return 0;
+  }
+
+  i = 1;
+  if ((argc > 1) && !strcmp(argv[1], "-g"))
+  {
+    record = 1;
+    i++;
+  }
+
+  if ((i >= argc) || (argv[i][0] == '-'))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  for (; i<argc; i++)
+  {
+    if (!opn2_golden_test(argv[i], record))
+    {
+      result = 0;
+    }
+  }
+
+  return result ? 0 : 1;
+}
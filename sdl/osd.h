@@ -7,7 +7,9 @@
 #include <stdarg.h>
 #include <time.h>
 
+#ifndef HEADLESS
 #include <SDL.h>
+#endif
 #include <stdlib.h>
 
 #include "shared.h"
@@ -11,12 +11,16 @@
 #define VIDEO_WIDTH  320
 #define VIDEO_HEIGHT 240
 
+#define REWIND_BUFFER_SIZE (32 * 1024 * 1024)
+
 int joynum = 0;
 
 int log_error   = 0;
 int debug_on    = 0;
 int turbo_mode  = 0;
 int use_sound   = 1;
+int frame_timing = 0;
+int use_rewind  = 0;
 int fullscreen  = 0; /* SDL_WINDOW_FULLSCREEN */
 
 struct {
@@ -153,6 +157,9 @@ static int sdl_video_init()
 
 static void sdl_video_update()
 {
+  /* step back to previous frame while Backspace is held */
+  int rewinding = use_rewind && SDL_GetKeyboardState(NULL)[SDL_SCANCODE_BACKSPACE] && rewind_step();
+
   if (system_hw == SYSTEM_MCD)
   {
     system_frame_scd(0);
@@ -166,6 +173,12 @@ static void sdl_video_update()
     system_frame_sms(0);
   }
 
+  /* save rewind history */
+  if (use_rewind && !rewinding)
+  {
+    rewind_push();
+  }
+
   /* viewport size changed */
   if(bitmap.viewport.changed & 1)
   {
@@ -698,17 +711,30 @@ int sdl_input_update(void)
 int main (int argc, char **argv)
 {
   FILE *fp;
-  int running = 1;
+  int i, running = 1;
 
   /* Print help if no game specified */
   if(argc < 2)
   {
     char caption[256];
-    sprintf(caption, "Genesis Plus GX\\SDL\nusage: %s gamename\n", argv[0]);
+    sprintf(caption, "Genesis Plus GX\\SDL\nusage: %s gamename [-m] [-r]\n  -m : measure frame timing per subsystem, reported on exit\n  -r : keep rewind history (hold Backspace to step back)\n", argv[0]);
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Information", caption, sdl_video.window);
     return 1;
   }
 
+  /* parse options following game file name */
+  for (i=2; i<argc; i++)
+  {
+    if (!strcmp(argv[i], "-m"))
+    {
+      frame_timing = 1;
+    }
+    else if (!strcmp(argv[i], "-r"))
+    {
+      use_rewind = 1;
+    }
+  }
+
   /* set default config */
   error_init();
   set_config_defaults();
@@ -721,8 +747,6 @@ int main (int argc, char **argv)
   fp = fopen(MD_BIOS, "rb");
   if (fp != NULL)
   {
-    int i;
-
     /* read BOOT ROM */
     fread(boot_rom, 1, 0x800, fp);
     fclose(fp);
@@ -849,6 +873,15 @@ int main (int argc, char **argv)
   /* reset system hardware */
   system_reset();
 
+  /* allocate rewind buffer */
+  if (use_rewind && !rewind_init(REWIND_BUFFER_SIZE))
+  {
+    use_rewind = 0;
+  }
+
+  /* measure frame timing per subsystem */
+  timing_enable(frame_timing);
+
   if(use_sound) SDL_PauseAudio(0);
 
   /* 3 frames = 50 ms (60hz) or 60 ms (50hz) */
@@ -933,6 +966,17 @@ int main (int argc, char **argv)
     }
   }
 
+  /* report frame timing of most recent frames */
+  if (frame_timing)
+  {
+    char summary[256];
+    if (timing_summary(summary, sizeof(summary)))
+    {
+      printf("Frame timing (average/95th percentile): %s\n", summary);
+    }
+  }
+
+  rewind_shutdown();
   audio_shutdown();
   error_shutdown();
 